@@ -0,0 +1,510 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "XOREncoder.h"
+#include "CesarEncoder.h"
+#include "VigenereEncoder.h"
+#include "DESEncoder.h"
+#include "ArmorKernel.h"
+#include "CifContainer.h"
+#include "reference/LegacyXOREncoder.h"
+#include "reference/LegacyCesarEncoder.h"
+#include "reference/LegacyVigenereEncoder.h"
+#include "reference/LegacyDESEncoder.h"
+#include <random>
+#include <string_view>
+
+// Comprobaciones diferenciales compartidas por encoder_check (corpus fijo) y
+// encoder_fuzz (entradas de libFuzzer): cada codificador optimizado debe dar los
+// mismos bytes que su copia congelada en bench/reference, por cualquier camino
+// (encode/decode, streaming en fragmentos irregulares, en el sitio, reanudando desde
+// chunkState()) y con cualquier núcleo (tablas o bitsliced, uno o varios hilos).
+
+/**
+ * @brief Una entrada del corpus: un nombre legible y sus bytes.
+ */
+struct CorpusEntry {
+    std::string name;
+    std::string data;
+};
+
+/**
+ * @brief Cuenta las comprobaciones y describe los fallos en `std::cerr`.
+ */
+class CheckReport {
+public:
+    /**
+     * @param abortOnFailure Abortar en el primer fallo (lo que espera libFuzzer).
+     */
+    explicit CheckReport(bool abortOnFailure = false) : abortOnFailure(abortOnFailure) {}
+
+    /**
+     * @param check Qué se comprueba ("xor stream", "des cbc bitsliced x4"...).
+     * @param context Entrada y clave; solo se usa si la comprobación falla.
+     */
+    void expect(bool ok, std::string_view check, std::string_view context) {
+        checkCount++;
+        if (ok) {
+            return;
+        }
+        failureCount++;
+        if (failureCount <= MAX_REPORTED || abortOnFailure) {
+            std::cerr << "FALLO: " << check << " [" << context << "]\n";
+        }
+        if (abortOnFailure) {
+            std::abort();
+        }
+    }
+
+    size_t checks() const {
+        return checkCount;
+    }
+
+    size_t failures() const {
+        return failureCount;
+    }
+
+private:
+    static constexpr size_t MAX_REPORTED = 20;
+    bool abortOnFailure;
+    size_t checkCount = 0;
+    size_t failureCount = 0;
+};
+
+namespace checks {
+
+// La referencia DES (std::bitset) procesa menos de 0,1 MB/s: solo se compara con
+// entradas de hasta un grupo bitsliced de 64 bloques (más uno).
+constexpr size_t LEGACY_DES_LIMIT = 513;
+// DESEncoder no reparte entre hilos menos de 64 KiB por hilo: por debajo, probar con
+// varios hilos repetiría el mismo camino.
+constexpr size_t DES_THREADED_MIN = 2 * 65536;
+
+/**
+ * @brief Tamaños del corpus: alrededor de los anchos de registro (16, 32 y 64 bytes),
+ * del bloque DES, de los grupos bitsliced (64, 256 y 512 bloques) y de una línea de
+ * armadura, más dos grandes que reparten bloques DES entre hilos.
+ */
+inline std::vector<size_t> corpusSizes(bool quick) {
+    std::vector<size_t> sizes = {0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 32, 33, 47, 48, 49, 63, 64, 65,
+                                 127, 128, 129, 255, 256, 257, 511, 512, 513, 1000, 2047, 2048, 2049,
+                                 4095, 4096, 4097};
+    if (!quick) {
+        sizes.push_back(65537);
+        sizes.push_back((size_t{1} << 20) + 3);
+    }
+    return sizes;
+}
+
+/**
+ * @brief Genera `size` bytes del tipo indicado, siempre los mismos para la misma semilla.
+ * @param kind "texto", "binario", "letras", "digitos", "ceros" o "altos" (bytes >= 0x80).
+ */
+inline std::string makeData(const std::string& kind, size_t size, uint32_t seed) {
+    static const std::string letters = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    std::mt19937 rng(seed);
+    std::string data(size, '\0');
+    for (char& c : data) {
+        if (kind == "texto") {
+            c = static_cast<char>(rng() % 100 == 0 ? '\n' : 0x20 + rng() % 95);
+        } else if (kind == "binario") {
+            c = static_cast<char>(rng());
+        } else if (kind == "letras") {
+            c = letters[rng() % letters.size()];
+        } else if (kind == "digitos") {
+            c = static_cast<char>('0' + rng() % 10);
+        } else if (kind == "altos") {
+            c = static_cast<char>(0x80 + rng() % 128);
+        }
+    }
+    return data;
+}
+
+/**
+ * @brief Corpus determinista: cada tamaño con cada tipo de contenido. Los dos tamaños
+ * grandes, con uno solo (texto y binario), porque lo que prueban es el reparto en
+ * fragmentos e hilos.
+ */
+inline std::vector<CorpusEntry> makeCorpus(bool quick) {
+    static const char* kinds[] = {"texto", "binario", "letras", "digitos", "ceros", "altos"};
+    std::vector<CorpusEntry> corpus;
+    uint32_t seed = 1;
+    size_t large = 0;
+    for (size_t size : corpusSizes(quick)) {
+        if (size > 4097) {
+            const char* kind = kinds[large++ % 2];
+            corpus.push_back({std::string(kind) + "/" + std::to_string(size), makeData(kind, size, seed++)});
+            continue;
+        }
+        for (const char* kind : kinds) {
+            corpus.push_back({std::string(kind) + "/" + std::to_string(size), makeData(kind, size, seed++)});
+        }
+    }
+    return corpus;
+}
+
+/**
+ * @brief Formas de clave: vacía, de 1, 8, 9, 32 y 300 caracteres, solo dígitos (sin
+ * letras para Vigenère) y con bytes no ASCII (negativos en `char`).
+ */
+inline std::vector<CorpusEntry> makeKeys() {
+    std::string long32;
+    for (size_t i = 0; i < 32; ++i) {
+        long32 += static_cast<char>('a' + (i * 7 + 3) % 26);
+    }
+    std::string long300 = makeData("texto", 300, 99);
+    return {{"vacia", ""},
+            {"1", "k"},
+            {"8", "clave8by"},
+            {"9", "unity123$"},
+            {"32", long32},
+            {"300", long300},
+            {"digitos", "20240917"},
+            {"no-ascii", "\xC3\xB1" "and\xFA\xFF\x80"}};
+}
+
+// --- STREAMING ---
+
+/**
+ * @brief Longitudes de fragmento irregulares: muchas cortas (menos que un registro o
+ * un bloque), algunas medianas y alguna mayor que un grupo bitsliced.
+ */
+inline size_t pieceLength(std::mt19937& rng) {
+    switch (rng() % 4) {
+        case 0: return 1 + rng() % 9;
+        case 1: return 1 + rng() % 100;
+        case 2: return 1 + rng() % 5000;
+        default: return 1 + rng() % 70000;
+    }
+}
+
+/**
+ * @brief Pasa `input` por transform() en fragmentos irregulares y termina con finish().
+ */
+template <Cipher C>
+std::string streamPieces(C& cipher, std::string_view input, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::string output;
+    for (size_t pos = 0; pos < input.size();) {
+        const size_t take = std::min(input.size() - pos, pieceLength(rng));
+        const size_t base = output.size();
+        output.resize(base + cipher.outputBound(take));
+        output.resize(base + cipher.transform(asBytes(input.substr(pos, take)), std::as_writable_bytes(std::span(output)).subspan(base)));
+        pos += take;
+    }
+    const size_t base = output.size();
+    output.resize(base + cipher.outputBound(0));
+    output.resize(base + cipher.finish(std::as_writable_bytes(std::span(output)).subspan(base)));
+    return output;
+}
+
+/**
+ * @brief Como streamPieces(), pero con transformInPlace() sobre una copia de `input`.
+ */
+template <InPlaceCipher C>
+std::string inPlacePieces(C& cipher, std::string_view input, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::string data(input);
+    auto bytes = std::as_writable_bytes(std::span(data));
+    for (size_t pos = 0; pos < data.size();) {
+        const size_t take = std::min(data.size() - pos, pieceLength(rng));
+        cipher.transformInPlace(bytes.subspan(pos, take));
+        pos += take;
+    }
+    return data;
+}
+
+/**
+ * @brief Procesa `input` en dos partes con codificadores distintos: el segundo continúa
+ * desde el chunkState() del primero, como al leer un fragmento de un contenedor.
+ * @param begin Prepara un codificador recién creado (beginStream con la clave).
+ */
+template <ChunkedCipher C, typename Begin>
+std::string resumedStream(std::string_view input, size_t cut, Begin begin) {
+    C first;
+    begin(first);
+    std::string output(input.size(), '\0');
+    auto out = std::as_writable_bytes(std::span(output));
+    first.transform(asBytes(input.substr(0, cut)), out);
+    C second;
+    begin(second);
+    second.seekChunk(first.chunkState(), true);
+    second.transform(asBytes(input.substr(cut)), out.subspan(cut));
+    return output;
+}
+
+// --- COMPROBACIONES POR ALGORITMO ---
+
+/**
+ * @brief XOR: encode(), streaming, en el sitio y reanudado contra la referencia; y
+ * aplicarlo dos veces devuelve el original.
+ */
+inline void checkXOR(CheckReport& report, const std::string& data, const std::string& key, std::string_view context) {
+    const std::string expected = reference::XOREncoder().encode(data, key);
+    XOREncoder encoder;
+    report.expect(encoder.encode(data, key) == expected, "xor encode", context);
+    report.expect(encoder.encode(expected, key) == data, "xor ida y vuelta", context);
+
+    encoder.beginStream(key);
+    report.expect(streamPieces(encoder, data, 1) == expected, "xor stream", context);
+    encoder.restart();
+    report.expect(inPlacePieces(encoder, data, 2) == expected, "xor en el sitio", context);
+    const size_t cut = data.size() / 3;
+    report.expect(resumedStream<XOREncoder>(data, cut, [&](XOREncoder& c) { c.beginStream(key); }) == expected, "xor reanudado", context);
+}
+
+/**
+ * @brief César: encode() y decode() contra la referencia por los tres caminos. Solo se
+ * exige recuperar el original sin dígitos: decode() conserva el desplazamiento de
+ * letras también para los dígitos, igual que el original.
+ */
+inline void checkCesar(CheckReport& report, const std::string& data, const std::string& key, std::string_view context) {
+    reference::CesarEncoder legacy;
+    CesarEncoder encoder;
+    for (bool encrypting : {true, false}) {
+        const std::string expected = encrypting ? legacy.encode(data, key) : legacy.decode(data, key);
+        const std::string_view name = encrypting ? "cesar encode" : "cesar decode";
+        report.expect((encrypting ? encoder.encode(data, key) : encoder.decode(data, key)) == expected, name, context);
+
+        encoder.beginStream(key, encrypting);
+        report.expect(streamPieces(encoder, data, 3) == expected, encrypting ? "cesar stream encode" : "cesar stream decode", context);
+        report.expect(inPlacePieces(encoder, data, 4) == expected, encrypting ? "cesar en el sitio encode" : "cesar en el sitio decode", context);
+        const size_t cut = data.size() / 2;
+        report.expect(resumedStream<CesarEncoder>(data, cut, [&](CesarEncoder& c) { c.beginStream(key, encrypting); }) == expected,
+                      encrypting ? "cesar reanudado encode" : "cesar reanudado decode", context);
+    }
+    if (data.find_first_of("0123456789") == std::string::npos) {
+        report.expect(encoder.decode(encoder.encode(data, key), key) == data, "cesar ida y vuelta", context);
+    }
+}
+
+/**
+ * @brief Vigenère: encode() y decode() contra la referencia por los tres caminos, más
+ * la ida y vuelta.
+ */
+inline void checkVigenere(CheckReport& report, const std::string& data, const std::string& key, std::string_view context) {
+    reference::VigenereEncoder legacy;
+    VigenereEncoder encoder;
+    for (bool encrypting : {true, false}) {
+        const std::string expected = encrypting ? legacy.encode(data, key) : legacy.decode(data, key);
+        const std::string_view name = encrypting ? "vigenere encode" : "vigenere decode";
+        report.expect((encrypting ? encoder.encode(data, key) : encoder.decode(data, key)) == expected, name, context);
+
+        encoder.beginStream(key, encrypting);
+        report.expect(streamPieces(encoder, data, 5) == expected, encrypting ? "vigenere stream encode" : "vigenere stream decode", context);
+        encoder.restart();
+        report.expect(inPlacePieces(encoder, data, 6) == expected, encrypting ? "vigenere en el sitio encode" : "vigenere en el sitio decode", context);
+        // Corte en un sitio cualquiera: el índice de la clave solo avanza con las letras.
+        const size_t cut = data.size() * 2 / 5;
+        report.expect(resumedStream<VigenereEncoder>(data, cut, [&](VigenereEncoder& c) { c.beginStream(key, encrypting); }) == expected,
+                      encrypting ? "vigenere reanudado encode" : "vigenere reanudado decode", context);
+    }
+    report.expect(encoder.decode(encoder.encode(data, key), key) == data, "vigenere ida y vuelta", context);
+}
+
+/**
+ * @brief Vigenère reanudado después de 2^32 letras. El contador del núcleo es de 32 bits
+ * y da la vuelta, así que un fragmento que empieza más allá debe seguir con la misma
+ * letra de la clave que el flujo continuo. Un flujo recorre 2^32 letras en un buffer y
+ * en dos puntos (justo antes de la vuelta y después) otro codificador se sitúa con
+ * seekChunk() y descifra lo mismo. La clave mide 7, que no divide a 2^32.
+ */
+inline void checkVigenereCounterWrap(CheckReport& report) {
+    const std::string key = "bcdefgh";
+    const std::string tail = makeData("texto", 8192, 4242);
+    std::string letters(size_t(1) << 22, 'a');
+    VigenereEncoder straight;
+    straight.beginStream(key, false);
+    uint64_t remaining = (uint64_t(1) << 32) - 1000;
+    while (remaining > 0) {
+        const size_t piece = static_cast<size_t>(std::min<uint64_t>(remaining, letters.size()));
+        straight.transformInPlace(std::as_writable_bytes(std::span(letters)).first(piece));
+        remaining -= piece;
+    }
+    for (std::string_view point : {"antes de 2^32 letras", "despues de 2^32 letras"}) {
+        VigenereEncoder resumed;
+        resumed.beginStream(key, false);
+        resumed.seekChunk(straight.chunkState(), false);
+        std::string expected = tail;
+        std::string actual = tail;
+        straight.transformInPlace(std::as_writable_bytes(std::span(expected)));
+        resumed.transformInPlace(std::as_writable_bytes(std::span(actual)));
+        report.expect(expected == actual, "vigenere reanudado con el contador de 32 bits", point);
+    }
+}
+
+inline uint64_t loadBlock(const char* block) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | static_cast<unsigned char>(block[i]);
+    }
+    return value;
+}
+
+inline void storeBlock(char* block, uint64_t value) {
+    for (int i = 7; i >= 0; --i) {
+        block[i] = static_cast<char>(value);
+        value >>= 8;
+    }
+}
+
+/**
+ * @brief CBC o CTR calculados bloque a bloque con cryptBlock(), que ya se comparó con
+ * la referencia en ECB. Mismo formato que un flujo de beginRawStream() (sin cabecera).
+ */
+inline std::string desModeOracle(const std::string& data, const DESKey& key, DESMode mode, uint64_t initVector) {
+    std::string output;
+    char block[8];
+    if (mode == DESMode::CTR) {
+        output = data;
+        for (size_t i = 0; i < data.size(); i += 8) {
+            storeBlock(block, DESEncoder::cryptBlock(initVector + i / 8, key, true));
+            for (size_t j = i; j < std::min(i + 8, data.size()); ++j) {
+                output[j] = static_cast<char>(output[j] ^ block[j - i]);
+            }
+        }
+        return output;
+    }
+    std::string padded = data;
+    padded.append(8 - data.size() % 8, static_cast<char>(8 - data.size() % 8));
+    uint64_t chain = initVector;
+    for (size_t i = 0; i < padded.size(); i += 8) {
+        chain = DESEncoder::cryptBlock(loadBlock(padded.data() + i) ^ chain, key, true);
+        storeBlock(block, chain);
+        output.append(block, 8);
+    }
+    return output;
+}
+
+/**
+ * @brief DES: encode() y decode() contra la referencia (entradas pequeñas), y los
+ * flujos ECB, CBC y CTR con los dos núcleos y con uno o cuatro hilos contra encode() o
+ * contra el cálculo bloque a bloque.
+ */
+inline void checkDES(CheckReport& report, const std::string& data, const std::string& password, std::string_view context) {
+    const DESKey key(password);
+    DESEncoder encoder;
+    const std::string ecb = encoder.encode(data, key);
+    if (data.size() <= LEGACY_DES_LIMIT) {
+        reference::DESEncoder legacy;
+        report.expect(ecb == legacy.encode(data, password), "des encode", context);
+        report.expect(encoder.decode(ecb, key) == legacy.decode(ecb, password), "des decode", context);
+        // Bloques cualquiera: padding inválido o ausente se trata igual que en el original.
+        if (data.size() % 8 == 0) {
+            report.expect(encoder.decode(data, key) == legacy.decode(data, password), "des decode sin padding", context);
+        }
+    }
+    report.expect(encoder.decode(ecb, key) == data, "des ida y vuelta", context);
+
+    static const std::pair<DESBackend, const char*> backends[] = {{DESBackend::Table, "tablas"}, {DESBackend::Bitsliced, "bitsliced"}};
+    std::string name;
+    for (const auto& [backend, backendName] : backends) {
+        for (unsigned int threads : {1u, 4u}) {
+            if (threads > 1 && data.size() < DES_THREADED_MIN) {
+                continue;
+            }
+            const std::string suffix = std::string(" ") + backendName + " x" + std::to_string(threads);
+            DESEncoder stream;
+            stream.setBackend(backend);
+            stream.setThreads(threads);
+
+            stream.beginStream(key, true);
+            report.expect(streamPieces(stream, data, 7) == ecb, name.assign("des ecb stream encode").append(suffix), context);
+            stream.beginStream(key, false);
+            report.expect(streamPieces(stream, ecb, 8) == data, name.assign("des ecb stream decode").append(suffix), context);
+
+            for (DESMode mode : {DESMode::CBC, DESMode::CTR}) {
+                const std::string modeName = mode == DESMode::CBC ? "des cbc" : "des ctr";
+                stream.beginRawStream(key, true, mode);
+                const std::string encrypted = streamPieces(stream, data, 9);
+                const uint64_t initVector = stream.initVector();
+                report.expect(encrypted == desModeOracle(data, key, mode, initVector), name.assign(modeName).append(" encode").append(suffix), context);
+                stream.beginRawStream(key, false, mode, initVector);
+                report.expect(streamPieces(stream, encrypted, 10) == data, name.assign(modeName).append(" decode").append(suffix), context);
+
+                // Con la cabecera "DESM" el modo y el IV viajan en el propio flujo.
+                stream.beginStream(key, true, mode);
+                const std::string withHeader = streamPieces(stream, data, 11);
+                stream.beginStream(key, false);
+                report.expect(streamPieces(stream, withHeader, 12) == data, name.assign(modeName).append(" cabecera").append(suffix), context);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Armadura: las líneas vectorizadas coinciden con el camino escalar, decodificar
+ * devuelve los bytes y un carácter inválido se rechaza.
+ */
+inline void checkArmor(CheckReport& report, const std::string& data, std::string_view context) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    const size_t lineChars = ArmorKernel::LINE_CHARS + 1;
+
+    const size_t hexLines = data.size() / ArmorKernel::HEX_LINE_BYTES;
+    std::string lines(hexLines * lineChars, '\0');
+    std::string expected(lines.size(), '\n');
+    ArmorKernel::encodeHexLines(bytes, hexLines, lines.data());
+    for (size_t line = 0; line < hexLines; ++line) {
+        ArmorKernel::encodeHexScalar(bytes + line * ArmorKernel::HEX_LINE_BYTES, ArmorKernel::HEX_LINE_BYTES, expected.data() + line * lineChars);
+    }
+    report.expect(lines == expected, "armadura hex lineas", context);
+
+    std::string hex(data.size() * 2, '\0');
+    ArmorKernel::encodeHexScalar(bytes, data.size(), hex.data());
+    std::vector<uint8_t> decoded(data.size());
+    report.expect(ArmorKernel::decodeHex(hex.data(), hex.size(), decoded.data()) && std::equal(decoded.begin(), decoded.end(), bytes),
+                  "armadura hex decode", context);
+    if (!hex.empty()) {
+        hex[hex.size() * 3 / 4] = 'g';
+        report.expect(!ArmorKernel::decodeHex(hex.data(), hex.size(), decoded.data()), "armadura hex invalido", context);
+    }
+
+    const size_t base64Lines = data.size() / ArmorKernel::BASE64_LINE_BYTES;
+    lines.assign(base64Lines * lineChars, '\0');
+    expected.assign(lines.size(), '\n');
+    ArmorKernel::encodeBase64Lines(bytes, base64Lines, lines.data());
+    for (size_t line = 0; line < base64Lines; ++line) {
+        ArmorKernel::encodeBase64Scalar(bytes + line * ArmorKernel::BASE64_LINE_BYTES, ArmorKernel::BASE64_LINE_BYTES, expected.data() + line * lineChars);
+    }
+    report.expect(lines == expected, "armadura base64 lineas", context);
+
+    // decodeBase64() no admite relleno: solo los grupos completos de 3 bytes.
+    const size_t groups = data.size() / 3;
+    std::string base64(groups * 4, '\0');
+    ArmorKernel::encodeBase64Scalar(bytes, groups * 3, base64.data());
+    decoded.assign(groups * 3, 0);
+    report.expect(ArmorKernel::decodeBase64(base64.data(), base64.size(), decoded.data()) && std::equal(decoded.begin(), decoded.end(), bytes),
+                  "armadura base64 decode", context);
+    if (!base64.empty()) {
+        base64[base64.size() / 3] = '=';
+        report.expect(!ArmorKernel::decodeBase64(base64.data(), base64.size(), decoded.data()), "armadura base64 invalido", context);
+    }
+}
+
+/**
+ * @brief Un archivo .cif cualquiera (normalmente dañado): leer su cabecera y su índice
+ * no lanza excepciones, y un índice aceptado ocupa justo el final del archivo, así que
+ * descifrar todo el rango con XOR no lee fuera de él.
+ */
+inline void checkContainer(CheckReport& report, const std::string& data, std::string_view context) {
+    CifHeader header;
+    std::string error;
+    if (data.size() < CifContainer::HEADER_SIZE || !CifContainer::parseHeader(std::string_view(data).substr(0, CifContainer::HEADER_SIZE), header, error)) {
+        return;
+    }
+    std::istringstream input(data);
+    input.seekg(static_cast<std::streamoff>(CifContainer::HEADER_SIZE));
+    CifIndex index;
+    if (!CifContainer::readKeyCheck(input, header, error) || !CifContainer::readIndex(input, header, index, error)) {
+        return;
+    }
+    report.expect(index.indexOffset + index.chunks.size() * CifContainer::INDEX_ENTRY_SIZE + CifContainer::FOOTER_SIZE == data.size(),
+                  "contenedor indice al final", context);
+    XOREncoder model;
+    model.beginStream("clave");
+    CifWorkspace<XOREncoder> workspace;
+    std::ostringstream output;
+    CifContainer::decodeRange(input, output, header, index, 0, index.plaintextSize, model, workspace, 1, error);
+    report.expect(output.str().size() <= index.plaintextSize, "contenedor rango", context);
+}
+
+} // namespace checks
@@ -0,0 +1,501 @@
+﻿#include "Prerequisites.h"
+#include "XOREncoder.h"
+#include "CesarEncoder.h"
+#include "VigenereEncoder.h"
+#include "DESEncoder.h"
+#include "BatchExecutor.h"
+#include "CpuFeatures.h"
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <set>
+
+// Mismo tamaño de fragmento que la aplicación (STREAM_CHUNK_SIZE): los flujos mayores se
+// procesan en fragmentos de este tamaño, así que la memoria no depende del tamaño medido.
+constexpr size_t CHUNK_SIZE = 1 << 20;
+
+/**
+ * @brief Opciones de la línea de comandos.
+ */
+struct BenchOptions {
+    uint64_t minSize = 64;
+    uint64_t maxSize = uint64_t{1} << 30;
+    unsigned int maxThreads = BatchExecutor::defaultJobs();
+    std::vector<size_t> keyLengths = {1, 9, 32}; ///< Solo influyen en XOR y Vigenère.
+    std::set<std::string> ciphers = {"xor", "cesar", "vigenere", "des"};
+    double minTime = 0.2;        ///< Segundos mínimos por medición.
+    std::string jsonFile;
+    std::string csvFile;
+    std::string baselineFile;    ///< CSV de una ejecución anterior con el que comparar.
+    double tolerance = 10.0;     ///< Porcentaje de caída de MB/s que se considera regresión.
+};
+
+/**
+ * @brief Resultado de una configuración medida.
+ */
+struct BenchResult {
+    std::string cipher;
+    std::string operation;  ///< "encode" o "decode".
+    std::string mode;       ///< Modo DES ("ecb", "cbc", "ctr") o "-".
+    size_t keyLength = 0;
+    uint64_t size = 0;      ///< Bytes de cada flujo.
+    unsigned int threads = 1;
+    uint64_t bytes = 0;     ///< Total procesado: tamaño x repeticiones x hilos.
+    double seconds = 0.0;
+
+    double mbPerSecond() const {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds;
+    }
+
+    double nsPerByte() const {
+        return seconds * 1e9 / static_cast<double>(bytes);
+    }
+
+    /**
+     * @brief Identifica la configuración para compararla con otra ejecución.
+     */
+    std::string id() const {
+        return cipher + "," + operation + "," + mode + "," + std::to_string(keyLength) + "," + std::to_string(size) + "," + std::to_string(threads);
+    }
+};
+
+/**
+ * @brief Buffers de un hilo: un fragmento de datos y la salida de transform().
+ */
+struct Workspace {
+    std::vector<std::byte> input;
+    std::vector<std::byte> output;
+};
+
+// --- UTILIDADES ---
+
+/**
+ * @brief Texto imprimible pseudoaleatorio (letras, dígitos, signos y saltos de línea),
+ * para que César y Vigenère recorran sus caminos habituales.
+ */
+std::vector<std::byte> makePayload(size_t size) {
+    std::mt19937 rng(12345);
+    std::vector<std::byte> payload(size);
+    for (std::byte& b : payload) {
+        uint32_t r = rng() % 100;
+        b = static_cast<std::byte>(r == 0 ? '\n' : 0x20 + rng() % 95);
+    }
+    return payload;
+}
+
+/**
+ * @brief Clave determinista de `length` letras.
+ */
+std::string makeKey(size_t length) {
+    std::string key(length, 'a');
+    for (size_t i = 0; i < length; ++i) {
+        key[i] = static_cast<char>('a' + (i * 7 + 3) % 26);
+    }
+    return key;
+}
+
+std::string formatSize(uint64_t size) {
+    static const char* units[] = {"B", "KiB", "MiB", "GiB"};
+    int unit = 0;
+    while (unit < 3 && size >= 1024 && size % 1024 == 0) {
+        size /= 1024;
+        unit++;
+    }
+    return std::to_string(size) + " " + units[unit];
+}
+
+/**
+ * @brief Lee un tamaño con sufijo opcional K, M o G (potencias de 1024).
+ */
+bool parseSize(const std::string& text, uint64_t& size) {
+    try {
+        size_t pos = 0;
+        uint64_t value = std::stoull(text, &pos);
+        std::string suffix = text.substr(pos);
+        if (suffix == "K" || suffix == "k") value <<= 10;
+        else if (suffix == "M" || suffix == "m") value <<= 20;
+        else if (suffix == "G" || suffix == "g") value <<= 30;
+        else if (!suffix.empty()) return false;
+        size = value;
+        return value > 0;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+/**
+ * @brief Tamaños medidos: de 64 B a 1 GiB multiplicando por 16, dentro del rango pedido.
+ */
+std::vector<uint64_t> sizeClasses(const BenchOptions& options) {
+    std::vector<uint64_t> sizes;
+    for (uint64_t size = 64; size <= (uint64_t{1} << 30); size *= 16) {
+        if (size >= options.minSize && size <= options.maxSize) {
+            sizes.push_back(size);
+        }
+    }
+    return sizes;
+}
+
+/**
+ * @brief Hilos medidos: 1, 2, 4... hasta el máximo (incluido aunque no sea potencia de 2).
+ */
+std::vector<unsigned int> threadCounts(const BenchOptions& options) {
+    std::vector<unsigned int> counts;
+    for (unsigned int threads = 1; threads < options.maxThreads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(options.maxThreads);
+    return counts;
+}
+
+// --- MEDICIÓN ---
+
+/**
+ * @brief Pasa un flujo de `size` bytes por el codificador, como streamData() en la
+ * aplicación: fragmentos de CHUNK_SIZE y finish() al final.
+ * @param prefix Bytes que van antes de los datos (la cabecera de modo al descifrar DES).
+ */
+template <Cipher C>
+void runStream(C& cipher, Workspace& workspace, std::span<const std::byte> prefix, uint64_t size) {
+    cipher.restart();
+    if (!prefix.empty()) {
+        cipher.transform(prefix, workspace.output);
+    }
+    uint64_t remaining = size;
+    while (remaining > 0) {
+        std::span<std::byte> chunk(workspace.input.data(), static_cast<size_t>(std::min<uint64_t>(remaining, CHUNK_SIZE)));
+        if constexpr (InPlaceCipher<C>) {
+            cipher.transformInPlace(chunk);
+        } else {
+            cipher.transform(chunk, workspace.output);
+        }
+        remaining -= chunk.size();
+    }
+    cipher.finish(workspace.output);
+}
+
+/**
+ * @brief Cifra y descifra una muestra en fragmentos irregulares y comprueba que se
+ * recupera el original, para no medir un codificador roto.
+ */
+template <Cipher C, typename Setup>
+bool roundTrips(Setup& setup) {
+    // Solo letras y espacios: César conserva al descifrar el desplazamiento original de los dígitos.
+    std::vector<std::byte> sample(1000);
+    for (size_t i = 0; i < sample.size(); ++i) {
+        sample[i] = static_cast<std::byte>(i % 7 == 0 ? ' ' : (i % 2 ? 'a' : 'A') + (i * 11) % 26);
+    }
+    auto pump = [](C& cipher, std::span<const std::byte> input) {
+        std::vector<std::byte> output;
+        for (size_t pos = 0; pos < input.size(); pos += 333) {
+            std::span<const std::byte> piece = input.subspan(pos, std::min<size_t>(333, input.size() - pos));
+            size_t base = output.size();
+            output.resize(base + cipher.outputBound(piece.size()));
+            output.resize(base + cipher.transform(piece, std::span(output).subspan(base)));
+        }
+        size_t base = output.size();
+        output.resize(base + cipher.outputBound(0));
+        output.resize(base + cipher.finish(std::span(output).subspan(base)));
+        return output;
+    };
+    C encoder;
+    C decoder;
+    setup(encoder, true);
+    setup(decoder, false);
+    return pump(decoder, pump(encoder, sample)) == sample;
+}
+
+void printRow(const BenchResult& result) {
+    std::cout << std::left << std::setw(9) << result.cipher << std::setw(7) << result.operation
+              << std::setw(5) << result.mode << std::right << std::setw(4) << result.keyLength
+              << std::setw(10) << formatSize(result.size) << std::setw(4) << result.threads
+              << std::fixed << std::setprecision(1) << std::setw(11) << result.mbPerSecond()
+              << std::setprecision(3) << std::setw(10) << result.nsPerByte() << "\n" << std::flush;
+}
+
+/**
+ * @brief Mide un codificador en todas las combinaciones de operación, hilos y tamaño.
+ *
+ * Con N hilos se procesan N flujos a la vez, uno por hilo y cada uno con su codificador,
+ * igual que un lote de N archivos en la aplicación; los MB/s son los del conjunto.
+ * @param setup Prepara un codificador: `void(C&, bool encrypting)`.
+ * @param headerSize Bytes de cabecera que hay que darle al codificador antes de descifrar.
+ */
+template <Cipher C, typename Setup>
+void benchCipher(const BenchOptions& options, const std::string& name, const std::string& mode, size_t keyLength,
+                 size_t headerSize, Setup setup, std::vector<BenchResult>& results) {
+    if (!roundTrips<C>(setup)) {
+        std::cerr << "Error: " << name << " (" << mode << ") no recupera el texto original.\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    const std::vector<std::byte> payload = makePayload(CHUNK_SIZE);
+    for (bool encrypting : {true, false}) {
+        // Al descifrar CBC o CTR el flujo empieza con la cabecera que escribe el cifrado.
+        std::vector<std::byte> prefix;
+        if (!encrypting && headerSize > 0) {
+            C encoder;
+            setup(encoder, true);
+            prefix.resize(encoder.outputBound(0));
+            encoder.finish(prefix);
+            prefix.resize(headerSize);
+        }
+
+        for (unsigned int threads : threadCounts(options)) {
+            struct Worker {
+                C cipher;
+                Workspace workspace;
+            };
+            std::vector<Worker> workers(threads);
+            for (Worker& worker : workers) {
+                setup(worker.cipher, encrypting);
+                worker.workspace.input = payload;
+                worker.workspace.output.resize(worker.cipher.outputBound(CHUNK_SIZE));
+            }
+            BatchExecutor executor(threads);
+
+            for (uint64_t size : sizeClasses(options)) {
+                auto measure = [&](uint64_t repetitions) {
+                    auto start = std::chrono::steady_clock::now();
+                    executor.run(threads, [&](size_t task, unsigned int) {
+                        Worker& worker = workers[task];
+                        for (uint64_t r = 0; r < repetitions; ++r) {
+                            runStream(worker.cipher, worker.workspace, prefix, size);
+                        }
+                    });
+                    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                };
+
+                // Se duplican (o más) las repeticiones hasta que la medición dure minTime.
+                uint64_t repetitions = 1;
+                double seconds = measure(repetitions);
+                while (seconds < options.minTime) {
+                    double scale = seconds > 0.0 ? options.minTime / seconds * 1.2 : 16.0;
+                    repetitions = std::max(repetitions * 2, static_cast<uint64_t>(static_cast<double>(repetitions) * std::min(scale, 1000.0)));
+                    seconds = measure(repetitions);
+                }
+
+                BenchResult result{name, encrypting ? "encode" : "decode", mode, keyLength, size, threads,
+                                   size * repetitions * threads, seconds};
+                printRow(result);
+                results.push_back(result);
+            }
+        }
+    }
+}
+
+// --- SALIDA ---
+
+void writeJSON(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    out << std::setprecision(6);
+    out << "{\n  \"benchmark\": \"crypto_bench\",\n";
+    out << "  \"simd\": \"" << CpuFeatures::name(CpuFeatures::level()) << "\",\n";
+    out << "  \"des_lanes\": " << BitslicedDESEngine::lanes() << ",\n";
+    out << "  \"hardware_threads\": " << BatchExecutor::defaultJobs() << ",\n";
+    out << "  \"chunk_size\": " << CHUNK_SIZE << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << "    {\"cipher\": \"" << r.cipher << "\", \"operation\": \"" << r.operation << "\", \"mode\": \"" << r.mode
+            << "\", \"key_length\": " << r.keyLength << ", \"size\": " << r.size << ", \"threads\": " << r.threads
+            << ", \"bytes\": " << r.bytes << ", \"seconds\": " << r.seconds << ", \"mb_per_s\": " << r.mbPerSecond()
+            << ", \"ns_per_byte\": " << r.nsPerByte() << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void writeCSV(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    out << std::setprecision(6);
+    out << "cipher,operation,mode,key_length,size,threads,bytes,seconds,mb_per_s,ns_per_byte\n";
+    for (const BenchResult& r : results) {
+        out << r.id() << "," << r.bytes << "," << r.seconds << "," << r.mbPerSecond() << "," << r.nsPerByte() << "\n";
+    }
+}
+
+/**
+ * @brief Compara con el CSV de una ejecución anterior e informa de las configuraciones
+ * cuyo rendimiento cayó más de `tolerance` por ciento.
+ * @return El número de regresiones, o -1 si no se pudo leer el archivo.
+ */
+int compareWithBaseline(const std::string& path, double tolerance, const std::vector<BenchResult>& results) {
+    std::ifstream in(path);
+    std::string line;
+    if (!in.is_open() || !std::getline(in, line)) {
+        return -1;
+    }
+    std::vector<std::string> header = splitList(line);
+    auto column = [&](const std::string& name) {
+        return static_cast<size_t>(std::find(header.begin(), header.end(), name) - header.begin());
+    };
+    const size_t keyColumns[] = {column("cipher"), column("operation"), column("mode"), column("key_length"), column("size"), column("threads")};
+    const size_t speedColumn = column("mb_per_s");
+
+    std::map<std::string, double> baseline;
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields = splitList(line);
+        if (fields.size() != header.size() || speedColumn >= fields.size()) {
+            continue;
+        }
+        std::string id;
+        for (size_t c : keyColumns) {
+            if (c >= fields.size()) {
+                return -1;
+            }
+            id += (id.empty() ? "" : ",") + fields[c];
+        }
+        baseline[id] = std::stod(fields[speedColumn]);
+    }
+
+    int regressions = 0;
+    size_t compared = 0;
+    for (const BenchResult& r : results) {
+        auto it = baseline.find(r.id());
+        if (it == baseline.end() || it->second <= 0.0) {
+            continue;
+        }
+        compared++;
+        double change = (r.mbPerSecond() - it->second) / it->second * 100.0;
+        if (change < -tolerance) {
+            regressions++;
+            std::cout << "Regresion: " << r.id() << ": " << std::setprecision(1) << it->second << " -> "
+                      << r.mbPerSecond() << " MB/s (" << change << "%)\n";
+        }
+    }
+    std::cout << "Comparadas " << compared << " configuraciones con '" << path << "': " << regressions << " regresiones.\n";
+    return regressions;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Uso: " << program << " [opciones]\n"
+              << "  --min-size N      Tamano minimo por flujo (64, 1K, 16M, 1G...; por defecto 64)\n"
+              << "  --max-size N      Tamano maximo por flujo (por defecto 1G)\n"
+              << "  --threads N       Hilos maximos; se mide 1, 2, 4... N (por defecto todos los nucleos)\n"
+              << "  --key-lengths L   Longitudes de clave para XOR y Vigenere (por defecto 1,9,32)\n"
+              << "  --ciphers LISTA   xor,cesar,vigenere,des (por defecto todos)\n"
+              << "  --min-time S      Segundos minimos por medicion (por defecto 0.2)\n"
+              << "  --json ARCHIVO    Guarda los resultados en JSON\n"
+              << "  --csv ARCHIVO     Guarda los resultados en CSV\n"
+              << "  --baseline CSV    Compara con un CSV anterior; sale con 1 si hay regresiones\n"
+              << "  --tolerance P     Caida de MB/s (en %) que cuenta como regresion (por defecto 10)\n";
+}
+
+/**
+ * @brief Mide MB/s y ns/byte de XOR, César, Vigenère y DES (ECB, CBC y CTR) con la
+ * interfaz de streaming de la aplicación, para varios tamaños, longitudes de clave,
+ * cifrado y descifrado y número de hilos.
+ * Uso: crypto_bench [opciones] (ver --help)
+ */
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool ok = true;
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return EXIT_SUCCESS;
+        } else if (arg == "--min-size" && hasValue) {
+            ok = parseSize(argv[++i], options.minSize);
+        } else if (arg == "--max-size" && hasValue) {
+            ok = parseSize(argv[++i], options.maxSize);
+        } else if (arg == "--threads" && hasValue) {
+            uint64_t threads = 0;
+            ok = parseSize(argv[++i], threads) && threads <= 1024;
+            options.maxThreads = static_cast<unsigned int>(threads);
+        } else if (arg == "--key-lengths" && hasValue) {
+            options.keyLengths.clear();
+            for (const std::string& item : splitList(argv[++i])) {
+                uint64_t length = 0;
+                ok = ok && parseSize(item, length);
+                options.keyLengths.push_back(static_cast<size_t>(length));
+            }
+            ok = ok && !options.keyLengths.empty();
+        } else if (arg == "--ciphers" && hasValue) {
+            options.ciphers.clear();
+            for (const std::string& item : splitList(argv[++i])) {
+                ok = ok && (item == "xor" || item == "cesar" || item == "vigenere" || item == "des");
+                options.ciphers.insert(item);
+            }
+        } else if (arg == "--min-time" && hasValue) {
+            options.minTime = std::atof(argv[++i]);
+        } else if (arg == "--json" && hasValue) {
+            options.jsonFile = argv[++i];
+        } else if (arg == "--csv" && hasValue) {
+            options.csvFile = argv[++i];
+        } else if (arg == "--baseline" && hasValue) {
+            options.baselineFile = argv[++i];
+        } else if (arg == "--tolerance" && hasValue) {
+            options.tolerance = std::atof(argv[++i]);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Opcion no valida: " << arg << "\n";
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::cout << "SIMD: " << CpuFeatures::name(CpuFeatures::level()) << ", DES bitsliced: " << BitslicedDESEngine::lanes()
+              << " bloques por paso, hilos: " << options.maxThreads << "\n\n";
+    std::cout << "cifrado  op     modo clave    tamano  h       MB/s    ns/B\n";
+
+    std::vector<BenchResult> results;
+    if (options.ciphers.count("xor")) {
+        for (size_t length : options.keyLengths) {
+            const std::string key = makeKey(length);
+            benchCipher<XOREncoder>(options, "xor", "-", length, 0, [&](XOREncoder& c, bool encrypting) { c.beginStream(key, encrypting); }, results);
+        }
+    }
+    if (options.ciphers.count("cesar")) {
+        // César solo usa la suma de la clave: la longitud no cambia el rendimiento.
+        const std::string key = makeKey(9);
+        benchCipher<CesarEncoder>(options, "cesar", "-", key.size(), 0, [&](CesarEncoder& c, bool encrypting) { c.beginStream(key, encrypting); }, results);
+    }
+    if (options.ciphers.count("vigenere")) {
+        for (size_t length : options.keyLengths) {
+            const std::string key = makeKey(length);
+            benchCipher<VigenereEncoder>(options, "vigenere", "-", length, 0, [&](VigenereEncoder& c, bool encrypting) { c.beginStream(key, encrypting); }, results);
+        }
+    }
+    if (options.ciphers.count("des")) {
+        // DES solo usa los primeros 8 bytes de la clave. Cada flujo usa un hilo.
+        const DESKey key(makeKey(8));
+        const std::pair<const char*, DESMode> modes[] = {{"ecb", DESMode::ECB}, {"cbc", DESMode::CBC}, {"ctr", DESMode::CTR}};
+        for (const auto& [modeName, mode] : modes) {
+            size_t headerSize = mode == DESMode::ECB ? 0 : 13;
+            benchCipher<DESEncoder>(options, "des", modeName, 8, headerSize, [&, mode = mode](DESEncoder& c, bool encrypting) { c.beginStream(key, encrypting, mode); }, results);
+        }
+    }
+
+    if (!options.jsonFile.empty()) {
+        writeJSON(options.jsonFile, results);
+    }
+    if (!options.csvFile.empty()) {
+        writeCSV(options.csvFile, results);
+    }
+    if (!options.baselineFile.empty()) {
+        int regressions = compareWithBaseline(options.baselineFile, options.tolerance, results);
+        if (regressions < 0) {
+            std::cerr << "Error: No se pudo leer '" << options.baselineFile << "'.\n";
+            return 2;
+        }
+        return regressions > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,379 @@
+﻿#include "EncoderChecks.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#endif
+
+// Umbrales por defecto: CMake pasa la ruta del archivo del repositorio.
+#ifndef CRIPTO_THRESHOLDS_FILE
+#define CRIPTO_THRESHOLDS_FILE "bench/encoder_thresholds.txt"
+#endif
+
+/**
+ * @brief Opciones de la línea de comandos.
+ */
+struct CheckOptions {
+    bool quick = false;          ///< Sin los tamaños de 64 KiB y 1 MiB.
+    bool perf = true;            ///< Medir y comparar con los umbrales.
+    bool allSimdLevels = true;   ///< Repetir las comprobaciones con cada nivel SIMD inferior.
+    std::string thresholdsFile = CRIPTO_THRESHOLDS_FILE;
+    std::string calibrateFile;   ///< Escribir aquí umbrales nuevos a partir de lo medido.
+    double margin = 50.0;        ///< Porcentaje por debajo de lo medido al calibrar.
+    double minTime = 0.1;        ///< Segundos mínimos por medición.
+    int runs = 5;                ///< Mediciones por núcleo; cuenta la más rápida.
+};
+
+/**
+ * @brief Nombre de un nivel SIMD tal como lo acepta CRIPTO_SIMD.
+ */
+std::string simdKey(SimdLevel simd) {
+    static const char* keys[] = {"scalar", "sse2", "ssse3", "avx2", "avx512"};
+    return keys[static_cast<int>(simd)];
+}
+
+// --- COMPROBACIONES ---
+
+/**
+ * @brief Pasa todo el corpus, con cada forma de clave, por las comprobaciones de cada algoritmo.
+ * @return El número de fallos.
+ */
+size_t runChecks(const CheckOptions& options) {
+    CheckReport report;
+    const std::vector<CorpusEntry> corpus = checks::makeCorpus(options.quick);
+    const std::vector<CorpusEntry> keys = checks::makeKeys();
+    auto section = [&](const std::string& name, auto run) {
+        const size_t checksBefore = report.checks();
+        const size_t failuresBefore = report.failures();
+        auto start = std::chrono::steady_clock::now();
+        run();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << std::left << std::setw(10) << name << std::right << std::setw(8) << (report.checks() - checksBefore)
+                  << " comprobaciones, " << (report.failures() - failuresBefore) << " fallos (" << std::fixed
+                  << std::setprecision(1) << seconds << " s)\n" << std::flush;
+    };
+    auto forEachPair = [&](auto check) {
+        for (const CorpusEntry& entry : corpus) {
+            for (const CorpusEntry& key : keys) {
+                check(entry.data, key.data, entry.name + ", clave " + key.name);
+            }
+        }
+    };
+
+    section("xor", [&] { forEachPair([&](auto& data, auto& key, const std::string& context) { checks::checkXOR(report, data, key, context); }); });
+    section("cesar", [&] { forEachPair([&](auto& data, auto& key, const std::string& context) { checks::checkCesar(report, data, key, context); }); });
+    section("vigenere", [&] { forEachPair([&](auto& data, auto& key, const std::string& context) { checks::checkVigenere(report, data, key, context); }); });
+    if (!options.quick && CpuFeatures::level() >= SimdLevel::SSSE3) {
+        // Recorre 2^32 letras: solo con el corpus completo y con el núcleo SSSE3.
+        section("vigenere32", [&] { checks::checkVigenereCounterWrap(report); });
+    }
+    section("des", [&] { forEachPair([&](auto& data, auto& key, const std::string& context) { checks::checkDES(report, data, key, context); }); });
+    section("armadura", [&] {
+        for (const CorpusEntry& entry : corpus) {
+            checks::checkArmor(report, entry.data, entry.name);
+        }
+    });
+    return report.failures();
+}
+
+/**
+ * @brief Vuelve a ejecutar este programa con CRIPTO_SIMD limitado a cada nivel inferior
+ * al actual, porque el nivel se fija una sola vez por proceso.
+ * @return El número de niveles en los que hubo fallos.
+ */
+int runLowerSimdLevels(const char* program, const CheckOptions& options) {
+#if defined(_WIN32)
+    (void)program;
+    (void)options;
+    std::cout << "\nEn Windows solo se comprueba el nivel actual; usa CRIPTO_SIMD para los demas.\n";
+    return 0;
+#else
+    int failedLevels = 0;
+    for (int level = static_cast<int>(CpuFeatures::level()) - 1; level >= 0; --level) {
+        const std::string name = simdKey(static_cast<SimdLevel>(level));
+        std::cout << "\n" << std::flush;
+        const std::string command = "CRIPTO_SIMD=" + name + " '" + program + "' --no-perf --no-simd-levels" + (options.quick ? " --quick" : "");
+        const int status = std::system(command.c_str());
+        if (status != 0) {
+            std::cout << "El nivel " << name << " tiene fallos (estado " << (WIFEXITED(status) ? WEXITSTATUS(status) : status) << ").\n";
+            failedLevels++;
+        }
+    }
+    return failedLevels;
+#endif
+}
+
+// --- RENDIMIENTO ---
+
+/**
+ * @brief MB/s de un núcleo medido con un flujo de 1 MiB en un solo hilo.
+ */
+struct KernelSpeed {
+    std::string kernel;
+    std::string operation;
+    double mbPerSecond = 0.0;
+};
+
+/**
+ * @brief Repite `run` (que procesa `bytes` bytes) hasta que tarde al menos `minTime`, y
+ * eso `runs` veces. Devuelve la medición más rápida: una interrupción del sistema solo
+ * puede hacer más lenta una ventana, así que la mejor es la más cercana al núcleo.
+ */
+template <typename Run>
+double measure(size_t bytes, double minTime, int runs, Run run) {
+    run();  // Calentamiento: tablas, páginas y caché.
+    double best = 0.0;
+    for (int window = 0; window < runs; ++window) {
+        uint64_t repetitions = 0;
+        auto start = std::chrono::steady_clock::now();
+        double seconds = 0.0;
+        do {
+            run();
+            repetitions++;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (seconds < minTime);
+        best = std::max(best, static_cast<double>(bytes) * static_cast<double>(repetitions) / (1024.0 * 1024.0) / seconds);
+    }
+    return best;
+}
+
+/**
+ * @brief Mide cada núcleo en las dos direcciones con la interfaz de streaming.
+ */
+std::vector<KernelSpeed> measureKernels(const CheckOptions& options) {
+    constexpr size_t SIZE = 1 << 20;
+    const std::string key = "unity123$";
+    const std::string payload = checks::makeData("texto", SIZE, 12345);
+    std::string buffer = payload;
+    std::string output(SIZE + 64, '\0');
+    auto bytes = std::as_writable_bytes(std::span(buffer));
+    auto out = std::as_writable_bytes(std::span(output));
+    std::vector<KernelSpeed> speeds;
+
+    auto inPlace = [&](const std::string& name, auto& cipher, auto begin) {
+        for (bool encrypting : {true, false}) {
+            begin(cipher, encrypting);
+            speeds.push_back({name, encrypting ? "encode" : "decode", measure(SIZE, options.minTime, options.runs, [&] {
+                cipher.restart();
+                cipher.transformInPlace(bytes);
+            })});
+        }
+    };
+    XOREncoder xorEncoder;
+    inPlace("xor", xorEncoder, [&](XOREncoder& c, bool encrypting) { c.beginStream(key, encrypting); });
+    CesarEncoder cesar;
+    inPlace("cesar", cesar, [&](CesarEncoder& c, bool encrypting) { c.beginStream(key, encrypting); });
+    VigenereEncoder vigenere;
+    inPlace("vigenere", vigenere, [&](VigenereEncoder& c, bool encrypting) { c.beginStream(key, encrypting); });
+
+    static const std::pair<DESBackend, const char*> backends[] = {{DESBackend::Table, "des-tablas"}, {DESBackend::Bitsliced, "des-bitsliced"}};
+    const DESKey desKey(key);
+    for (const auto& [backend, name] : backends) {
+        DESEncoder des;
+        des.setBackend(backend);
+        for (DESMode mode : {DESMode::ECB, DESMode::CTR}) {
+            const std::string kernel = std::string(name) + (mode == DESMode::ECB ? "-ecb" : "-ctr");
+            // Sin cabecera ni padding: solo los bloques, como los fragmentos de un contenedor.
+            for (bool encrypting : {true, false}) {
+                des.beginRawStream(desKey, encrypting, mode, 0x0123456789ABCDEFULL);
+                speeds.push_back({kernel, encrypting ? "encode" : "decode", measure(SIZE, options.minTime, options.runs, [&] {
+                    des.seekChunk(0, false);
+                    des.transform(bytes, out);
+                })});
+            }
+        }
+    }
+
+    const auto* input = reinterpret_cast<const uint8_t*>(payload.data());
+    std::string armored(SIZE * 2 + SIZE / 32 + 64, '\0');
+    std::vector<uint8_t> decoded(SIZE);
+    const size_t hexLines = SIZE / ArmorKernel::HEX_LINE_BYTES;
+    speeds.push_back({"armadura-hex", "encode", measure(SIZE, options.minTime, options.runs, [&] {
+        ArmorKernel::encodeHexLines(input, hexLines, armored.data());
+    })});
+    ArmorKernel::encodeHexScalar(input, SIZE, armored.data());
+    speeds.push_back({"armadura-hex", "decode", measure(SIZE, options.minTime, options.runs, [&] {
+        ArmorKernel::decodeHex(armored.data(), SIZE * 2, decoded.data());
+    })});
+    const size_t base64Lines = SIZE / ArmorKernel::BASE64_LINE_BYTES;
+    const size_t base64Bytes = base64Lines * ArmorKernel::BASE64_LINE_BYTES;
+    speeds.push_back({"armadura-base64", "encode", measure(base64Bytes, options.minTime, options.runs, [&] {
+        ArmorKernel::encodeBase64Lines(input, base64Lines, armored.data());
+    })});
+    ArmorKernel::encodeBase64Scalar(input, base64Bytes, armored.data());
+    speeds.push_back({"armadura-base64", "decode", measure(base64Bytes, options.minTime, options.runs, [&] {
+        ArmorKernel::decodeBase64(armored.data(), base64Bytes / 3 * 4, decoded.data());
+    })});
+    return speeds;
+}
+
+/**
+ * @brief Lee los umbrales: líneas "núcleo operación nivel MB/s", donde el nivel es uno
+ * de los de CRIPTO_SIMD o '*' para cualquiera. '#' empieza un comentario.
+ * @return Falso si no se pudo abrir el archivo o una línea está mal formada.
+ */
+bool loadThresholds(const std::string& path, std::map<std::string, double>& thresholds) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        // El archivo puede empezar con la marca UTF-8 (BOM).
+        if (line.rfind("\xEF\xBB\xBF", 0) == 0) {
+            line.erase(0, 3);
+        }
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string kernel, operation, level;
+        double mbPerSecond = 0.0;
+        if (!(fields >> kernel)) {
+            continue;
+        }
+        if (!(fields >> operation >> level >> mbPerSecond)) {
+            std::cerr << "Error: linea de umbral mal formada en '" << path << "': " << line << "\n";
+            return false;
+        }
+        thresholds[kernel + " " + operation + " " + level] = mbPerSecond;
+    }
+    return true;
+}
+
+/**
+ * @brief El umbral de un núcleo para el nivel SIMD actual; el de '*' si no hay uno propio.
+ * @return 0 si el núcleo no tiene umbral.
+ */
+double thresholdFor(const std::map<std::string, double>& thresholds, const KernelSpeed& speed, const std::string& level) {
+    for (const std::string& candidate : {level, std::string("*")}) {
+        auto it = thresholds.find(speed.kernel + " " + speed.operation + " " + candidate);
+        if (it != thresholds.end()) {
+            return it->second;
+        }
+    }
+    return 0.0;
+}
+
+/**
+ * @brief Escribe un archivo de umbrales con lo medido menos `margin` por ciento, para
+ * el nivel SIMD actual.
+ */
+void writeThresholds(const std::string& path, const std::vector<KernelSpeed>& speeds, const std::string& level, double margin) {
+    std::ofstream out(path);
+    out << "# nucleo operacion nivel MB/s (medido con " << level << ", -" << margin << "%)\n";
+    for (const KernelSpeed& speed : speeds) {
+        out << speed.kernel << " " << speed.operation << " " << level << " "
+            << static_cast<uint64_t>(speed.mbPerSecond * (100.0 - margin) / 100.0) << "\n";
+    }
+}
+
+/**
+ * @brief Mide los núcleos y los compara con los umbrales.
+ * @return El número de núcleos por debajo de su umbral, o -1 si no se leyeron los umbrales.
+ */
+int runPerformance(const CheckOptions& options) {
+    std::map<std::string, double> thresholds;
+    if (options.calibrateFile.empty() && !loadThresholds(options.thresholdsFile, thresholds)) {
+        std::cerr << "Error: no se pudieron leer los umbrales de '" << options.thresholdsFile << "'.\n";
+        return -1;
+    }
+#if !defined(__OPTIMIZE__) && !defined(NDEBUG)
+    // Sin optimizar (CMake sin CMAKE_BUILD_TYPE) todo va unas diez veces más lento: se
+    // mide, pero los mínimos, pensados para una compilación Release, no se aplican.
+    std::cout << "\nAviso: compilacion sin optimizar; no se comparan los minimos (usa -DCMAKE_BUILD_TYPE=Release).\n";
+    thresholds.clear();
+#endif
+    const std::string level = simdKey(CpuFeatures::level());
+    std::cout << "\nRendimiento (1 MiB, un hilo, nivel " << level << ")\n"
+              << std::left << std::setw(20) << "nucleo" << std::setw(8) << "op" << std::right << std::setw(10) << "MB/s"
+              << std::setw(10) << "minimo" << "\n";
+    const std::vector<KernelSpeed> speeds = measureKernels(options);
+    int regressions = 0;
+    for (const KernelSpeed& speed : speeds) {
+        const double minimum = thresholdFor(thresholds, speed, level);
+        const bool slow = minimum > 0.0 && speed.mbPerSecond < minimum;
+        regressions += slow ? 1 : 0;
+        std::cout << std::left << std::setw(20) << speed.kernel << std::setw(8) << speed.operation << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << speed.mbPerSecond << std::setw(10);
+        if (minimum > 0.0) {
+            std::cout << minimum;
+        } else {
+            std::cout << "-";
+        }
+        std::cout << (slow ? "  REGRESION" : "") << "\n";
+    }
+    if (!options.calibrateFile.empty()) {
+        writeThresholds(options.calibrateFile, speeds, level, options.margin);
+        std::cout << "Umbrales escritos en '" << options.calibrateFile << "'.\n";
+    }
+    return regressions;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Uso: " << program << " [opciones]\n"
+              << "  --quick           Corpus reducido (sin los tamanos de 64 KiB y 1 MiB)\n"
+              << "  --no-perf         Solo las comprobaciones, sin medir rendimiento\n"
+              << "  --no-simd-levels  Comprobar solo con el nivel SIMD actual\n"
+              << "  --thresholds F    Umbrales de MB/s por nucleo (por defecto " << CRIPTO_THRESHOLDS_FILE << ")\n"
+              << "  --calibrate F     Escribe en F umbrales a partir de lo medido en esta maquina\n"
+              << "  --margin P        Porcentaje por debajo de lo medido al calibrar (por defecto 50)\n"
+              << "  --min-time S      Segundos minimos por medicion (por defecto 0.1)\n"
+              << "  --runs N          Mediciones por nucleo; cuenta la mas rapida (por defecto 5)\n";
+}
+
+/**
+ * @brief Compara XOR, César, Vigenère, DES y la armadura con sus copias de referencia
+ * sobre un corpus fijo, con todos los niveles SIMD disponibles, y mide cada núcleo
+ * contra un umbral mínimo de MB/s.
+ * @return 0 si todo coincide y ningún núcleo baja de su umbral; 1 en otro caso.
+ */
+int main(int argc, char* argv[]) {
+    CheckOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: falta el valor de " << arg << ".\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        try {
+            if (arg == "--quick") options.quick = true;
+            else if (arg == "--no-perf") options.perf = false;
+            else if (arg == "--no-simd-levels") options.allSimdLevels = false;
+            else if (arg == "--thresholds") options.thresholdsFile = next();
+            else if (arg == "--calibrate") options.calibrateFile = next();
+            else if (arg == "--margin") options.margin = std::stod(next());
+            else if (arg == "--min-time") options.minTime = std::stod(next());
+            else if (arg == "--runs") options.runs = std::max(1, std::stoi(next()));
+            else if (arg == "--help" || arg == "-h") {
+                printUsage(argv[0]);
+                return EXIT_SUCCESS;
+            } else {
+                std::cerr << "Error: opcion desconocida '" << arg << "'.\n";
+                printUsage(argv[0]);
+                return 2;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: valor invalido para " << arg << ".\n";
+            return 2;
+        }
+    }
+
+    std::cout << "Comprobaciones diferenciales (nivel " << simdKey(CpuFeatures::level()) << ", DES bitsliced de "
+              << BitslicedDESEngine::lanes() << " bloques)\n";
+    bool failed = runChecks(options) > 0;
+    if (options.allSimdLevels) {
+        failed = runLowerSimdLevels(argv[0], options) > 0 || failed;
+    }
+    if (options.perf) {
+        const int regressions = runPerformance(options);
+        failed = regressions != 0 || failed;
+    }
+    std::cout << "\n" << (failed ? "Hay fallos o regresiones." : "Todo correcto.") << "\n";
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,53 @@
+﻿#include "EncoderChecks.h"
+#include <cstdint>
+
+/**
+ * @brief Objetivo de libFuzzer: las mismas comprobaciones diferenciales que
+ * encoder_check, con el algoritmo, la clave y los datos sacados de la entrada.
+ *
+ * Formato de la entrada: un byte que elige el algoritmo (módulo 6: XOR, César,
+ * Vigenère, DES, armadura o lectura de un contenedor .cif), un byte con la longitud de
+ * la clave, la clave y el resto como datos. Cualquier diferencia con la referencia
+ * aborta el proceso. bench/fuzz_corpus guarda entradas de partida.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* input, size_t size) {
+    if (size < 2) {
+        return 0;
+    }
+    const size_t keyLength = std::min<size_t>(input[1], size - 2);
+    const std::string key(reinterpret_cast<const char*>(input + 2), keyLength);
+    const std::string data(reinterpret_cast<const char*>(input + 2 + keyLength), size - 2 - keyLength);
+    const std::string_view context = "entrada del fuzzer";
+
+    CheckReport report(true);
+    switch (input[0] % 6) {
+        case 0: checks::checkXOR(report, data, key, context); break;
+        case 1: checks::checkCesar(report, data, key, context); break;
+        case 2: checks::checkVigenere(report, data, key, context); break;
+        case 3: checks::checkDES(report, data, key, context); break;
+        case 4: checks::checkArmor(report, data, context); break;
+        default: checks::checkContainer(report, data, context); break;
+    }
+    return 0;
+}
+
+#if defined(CRIPTO_FUZZ_STANDALONE)
+/**
+ * @brief Sin libFuzzer: pasa por el objetivo cada archivo indicado, para reproducir un
+ * fallo o recorrer un corpus guardado.
+ * Uso: encoder_fuzz archivo...
+ */
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in.is_open()) {
+            std::cerr << "Error: no se pudo abrir '" << argv[i] << "'.\n";
+            return EXIT_FAILURE;
+        }
+        const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+    }
+    std::cout << (argc - 1) << " entradas sin diferencias.\n";
+    return EXIT_SUCCESS;
+}
+#endif
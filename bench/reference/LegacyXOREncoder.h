@@ -0,0 +1,36 @@
+﻿// Copia congelada del XOREncoder original (basado en strings, carácter a carácter).
+// Se conserva solo como referencia para comprobar que los núcleos optimizados dan
+// exactamente los mismos bytes; no debe usarse en la aplicación.
+
+#pragma once
+#include "Prerequisites.h"
+
+namespace reference {
+
+class XOREncoder {
+public:
+    /**
+     * @brief Constructor simple. No hace nada.
+     */
+    XOREncoder() = default;
+
+    /**
+     * @brief Codifica o decodifica el texto de entrada usando una clave con la operación XOR.
+     * La operación es simétrica, por lo que la misma función sirve para encriptar y desencriptar.
+     * @param input El texto a procesar.
+     * @param key La contraseña para la operación.
+     * @return El texto procesado.
+     */
+    std::string encode(const std::string& input, const std::string& key) {
+        if (key.empty()) {
+            return input;
+        }
+        std::string output = input;
+        for (size_t i = 0; i < input.size(); ++i) {
+            output[i] = input[i] ^ key[i % key.length()];
+        }
+        return output;
+    }
+};
+
+} // namespace reference
@@ -0,0 +1,455 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Cipher.h"
+#include "ArmorKernel.h"
+#include <algorithm>
+#include <cstring>
+#include <streambuf>
+#include <string_view>
+
+/**
+ * @brief Texto con el que se guarda un archivo cifrado (--armor): binario, hexadecimal o
+ * Base64.
+ */
+enum class ArmorFormat { None, Hex, Base64 };
+
+/**
+ * @class Armor
+ * @brief Formato de la armadura ASCII: una línea de cabecera, los bytes codificados en
+ * líneas de ArmorKernel::LINE_CHARS caracteres y una línea final, al estilo de PEM:
+ *
+ *     -----BEGIN CRIPTO BASE64-----
+ *     Q0lGQwEAAAAgAAAAAAAAEAAAAAAAAAAAAAAAAAAA...
+ *     -----END CRIPTO BASE64-----
+ *
+ * Lo que va dentro es exactamente lo que se escribiría en binario (un contenedor .cif o
+ * el formato antiguo), así que al descifrar basta con quitar la armadura.
+ */
+class Armor {
+public:
+    /// Principio común de todas las cabeceras; basta para reconocer un archivo armado.
+    static constexpr std::string_view PREFIX = "-----BEGIN CRIPTO ";
+
+    static bool isArmored(std::string_view data) {
+        return data.size() >= PREFIX.size() && data.substr(0, PREFIX.size()) == PREFIX;
+    }
+
+    static const char* name(ArmorFormat format) {
+        return format == ArmorFormat::Hex ? "HEX" : "BASE64";
+    }
+
+    static std::string header(ArmorFormat format) {
+        return "-----BEGIN CRIPTO " + std::string(name(format)) + "-----";
+    }
+
+    static std::string footer(ArmorFormat format) {
+        return "-----END CRIPTO " + std::string(name(format)) + "-----";
+    }
+
+    /**
+     * @brief Formato de una línea de cabecera (sin el salto de línea), o None si no lo es.
+     */
+    static ArmorFormat parseHeader(std::string_view line) {
+        if (line == header(ArmorFormat::Hex)) {
+            return ArmorFormat::Hex;
+        }
+        if (line == header(ArmorFormat::Base64)) {
+            return ArmorFormat::Base64;
+        }
+        return ArmorFormat::None;
+    }
+
+    /**
+     * @brief Bytes que ocupan una línea completa de armadura.
+     */
+    static size_t lineBytes(ArmorFormat format) {
+        return format == ArmorFormat::Hex ? ArmorKernel::HEX_LINE_BYTES : ArmorKernel::BASE64_LINE_BYTES;
+    }
+};
+
+/**
+ * @class ArmorEncoder
+ * @brief Envuelve un codificador para que su salida sea texto armado. Cumple la interfaz
+ * Cipher, así que se usa igual que cualquier codificador.
+ *
+ * Cada fragmento se cifra por trozos de FUSED_CHUNK bytes en un buffer intermedio y cada
+ * trozo se codifica en cuanto sale del cifrado, mientras sigue en la caché: el texto
+ * cifrado no vuelve a recorrerse desde memoria. Los bytes que no llenan una línea se
+ * quedan al principio del buffer para el siguiente trozo.
+ */
+template <Cipher C>
+class ArmorEncoder {
+public:
+    /// Texto plano que se cifra y codifica de una vez; múltiplo de las dos longitudes de línea.
+    static constexpr size_t FUSED_CHUNK = 3 << 16;
+
+    /**
+     * @brief El codificador interno, para prepararlo antes de llamar a beginArmor().
+     */
+    C& cipher() {
+        return inner;
+    }
+
+    /**
+     * @brief Empieza el primer archivo con el codificador interno ya preparado.
+     */
+    void beginArmor(ArmorFormat armorFormat) {
+        format = armorFormat;
+        headerLine = Armor::header(format) + "\n";
+        footerLine = Armor::footer(format) + "\n";
+        restart();
+    }
+
+    void restart() {
+        inner.restart();
+        headerWritten = false;
+        carry = 0;
+    }
+
+    /**
+     * @brief Como mucho una línea más de las que ocupa la salida del codificador interno
+     * (por los bytes que quedan de la llamada anterior), más la cabecera y el pie.
+     */
+    size_t outputBound(size_t inputSize) const {
+        const size_t bytesPerLine = Armor::lineBytes(format);
+        return headerLine.size() + ((inner.outputBound(inputSize) + bytesPerLine - 1) / bytesPerLine + 1) * (ArmorKernel::LINE_CHARS + 1) +
+               footerLine.size();
+    }
+
+    size_t transform(std::span<const std::byte> input, std::span<std::byte> output) {
+        char* out = reinterpret_cast<char*>(output.data());
+        size_t written = writeHeaderOnce(out);
+        for (size_t offset = 0; offset < input.size(); offset += FUSED_CHUNK) {
+            const auto piece = input.subspan(offset, std::min(FUSED_CHUNK, input.size() - offset));
+            const size_t bound = inner.outputBound(piece.size());
+            scratch.resize(std::max(scratch.size(), carry + bound));
+            carry += inner.transform(piece, std::span(scratch).subspan(carry, bound));
+            written += encodeLines(out + written);
+        }
+        return written;
+    }
+
+    /**
+     * @brief Termina el codificador interno y escribe la última línea, incompleta (con
+     * relleno '=' en Base64), y el pie.
+     */
+    size_t finish(std::span<std::byte> output) {
+        char* out = reinterpret_cast<char*>(output.data());
+        size_t written = writeHeaderOnce(out);
+        const size_t bound = inner.outputBound(0);
+        scratch.resize(std::max(scratch.size(), carry + bound));
+        carry += inner.finish(std::span(scratch).subspan(carry, bound));
+        written += encodeLines(out + written);
+        if (carry > 0) {
+            const auto* data = reinterpret_cast<const uint8_t*>(scratch.data());
+            if (format == ArmorFormat::Hex) {
+                ArmorKernel::encodeHexScalar(data, carry, out + written);
+                written += 2 * carry;
+            } else {
+                written += ArmorKernel::encodeBase64Scalar(data, carry, out + written);
+            }
+            out[written++] = '\n';
+            carry = 0;
+        }
+        std::memcpy(out + written, footerLine.data(), footerLine.size());
+        return written + footerLine.size();
+    }
+
+private:
+    C inner;
+    ArmorFormat format = ArmorFormat::Base64;
+    std::string headerLine;
+    std::string footerLine;
+    bool headerWritten = false;
+    std::vector<std::byte> scratch;  ///< Salida del codificador interno; empieza con los `carry` bytes pendientes.
+    size_t carry = 0;
+
+    size_t writeHeaderOnce(char* out) {
+        if (headerWritten) {
+            return 0;
+        }
+        headerWritten = true;
+        std::memcpy(out, headerLine.data(), headerLine.size());
+        return headerLine.size();
+    }
+
+    /**
+     * @brief Codifica las líneas completas de `scratch` y deja el resto al principio.
+     */
+    size_t encodeLines(char* out) {
+        const size_t bytesPerLine = Armor::lineBytes(format);
+        const size_t lines = carry / bytesPerLine;
+        const auto* data = reinterpret_cast<const uint8_t*>(scratch.data());
+        if (format == ArmorFormat::Hex) {
+            ArmorKernel::encodeHexLines(data, lines, out);
+        } else {
+            ArmorKernel::encodeBase64Lines(data, lines, out);
+        }
+        const size_t used = lines * bytesPerLine;
+        carry -= used;
+        std::memmove(scratch.data(), scratch.data() + used, carry);
+        return lines * (ArmorKernel::LINE_CHARS + 1);
+    }
+};
+
+/**
+ * @class ArmorReader
+ * @brief Flujo de lectura que quita la armadura de otro flujo; se usa con std::istream
+ * para que el descifrado lea los bytes como si el archivo fuera binario.
+ *
+ * Las líneas se decodifican enteras con ArmorKernel, sea cual sea su longitud; solo las
+ * que llevan espacios, relleno o la línea final pasan carácter a carácter. Si el flujo
+ * no empieza con una cabecera de armadura, los bytes pasan sin tocar.
+ */
+class ArmorReader : public std::streambuf {
+public:
+    explicit ArmorReader(std::istream& source) : source(source), text(BUFFER_SIZE), bytes(BUFFER_SIZE) {}
+
+    /**
+     * @brief Lee la primera línea y, si es una cabecera de armadura, empieza a decodificar.
+     * @return El formato, o None si no es una cabecera (los bytes ya leídos se devuelven
+     * igualmente al leer).
+     */
+    ArmorFormat begin() {
+        std::string line;
+        char c;
+        while (line.size() <= Armor::header(ArmorFormat::Base64).size() + 1 && source.get(c)) {
+            line.push_back(c);
+            if (c == '\n') {
+                break;
+            }
+        }
+        std::string_view header(line);
+        if (!header.empty() && header.back() == '\n') {
+            header.remove_suffix(1);
+        }
+        if (!header.empty() && header.back() == '\r') {
+            header.remove_suffix(1);
+        }
+        format = Armor::parseHeader(header);
+        if (format == ArmorFormat::None) {
+            std::memcpy(text.data(), line.data(), line.size());
+            textEnd = line.size();
+        } else {
+            footer = Armor::footer(format);
+        }
+        return format;
+    }
+
+    /**
+     * @brief Tras leer todo: falso (con el motivo en `error`) si la armadura tenía
+     * caracteres no válidos, si faltaba la línea final o si falló la lectura.
+     */
+    bool finished(std::string& error) const {
+        if (!problem.empty()) {
+            error = problem;
+            return false;
+        }
+        if (format != ArmorFormat::None && !ended) {
+            error = "falta la linea '" + footer + "' (archivo incompleto)";
+            return false;
+        }
+        return true;
+    }
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        char* begin = nullptr;
+        size_t produced = 0;
+        if (format == ArmorFormat::None) {
+            begin = text.data();
+            produced = passThrough();
+        } else {
+            begin = bytes.data();
+            while (produced == 0 && !done) {
+                produced = decodeSome();
+            }
+        }
+        if (produced == 0) {
+            return traits_type::eof();
+        }
+        setg(begin, begin, begin + produced);
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    static constexpr size_t BUFFER_SIZE = 64 << 10;
+
+    std::istream& source;
+    ArmorFormat format = ArmorFormat::None;
+    std::string footer;
+    std::vector<char> text;   ///< Texto leído de `source`, de textPos a textEnd.
+    size_t textPos = 0;
+    size_t textEnd = 0;
+    bool sourceEnded = false;
+    std::vector<char> bytes;  ///< Bytes decodificados que se entregan al lector.
+    uint32_t group = 0;       ///< Valores de un grupo a medias (4 caracteres Base64 o 2 hexadecimales).
+    int groupSize = 0;
+    bool padded = false;      ///< Ya apareció el relleno '=': solo puede seguir la línea final.
+    bool ended = false;       ///< Se leyó la línea final.
+    bool done = false;
+    std::string problem;
+
+    /**
+     * @brief Sin armadura: entrega primero lo leído por begin() y después lee directamente.
+     */
+    size_t passThrough() {
+        if (textPos < textEnd) {
+            const size_t size = textEnd - textPos;
+            textPos = textEnd;
+            return size;
+        }
+        source.read(text.data(), static_cast<std::streamsize>(text.size()));
+        if (source.bad()) {
+            problem = "no se pudo leer la entrada";
+        }
+        return static_cast<size_t>(source.gcount());
+    }
+
+    /**
+     * @brief Mueve lo que queda de texto al principio y completa el buffer desde `source`.
+     */
+    void refill() {
+        std::memmove(text.data(), text.data() + textPos, textEnd - textPos);
+        textEnd -= textPos;
+        textPos = 0;
+        source.read(text.data() + textEnd, static_cast<std::streamsize>(text.size() - textEnd));
+        textEnd += static_cast<size_t>(source.gcount());
+        if (source.bad()) {
+            problem = "no se pudo leer la entrada";
+            done = true;
+        } else if (source.gcount() == 0 || source.eof()) {
+            sourceEnded = true;
+        }
+    }
+
+    /**
+     * @brief Decodifica líneas enteras en `bytes` hasta llenarlo o hasta que haga falta
+     * leer más texto.
+     */
+    size_t decodeSome() {
+        size_t produced = 0;
+        while (!done) {
+            const char* line = text.data() + textPos;
+            const size_t available = textEnd - textPos;
+            const auto* newline = static_cast<const char*>(std::memchr(line, '\n', available));
+            size_t length = available;
+            size_t advance = available;
+            if (newline != nullptr) {
+                length = static_cast<size_t>(newline - line);
+                advance = length + 1;
+            } else if (!sourceEnded && (textPos > 0 || textEnd < text.size())) {
+                // La línea sigue en lo que aún no se ha leído.
+                if (produced > 0) {
+                    break;
+                }
+                refill();
+                continue;
+            } else if (available == 0) {
+                done = true;
+                break;
+            }
+            // Una línea decodificada nunca ocupa más que su texto, y el texto cabe en `bytes`.
+            if (produced + length > bytes.size()) {
+                break;
+            }
+            produced += decodeLine(line, length, bytes.data() + produced);
+            textPos += advance;
+            done = done || ended || !problem.empty();
+        }
+        return produced;
+    }
+
+    size_t decodeLine(const char* line, size_t length, char* out) {
+        if (length > 0 && line[length - 1] == '\r') {
+            length--;
+        }
+        auto* output = reinterpret_cast<uint8_t*>(out);
+        if (groupSize == 0 && !padded && length > 0) {
+            if (format == ArmorFormat::Hex && length % 2 == 0 && ArmorKernel::decodeHex(line, length, output)) {
+                return length / 2;
+            }
+            if (format == ArmorFormat::Base64 && length % 4 == 0 && ArmorKernel::decodeBase64(line, length, output)) {
+                return length / 4 * 3;
+            }
+        }
+        return decodeSlow(line, length, output);
+    }
+
+    /**
+     * @brief Carácter a carácter: espacios, relleno, grupos partidos entre líneas y la
+     * línea final.
+     */
+    size_t decodeSlow(const char* line, size_t length, uint8_t* out) {
+        const bool hex = format == ArmorFormat::Hex;
+        size_t produced = 0;
+        for (size_t i = 0; i < length; ++i) {
+            const char c = line[i];
+            if (c == ' ' || c == '\t' || c == '\r') {
+                continue;
+            }
+            if (c == '-') {
+                if (std::string_view(line + i, length - i) != footer) {
+                    problem = "linea no valida en la armadura";
+                } else if (!hex && groupSize >= 2) {
+                    // Base64 sin relleno: el grupo a medias se cierra igual que con '='.
+                    produced += flushPartialGroup(out + produced);
+                    ended = true;
+                } else if (groupSize != 0) {
+                    problem = "la armadura termina con un grupo incompleto";
+                } else {
+                    ended = true;
+                }
+                return produced;
+            }
+            if (c == '=' && !hex) {
+                if (!padded) {
+                    if (groupSize < 2) {
+                        problem = "relleno '=' fuera de lugar en la armadura";
+                        return produced;
+                    }
+                    produced += flushPartialGroup(out + produced);
+                    padded = true;
+                }
+                continue;
+            }
+            const int value = hex ? ArmorKernel::hexValue(c) : ArmorKernel::base64Value(c);
+            if (value < 0 || padded) {
+                problem = "caracter no valido en la armadura";
+                return produced;
+            }
+            group = (group << (hex ? 4 : 6)) | static_cast<uint32_t>(value);
+            groupSize++;
+            if (hex && groupSize == 2) {
+                out[produced++] = static_cast<uint8_t>(group);
+                group = 0;
+                groupSize = 0;
+            } else if (!hex && groupSize == 4) {
+                out[produced++] = static_cast<uint8_t>(group >> 16);
+                out[produced++] = static_cast<uint8_t>(group >> 8);
+                out[produced++] = static_cast<uint8_t>(group);
+                group = 0;
+                groupSize = 0;
+            }
+        }
+        return produced;
+    }
+
+    /**
+     * @brief Cierra un grupo Base64 de 2 o 3 caracteres (1 o 2 bytes).
+     */
+    size_t flushPartialGroup(uint8_t* out) {
+        const uint32_t bits = group << (6 * (4 - groupSize));
+        const size_t produced = static_cast<size_t>(groupSize - 1);
+        out[0] = static_cast<uint8_t>(bits >> 16);
+        if (produced == 2) {
+            out[1] = static_cast<uint8_t>(bits >> 8);
+        }
+        group = 0;
+        groupSize = 0;
+        return produced;
+    }
+};
@@ -0,0 +1,430 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+#include <cstdint>
+
+/**
+ * @class ArmorKernel
+ * @brief Núcleos vectorizados de hexadecimal y Base64 para la armadura ASCII de los .cif.
+ *
+ * La codificación trabaja por líneas completas de LINE_CHARS caracteres (más el salto
+ * de línea): 32 bytes en hexadecimal y 48 en Base64, múltiplos de lo que procesa cada
+ * registro. En Base64 los 3 bytes de cada grupo se reparten en 4 índices de 6 bits con
+ * un pshufb y dos multiplicaciones, y los índices se convierten en letras sumándoles un
+ * desplazamiento que se busca por rangos. La decodificación clasifica cada carácter con
+ * comparaciones, rechaza el bloque entero si alguno no es válido (por ejemplo, un
+ * espacio o el relleno '=') y junta los valores con multiplicaciones horizontales.
+ *
+ * Los resultados son idénticos byte a byte a los de los caminos escalares.
+ */
+class ArmorKernel {
+public:
+    /// Caracteres por línea de armadura, sin el salto de línea.
+    static constexpr size_t LINE_CHARS = 64;
+    static constexpr size_t HEX_LINE_BYTES = LINE_CHARS / 2;
+    static constexpr size_t BASE64_LINE_BYTES = LINE_CHARS / 4 * 3;
+
+    /**
+     * @brief Codifica `lines` líneas completas de HEX_LINE_BYTES bytes; cada una ocupa
+     * LINE_CHARS + 1 caracteres en `output`.
+     */
+    static void encodeHexLines(const uint8_t* input, size_t lines, char* output) {
+        size_t done = 0;
+#if CRIPTO_X86_SIMD
+        SimdLevel simd = CpuFeatures::level();
+        if (simd >= SimdLevel::AVX2) {
+            done = encodeHexLinesAVX2(input, lines, output);
+        } else if (simd >= SimdLevel::SSSE3) {
+            done = encodeHexLinesSSSE3(input, lines, output);
+        }
+#endif
+        for (size_t line = done; line < lines; ++line) {
+            char* out = output + line * (LINE_CHARS + 1);
+            encodeHexScalar(input + line * HEX_LINE_BYTES, HEX_LINE_BYTES, out);
+            out[LINE_CHARS] = '\n';
+        }
+    }
+
+    /**
+     * @brief Codifica `lines` líneas completas de BASE64_LINE_BYTES bytes; cada una
+     * ocupa LINE_CHARS + 1 caracteres en `output`.
+     */
+    static void encodeBase64Lines(const uint8_t* input, size_t lines, char* output) {
+        size_t done = 0;
+#if CRIPTO_X86_SIMD
+        // Los registros leen 4 bytes más allá de su grupo: la última línea va por el
+        // camino escalar para no leer fuera de `input`.
+        const size_t vectorLines = lines > 0 ? lines - 1 : 0;
+        SimdLevel simd = CpuFeatures::level();
+        if (simd >= SimdLevel::AVX2) {
+            done = encodeBase64LinesAVX2(input, vectorLines, output);
+        } else if (simd >= SimdLevel::SSSE3) {
+            done = encodeBase64LinesSSSE3(input, vectorLines, output);
+        }
+#endif
+        for (size_t line = done; line < lines; ++line) {
+            char* out = output + line * (LINE_CHARS + 1);
+            encodeBase64Scalar(input + line * BASE64_LINE_BYTES, BASE64_LINE_BYTES, out);
+            out[LINE_CHARS] = '\n';
+        }
+    }
+
+    /**
+     * @brief Codifica en hexadecimal (minúsculas) `size` bytes: 2 * `size` caracteres.
+     */
+    static void encodeHexScalar(const uint8_t* input, size_t size, char* output) {
+        for (size_t i = 0; i < size; ++i) {
+            output[2 * i] = HEX_DIGITS[input[i] >> 4];
+            output[2 * i + 1] = HEX_DIGITS[input[i] & 0x0F];
+        }
+    }
+
+    /**
+     * @brief Codifica en Base64 `size` bytes, con relleno '=' si no es múltiplo de 3.
+     * @return Caracteres escritos (4 por cada grupo de hasta 3 bytes).
+     */
+    static size_t encodeBase64Scalar(const uint8_t* input, size_t size, char* output) {
+        size_t written = 0;
+        size_t i = 0;
+        for (; i + 3 <= size; i += 3) {
+            const uint32_t group = (static_cast<uint32_t>(input[i]) << 16) | (static_cast<uint32_t>(input[i + 1]) << 8) | input[i + 2];
+            output[written++] = BASE64_DIGITS[group >> 18];
+            output[written++] = BASE64_DIGITS[(group >> 12) & 0x3F];
+            output[written++] = BASE64_DIGITS[(group >> 6) & 0x3F];
+            output[written++] = BASE64_DIGITS[group & 0x3F];
+        }
+        if (i < size) {
+            const uint32_t group = (static_cast<uint32_t>(input[i]) << 16) | (i + 1 < size ? static_cast<uint32_t>(input[i + 1]) << 8 : 0);
+            output[written++] = BASE64_DIGITS[group >> 18];
+            output[written++] = BASE64_DIGITS[(group >> 12) & 0x3F];
+            output[written++] = i + 1 < size ? BASE64_DIGITS[(group >> 6) & 0x3F] : '=';
+            output[written++] = '=';
+        }
+        return written;
+    }
+
+    /**
+     * @brief Decodifica `size` caracteres hexadecimales (`size` par, sin espacios).
+     * @return Falso si algún carácter no es hexadecimal.
+     */
+    static bool decodeHex(const char* input, size_t size, uint8_t* output) {
+        size_t done = 0;
+#if CRIPTO_X86_SIMD
+        SimdLevel simd = CpuFeatures::level();
+        if (simd >= SimdLevel::AVX2) {
+            done = decodeHexAVX2(input, size, output);
+        } else if (simd >= SimdLevel::SSSE3) {
+            done = decodeHexSSSE3(input, size, output);
+        }
+        if (done == SIZE_MAX) {
+            return false;
+        }
+#endif
+        for (size_t i = done; i + 1 < size; i += 2) {
+            const int high = hexValue(input[i]);
+            const int low = hexValue(input[i + 1]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            output[i / 2] = static_cast<uint8_t>((high << 4) | low);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Decodifica `size` caracteres Base64 (`size` múltiplo de 4, sin relleno ni
+     * espacios).
+     * @return Falso si algún carácter no pertenece al alfabeto.
+     */
+    static bool decodeBase64(const char* input, size_t size, uint8_t* output) {
+        size_t done = 0;
+#if CRIPTO_X86_SIMD
+        SimdLevel simd = CpuFeatures::level();
+        if (simd >= SimdLevel::AVX2) {
+            done = decodeBase64AVX2(input, size, output);
+        } else if (simd >= SimdLevel::SSSE3) {
+            done = decodeBase64SSSE3(input, size, output);
+        }
+        if (done == SIZE_MAX) {
+            return false;
+        }
+#endif
+        for (size_t i = done; i + 3 < size; i += 4) {
+            const int a = base64Value(input[i]);
+            const int b = base64Value(input[i + 1]);
+            const int c = base64Value(input[i + 2]);
+            const int d = base64Value(input[i + 3]);
+            if ((a | b | c | d) < 0) {
+                return false;
+            }
+            const uint32_t group = (static_cast<uint32_t>(a) << 18) | (static_cast<uint32_t>(b) << 12) | (static_cast<uint32_t>(c) << 6) | static_cast<uint32_t>(d);
+            uint8_t* out = output + i / 4 * 3;
+            out[0] = static_cast<uint8_t>(group >> 16);
+            out[1] = static_cast<uint8_t>(group >> 8);
+            out[2] = static_cast<uint8_t>(group);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Valor de un dígito hexadecimal (mayúscula o minúscula), o -1.
+     */
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    /**
+     * @brief Valor de un carácter del alfabeto Base64 estándar, o -1.
+     */
+    static int base64Value(char c) {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    }
+
+private:
+    static constexpr const char* HEX_DIGITS = "0123456789abcdef";
+    static constexpr const char* BASE64_DIGITS = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#if CRIPTO_X86_SIMD
+    // --- Hexadecimal ---
+
+    __attribute__((target("ssse3")))
+    static size_t encodeHexLinesSSSE3(const uint8_t* input, size_t lines, char* output) {
+        const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_DIGITS));
+        const __m128i lowNibble = _mm_set1_epi8(0x0F);
+        for (size_t line = 0; line < lines; ++line) {
+            const uint8_t* in = input + line * HEX_LINE_BYTES;
+            char* out = output + line * (LINE_CHARS + 1);
+            for (size_t i = 0; i < HEX_LINE_BYTES; i += 16) {
+                const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                const __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(data, 4), lowNibble));
+                const __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(data, lowNibble));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi8(high, low));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), _mm_unpackhi_epi8(high, low));
+            }
+            out[LINE_CHARS] = '\n';
+        }
+        return lines;
+    }
+
+    __attribute__((target("avx2")))
+    static size_t encodeHexLinesAVX2(const uint8_t* input, size_t lines, char* output) {
+        const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_DIGITS)));
+        const __m256i lowNibble = _mm256_set1_epi16(0x000F);
+        for (size_t line = 0; line < lines; ++line) {
+            const uint8_t* in = input + line * HEX_LINE_BYTES;
+            char* out = output + line * (LINE_CHARS + 1);
+            for (size_t i = 0; i < HEX_LINE_BYTES; i += 16) {
+                // Cada byte pasa a 16 bits: el nibble alto va al byte bajo (se escribe
+                // primero) y el bajo al alto.
+                const __m256i wide = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+                const __m256i nibbles = _mm256_or_si256(_mm256_srli_epi16(wide, 4), _mm256_slli_epi16(_mm256_and_si256(wide, lowNibble), 8));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i), _mm256_shuffle_epi8(digits, nibbles));
+            }
+            out[LINE_CHARS] = '\n';
+        }
+        return lines;
+    }
+
+    __attribute__((target("ssse3")))
+    static __m128i hexValuesSSSE3(__m128i chars, __m128i& invalid) {
+        const __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+        const __m128i folded = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+        const __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(folded, _mm_set1_epi8('f' + 1)));
+        invalid = _mm_or_si128(invalid, _mm_xor_si128(_mm_or_si128(isDigit, isLetter), _mm_set1_epi8(-1)));
+        const __m128i value = _mm_or_si128(_mm_and_si128(isDigit, _mm_sub_epi8(chars, _mm_set1_epi8('0'))),
+                                           _mm_and_si128(isLetter, _mm_sub_epi8(folded, _mm_set1_epi8('a' - 10))));
+        // Cada par de caracteres (alto, bajo) se junta en un byte de 16 bits.
+        return _mm_maddubs_epi16(value, _mm_set1_epi16(0x0110));
+    }
+
+    /**
+     * @return Caracteres procesados (múltiplo de 32), o SIZE_MAX si alguno no es válido.
+     */
+    __attribute__((target("ssse3")))
+    static size_t decodeHexSSSE3(const char* input, size_t size, uint8_t* output) {
+        __m128i invalid = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            const __m128i first = hexValuesSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)), invalid);
+            const __m128i second = hexValuesSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 16)), invalid);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i / 2), _mm_packus_epi16(first, second));
+        }
+        return _mm_movemask_epi8(invalid) != 0 ? SIZE_MAX : i;
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i hexValuesAVX2(__m256i chars, __m256i& invalid) {
+        const __m256i isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chars));
+        const __m256i folded = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+        const __m256i isLetter = _mm256_and_si256(_mm256_cmpgt_epi8(folded, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), folded));
+        invalid = _mm256_or_si256(invalid, _mm256_xor_si256(_mm256_or_si256(isDigit, isLetter), _mm256_set1_epi8(-1)));
+        const __m256i value = _mm256_or_si256(_mm256_and_si256(isDigit, _mm256_sub_epi8(chars, _mm256_set1_epi8('0'))),
+                                              _mm256_and_si256(isLetter, _mm256_sub_epi8(folded, _mm256_set1_epi8('a' - 10))));
+        return _mm256_maddubs_epi16(value, _mm256_set1_epi16(0x0110));
+    }
+
+    __attribute__((target("avx2")))
+    static size_t decodeHexAVX2(const char* input, size_t size, uint8_t* output) {
+        __m256i invalid = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 64 <= size; i += 64) {
+            const __m256i first = hexValuesAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i)), invalid);
+            const __m256i second = hexValuesAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i + 32)), invalid);
+            // packus empaqueta por mitades de 128 bits; el permute devuelve el orden.
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i / 2), packed);
+        }
+        return _mm256_movemask_epi8(invalid) != 0 ? SIZE_MAX : i;
+    }
+
+    // --- Base64 ---
+
+    /**
+     * @brief 12 bytes (de 16 cargados) a 16 índices de 6 bits, en el orden de salida.
+     */
+    __attribute__((target("ssse3")))
+    static __m128i base64IndicesSSSE3(__m128i data) {
+        data = _mm_shuffle_epi8(data, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+        const __m128i first = _mm_mulhi_epu16(_mm_and_si128(data, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+        const __m128i second = _mm_mullo_epi16(_mm_and_si128(data, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+        return _mm_or_si128(first, second);
+    }
+
+    /**
+     * @brief Índices 0..63 a letras: se suma un desplazamiento elegido por rangos
+     * (A-Z, a-z, 0-9, '+' y '/').
+     */
+    __attribute__((target("ssse3")))
+    static __m128i base64CharsSSSE3(__m128i indices) {
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+        const __m128i shifts = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+        return _mm_add_epi8(_mm_shuffle_epi8(shifts, range), indices);
+    }
+
+    __attribute__((target("ssse3")))
+    static size_t encodeBase64LinesSSSE3(const uint8_t* input, size_t lines, char* output) {
+        for (size_t line = 0; line < lines; ++line) {
+            const uint8_t* in = input + line * BASE64_LINE_BYTES;
+            char* out = output + line * (LINE_CHARS + 1);
+            for (size_t i = 0; i < BASE64_LINE_BYTES; i += 12) {
+                const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 3 * 4), base64CharsSSSE3(base64IndicesSSSE3(data)));
+            }
+            out[LINE_CHARS] = '\n';
+        }
+        return lines;
+    }
+
+    __attribute__((target("avx2")))
+    static size_t encodeBase64LinesAVX2(const uint8_t* input, size_t lines, char* output) {
+        const __m256i shuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                                10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+        const __m256i shifts = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+        for (size_t line = 0; line < lines; ++line) {
+            const uint8_t* in = input + line * BASE64_LINE_BYTES;
+            char* out = output + line * (LINE_CHARS + 1);
+            for (size_t i = 0; i < BASE64_LINE_BYTES; i += 24) {
+                // 12 bytes en cada mitad de 128 bits.
+                __m256i data = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))),
+                                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12)), 1);
+                data = _mm256_shuffle_epi8(data, shuffle);
+                const __m256i first = _mm256_mulhi_epu16(_mm256_and_si256(data, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+                const __m256i second = _mm256_mullo_epi16(_mm256_and_si256(data, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+                const __m256i indices = _mm256_or_si256(first, second);
+                __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+                range = _mm256_or_si256(range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i / 3 * 4), _mm256_add_epi8(_mm256_shuffle_epi8(shifts, range), indices));
+            }
+            out[LINE_CHARS] = '\n';
+        }
+        return lines;
+    }
+
+    /**
+     * @brief 16 caracteres a sus valores de 6 bits; marca en `invalid` los que no son
+     * del alfabeto.
+     */
+    __attribute__((target("ssse3")))
+    static __m128i base64ValuesSSSE3(__m128i chars, __m128i& invalid) {
+        const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('Z' + 1)));
+        const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('z' + 1)));
+        const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+        const __m128i plus = _mm_cmpeq_epi8(chars, _mm_set1_epi8('+'));
+        const __m128i slash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+        const __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+        invalid = _mm_or_si128(invalid, _mm_xor_si128(valid, _mm_set1_epi8(-1)));
+        __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+        shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+        shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+        shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(62 - '+')));
+        shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+        return _mm_add_epi8(chars, shift);
+    }
+
+    __attribute__((target("ssse3")))
+    static size_t decodeBase64SSSE3(const char* input, size_t size, uint8_t* output) {
+        __m128i invalid = _mm_setzero_si128();
+        const __m128i order = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            const __m128i values = base64ValuesSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)), invalid);
+            // (a << 6 | b) y (c << 6 | d) en 16 bits, y después los 24 bits de cada grupo en 32.
+            const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+            const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+            const __m128i bytes = _mm_shuffle_epi8(groups, order);
+            uint8_t* out = output + i / 4 * 3;
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out), bytes);
+            const uint32_t rest = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(bytes, 8)));
+            std::memcpy(out + 8, &rest, 4);
+        }
+        return _mm_movemask_epi8(invalid) != 0 ? SIZE_MAX : i;
+    }
+
+    __attribute__((target("avx2")))
+    static size_t decodeBase64AVX2(const char* input, size_t size, uint8_t* output) {
+        __m256i invalid = _mm256_setzero_si256();
+        const __m256i order = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                               2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+            const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), chars));
+            const __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), chars));
+            const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chars));
+            const __m256i plus = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('+'));
+            const __m256i slash = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('/'));
+            const __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, _mm256_or_si256(plus, slash)));
+            invalid = _mm256_or_si256(invalid, _mm256_xor_si256(valid, _mm256_set1_epi8(-1)));
+            __m256i shift = _mm256_and_si256(upper, _mm256_set1_epi8(-'A'));
+            shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+            shift = _mm256_or_si256(shift, _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+            shift = _mm256_or_si256(shift, _mm256_and_si256(plus, _mm256_set1_epi8(62 - '+')));
+            shift = _mm256_or_si256(shift, _mm256_and_si256(slash, _mm256_set1_epi8(63 - '/')));
+            const __m256i values = _mm256_add_epi8(chars, shift);
+
+            const __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+            const __m256i groups = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+            // 12 bytes útiles en cada mitad; se juntan los 24 al principio.
+            const __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(groups, order), compact);
+            uint8_t* out = output + i / 4 * 3;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(bytes));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 16), _mm256_extracti128_si256(bytes, 1));
+        }
+        return _mm256_movemask_epi8(invalid) != 0 ? SIZE_MAX : i;
+    }
+#endif
+};
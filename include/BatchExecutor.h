@@ -0,0 +1,323 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class BatchExecutor
+ * @brief Ejecuta un lote de tareas independientes sobre un grupo fijo de hilos.
+ *
+ * Cada hilo toma la siguiente tarea libre de un contador atómico compartido, de modo
+ * que los hilos que terminan antes siguen tomando trabajo (reparto dinámico). Cada
+ * tarea recibe su índice y el identificador del hilo que la ejecuta, lo que permite
+ * mantener un estado (por ejemplo, un codificador) por hilo sin sincronización.
+ */
+class BatchExecutor {
+public:
+    /**
+     * @brief Crea el ejecutor.
+     * @param jobs Número de hilos a usar; 0 usa todos los núcleos disponibles.
+     */
+    explicit BatchExecutor(unsigned int jobs = 0)
+        : workerCount(jobs == 0 ? defaultJobs() : jobs) {}
+
+    /**
+     * @brief Número de hilos que usará el ejecutor.
+     */
+    unsigned int jobs() const {
+        return workerCount;
+    }
+
+    /**
+     * @brief Ejecuta `taskCount` tareas y espera a que terminen todas.
+     * @param taskCount Número de tareas.
+     * @param task Función con la firma `void(size_t taskIndex, unsigned int workerId)`.
+     */
+    void run(size_t taskCount, const std::function<void(size_t, unsigned int)>& task) const {
+        unsigned int threads = static_cast<unsigned int>(std::min<size_t>(workerCount, taskCount));
+        if (threads <= 1) {
+            for (size_t i = 0; i < taskCount; ++i) {
+                task(i, 0);
+            }
+            return;
+        }
+
+        std::atomic<size_t> nextTask{0};
+        auto worker = [&](unsigned int workerId) {
+            for (size_t i = nextTask.fetch_add(1); i < taskCount; i = nextTask.fetch_add(1)) {
+                task(i, workerId);
+            }
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (unsigned int id = 1; id < threads; ++id) {
+            pool.emplace_back(worker, id);
+        }
+        worker(0); // El hilo que llama también trabaja.
+        for (auto& t : pool) {
+            t.join();
+        }
+    }
+
+    /**
+     * @brief Número de hilos por defecto: los núcleos lógicos de la máquina.
+     */
+    static unsigned int defaultJobs() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+private:
+    unsigned int workerCount;
+};
+
+/**
+ * @class WorkerPool
+ * @brief Grupo de hilos persistente para repartir muchos lotes pequeños seguidos.
+ *
+ * BatchExecutor crea y une sus hilos en cada run(). Aquí los hilos se crean en el
+ * primer run() que los necesita y se quedan esperando el siguiente lote, así que
+ * repartir cada fragmento de un flujo entre hilos no cuesta crear hilos nuevos.
+ * Copiar un grupo da otro vacío: cada copia arranca sus propios hilos al usarse.
+ */
+class WorkerPool {
+public:
+    WorkerPool() = default;
+
+    WorkerPool(const WorkerPool&) {}
+
+    WorkerPool& operator=(const WorkerPool&) {
+        return *this;
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : helpers) {
+            t.join();
+        }
+    }
+
+    /**
+     * @brief Ejecuta `taskCount` tareas con `threads` hilos (el que llama es uno de
+     * ellos) y espera a que terminen todas.
+     * @param task Función con la firma `void(size_t taskIndex, unsigned int workerId)`.
+     */
+    void run(unsigned int threads, size_t taskCount, const std::function<void(size_t, unsigned int)>& task) {
+        threads = static_cast<unsigned int>(std::min<size_t>(threads, taskCount));
+        if (threads <= 1) {
+            for (size_t i = 0; i < taskCount; ++i) {
+                task(i, 0);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (helpers.size() < threads - 1) {
+                // Cada hilo nuevo solo atiende los lotes posteriores a su creación.
+                helpers.emplace_back(&WorkerPool::helper, this, static_cast<unsigned int>(helpers.size() + 1), generation);
+            }
+            job = &task;
+            jobTasks = taskCount;
+            jobThreads = threads;
+            nextTask = 0;
+            busy = threads - 1;
+            generation++;
+        }
+        wake.notify_all();
+        for (size_t i = nextTask.fetch_add(1); i < taskCount; i = nextTask.fetch_add(1)) {
+            task(i, 0);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return busy == 0; });
+    }
+
+private:
+    void helper(unsigned int id, uint64_t seen) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            if (id >= jobThreads) {
+                continue;
+            }
+            const auto* task = job;
+            const size_t count = jobTasks;
+            lock.unlock();
+            for (size_t i = nextTask.fetch_add(1); i < count; i = nextTask.fetch_add(1)) {
+                (*task)(i, id);
+            }
+            lock.lock();
+            if (--busy == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::vector<std::thread> helpers;
+    const std::function<void(size_t, unsigned int)>* job = nullptr;
+    size_t jobTasks = 0;
+    unsigned int jobThreads = 0;
+    std::atomic<size_t> nextTask{0};
+    unsigned int busy = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+};
+
+/**
+ * @class OrderedReporter
+ * @brief Imprime los mensajes de un lote en el orden original de las tareas.
+ *
+ * Las tareas pueden terminar en cualquier orden; cada una entrega su mensaje y el
+ * reportero lo imprime en cuanto todas las tareas anteriores han entregado el suyo.
+ * Así la salida por consola es la misma que en una ejecución secuencial.
+ */
+class OrderedReporter {
+public:
+    explicit OrderedReporter(size_t taskCount)
+        : messages(taskCount), ready(taskCount, false) {}
+
+    /**
+     * @brief Entrega el mensaje de una tarea.
+     * @param taskIndex Índice de la tarea.
+     * @param text Texto a imprimir (puede estar vacío).
+     * @param isError Si es verdadero se imprime por `std::cerr` en lugar de `std::cout`.
+     */
+    void report(size_t taskIndex, std::string text, bool isError) {
+        std::lock_guard<std::mutex> lock(mutex);
+        messages[taskIndex] = Message{std::move(text), isError};
+        ready[taskIndex] = true;
+        while (nextToPrint < ready.size() && ready[nextToPrint]) {
+            const Message& message = messages[nextToPrint];
+            (message.isError ? std::cerr : std::cout) << message.text << std::flush;
+            messages[nextToPrint] = Message{};
+            nextToPrint++;
+        }
+    }
+
+private:
+    struct Message {
+        std::string text;
+        bool isError = false;
+    };
+
+    std::mutex mutex;
+    std::vector<Message> messages;
+    std::vector<bool> ready;
+    size_t nextToPrint = 0;
+};
+
+/**
+ * @class BoundedQueue
+ * @brief Cola bloqueante de capacidad fija entre un productor y varios consumidores.
+ *
+ * push() espera mientras la cola está llena, así que el productor nunca va más de
+ * `capacity` elementos por delante de los consumidores (contrapresión) y la memoria no
+ * crece aunque lleguen trabajos más rápido de lo que se procesan.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : limit(std::max<size_t>(1, capacity)) {}
+
+    /**
+     * @brief Añade un elemento solo si cabe.
+     * @return Falso si la cola está llena (o cerrada).
+     */
+    bool tryPush(T item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed || items.size() >= limit) {
+                return false;
+            }
+            items.push_back(std::move(item));
+            highWater = std::max(highWater, items.size());
+        }
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Añade un elemento; espera a que haya sitio.
+     * @return Falso si la cola se cerró mientras esperaba.
+     */
+    bool push(T item) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [this] { return closed || items.size() < limit; });
+            if (closed) {
+                return false;
+            }
+            items.push_back(std::move(item));
+            highWater = std::max(highWater, items.size());
+        }
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Espera un elemento.
+     * @return Falso cuando la cola está cerrada y ya no quedan elementos.
+     */
+    bool pop(T& item) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+            if (items.empty()) {
+                return false;
+            }
+            item = std::move(items.front());
+            items.pop_front();
+        }
+        notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief No se aceptan más elementos; los consumidores terminan los que quedan.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+    size_t capacity() const {
+        return limit;
+    }
+
+    /**
+     * @brief Máximo de elementos que llegó a tener la cola.
+     */
+    size_t peak() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return highWater;
+    }
+
+private:
+    const size_t limit;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<T> items;
+    size_t highWater = 0;
+    bool closed = false;
+};
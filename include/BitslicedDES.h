@@ -0,0 +1,250 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+#include "DESKey.h"
+#include "DESTables.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+/**
+ * @class BitslicedDES
+ * @brief Núcleo DES "bitsliced": procesa tantos bloques a la vez como bits tiene `Word`.
+ *
+ * El estado se guarda transpuesto: la palabra `q` contiene el bit `q` (numerado desde
+ * el más significativo) de todos los bloques. Así la expansión y la permutación P son
+ * simples selecciones de palabras y cada S-box se evalúa como una red de puertas
+ * AND/OR sobre todos los bloques a la vez. La red se genera en compilación a partir
+ * de DESTables::SBOX, de modo que siempre coincide con el núcleo por tablas.
+ *
+ * Las claves también van transpuestas, por lo que cada bloque puede usar una clave
+ * distinta: es lo que necesita una búsqueda de claves.
+ *
+ * @tparam Word `uint64_t` (64 bloques) o un tipo vectorial de GCC con elementos de 64 bits.
+ */
+template <typename Word>
+class BitslicedDES {
+public:
+    static constexpr size_t LANES = sizeof(Word) * 8;
+    using Planes = std::array<Word, 64>;
+
+    /**
+     * @brief Transpone `LANES` bloques de 64 bits a planos de bits.
+     */
+    static void load(const uint64_t* blocks, Planes& planes) {
+        for (size_t group = 0; group < LANES / 64; ++group) {
+            uint64_t matrix[64];
+            std::memcpy(matrix, blocks + group * 64, sizeof(matrix));
+            transpose64(matrix);
+            for (size_t q = 0; q < 64; ++q) {
+                std::memcpy(reinterpret_cast<char*>(&planes[q]) + group * 8, &matrix[q], 8);
+            }
+        }
+    }
+
+    /**
+     * @brief Operación inversa de load(): vuelve a formar los `LANES` bloques.
+     */
+    static void store(const Planes& planes, uint64_t* blocks) {
+        for (size_t group = 0; group < LANES / 64; ++group) {
+            uint64_t matrix[64];
+            for (size_t q = 0; q < 64; ++q) {
+                std::memcpy(&matrix[q], reinterpret_cast<const char*>(&planes[q]) + group * 8, 8);
+            }
+            transpose64(matrix);
+            std::memcpy(blocks + group * 64, matrix, sizeof(matrix));
+        }
+    }
+
+    /**
+     * @brief Planos de clave con la misma clave en todos los bloques.
+     */
+    static void broadcastKey(uint64_t keyBits, Planes& keyPlanes) {
+        for (size_t q = 0; q < 64; ++q) {
+            keyPlanes[q] = ((keyBits >> (63 - q)) & 1) ? ~Word{} : Word{};
+        }
+    }
+
+    /**
+     * @brief Cifra o descifra en el sitio los bloques transpuestos.
+     * @summary La subclave de la ronda r es `(clave >> r)` truncada a 48 bits, así que su
+     * bit en la posición i (desde el más significativo) es el plano de clave `16 + i - r`.
+     */
+    static void crypt(Planes& state, const Planes& keyPlanes, bool encrypting) {
+        Word left[32];
+        Word right[32];
+        for (int i = 0; i < 32; ++i) {
+            left[i] = state[i];
+            right[i] = state[32 + i];
+        }
+
+        for (int step = 0; step < 16; ++step) {
+            int round = encrypting ? step : 15 - step;
+            Word expanded[48];
+            for (int i = 0; i < 48; ++i) {
+                expanded[i] = right[DESTables::EXPANSION_TABLE[i] - 1] ^ keyPlanes[16 + i - round];
+            }
+            Word substituted[32];
+            for (int box = 0; box < 8; ++box) {
+                sbox(expanded + 6 * box, substituted + 4 * box);
+            }
+            for (int i = 0; i < 32; ++i) {
+                Word newRight = left[i] ^ substituted[DESTables::P_TABLE[i] - 1];
+                left[i] = right[i];
+                right[i] = newRight;
+            }
+        }
+
+        // Igual que el núcleo por tablas: la salida es (derecha, izquierda).
+        for (int i = 0; i < 32; ++i) {
+            state[i] = right[i];
+            state[32 + i] = left[i];
+        }
+    }
+
+private:
+    /**
+     * @brief Transpone en el sitio una matriz de 64x64 bits (la operación es su propia inversa).
+     */
+    static void transpose64(uint64_t* a) {
+        uint64_t mask = 0x00000000FFFFFFFFull;
+        for (int j = 32; j != 0; j >>= 1, mask ^= (mask << j)) {
+            for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+                uint64_t t = (a[k] ^ (a[k | j] >> j)) & mask;
+                a[k] ^= t;
+                a[k | j] ^= t << j;
+            }
+        }
+    }
+
+    /**
+     * @brief Calcula la OR de las columnas cuya salida de la S-box, en la fila `Row`, tiene a 1 el bit `Bit`.
+     * Las condiciones son constantes de compilación, así que solo quedan las OR necesarias.
+     */
+    template <int Row, int Bit, size_t... Col>
+    static void rowOutput(const Word* columns, Word& acc, std::index_sequence<Col...>) {
+        acc = Word{};
+        ((acc = ((DESTables::SBOX[Row][Col] >> (3 - Bit)) & 1) ? (acc | columns[Col]) : acc), ...);
+    }
+
+    template <int Bit>
+    static void sboxBit(const Word* rows, const Word* columns, Word& out) {
+        auto cols = std::make_index_sequence<16>{};
+        Word r0, r1, r2, r3;
+        rowOutput<0, Bit>(columns, r0, cols);
+        rowOutput<1, Bit>(columns, r1, cols);
+        rowOutput<2, Bit>(columns, r2, cols);
+        rowOutput<3, Bit>(columns, r3, cols);
+        out = (rows[0] & r0) | (rows[1] & r1) | (rows[2] & r2) | (rows[3] & r3);
+    }
+
+    /**
+     * @brief S-box como red de puertas: los bits exterior (fila) e interiores (columna)
+     * se decodifican en 4 y 16 mintérminos, y cada bit de salida es la OR de los
+     * mintérminos que lo ponen a 1.
+     */
+    static void sbox(const Word* in, Word* out) {
+        const Word a0 = in[0], a1 = in[1], a2 = in[2], a3 = in[3], a4 = in[4], a5 = in[5];
+        const Word rows[4] = {~a0 & ~a5, ~a0 & a5, a0 & ~a5, a0 & a5};
+        const Word high[4] = {~a1 & ~a2, ~a1 & a2, a1 & ~a2, a1 & a2};
+        const Word low[4] = {~a3 & ~a4, ~a3 & a4, a3 & ~a4, a3 & a4};
+        Word columns[16];
+        for (int c = 0; c < 16; ++c) {
+            columns[c] = high[c >> 2] & low[c & 3];
+        }
+        sboxBit<0>(rows, columns, out[0]);
+        sboxBit<1>(rows, columns, out[1]);
+        sboxBit<2>(rows, columns, out[2]);
+        sboxBit<3>(rows, columns, out[3]);
+    }
+};
+
+/**
+ * @class BitslicedDESEngine
+ * @brief Fachada del núcleo bitsliced que elige el ancho según el procesador:
+ * 64 bloques por palabra de 64 bits, 256 con AVX2 o 512 con AVX-512.
+ */
+class BitslicedDESEngine {
+public:
+    /**
+     * @brief Número de bloques que se procesan a la vez en este procesador.
+     */
+    static size_t lanes() {
+#if CRIPTO_X86_SIMD
+        if (CpuFeatures::level() >= SimdLevel::AVX512) return BitslicedDES<Vec512>::LANES;
+        if (CpuFeatures::level() >= SimdLevel::AVX2) return BitslicedDES<Vec256>::LANES;
+#endif
+        return BitslicedDES<uint64_t>::LANES;
+    }
+
+    /**
+     * @brief Cifra o descifra `lanes()` bloques con la misma clave.
+     */
+    static void cryptGroup(const DESKey& key, bool encrypting, const uint64_t* input, uint64_t* output) {
+        uint64_t keys[MAX_LANES];
+        for (size_t i = 0; i < lanes(); ++i) {
+            keys[i] = key.keyBits();
+        }
+        cryptGroup(keys, true, encrypting, input, output);
+    }
+
+    /**
+     * @brief Cifra o descifra `lanes()` bloques, cada uno con su propia clave. Es el núcleo
+     * de la búsqueda de claves: un mismo bloque se prueba con muchas claves a la vez.
+     * @param keyBits Claves normalizadas (DESKey::packKey), una por bloque.
+     */
+    static void cryptGroupKeys(const uint64_t* keyBits, bool encrypting, const uint64_t* input, uint64_t* output) {
+        cryptGroup(keyBits, false, encrypting, input, output);
+    }
+
+    static constexpr size_t MAX_LANES = 512;
+
+private:
+#if CRIPTO_X86_SIMD
+    typedef uint64_t Vec256 __attribute__((vector_size(32)));
+    typedef uint64_t Vec512 __attribute__((vector_size(64)));
+#endif
+
+    template <typename Word>
+    static void run(const uint64_t* keyBits, bool sameKey, bool encrypting, const uint64_t* input, uint64_t* output) {
+        using Engine = BitslicedDES<Word>;
+        typename Engine::Planes keyPlanes;
+        if (sameKey) {
+            Engine::broadcastKey(keyBits[0], keyPlanes);
+        } else {
+            Engine::load(keyBits, keyPlanes);
+        }
+        typename Engine::Planes state;
+        Engine::load(input, state);
+        Engine::crypt(state, keyPlanes, encrypting);
+        Engine::store(state, output);
+    }
+
+#if CRIPTO_X86_SIMD
+    // `flatten` inserta todo el núcleo en estas funciones, compiladas con AVX2/AVX-512.
+    __attribute__((target("avx2"), flatten))
+    static void runAVX2(const uint64_t* keyBits, bool sameKey, bool encrypting, const uint64_t* input, uint64_t* output) {
+        run<Vec256>(keyBits, sameKey, encrypting, input, output);
+    }
+
+    __attribute__((target("avx512f"), flatten))
+    static void runAVX512(const uint64_t* keyBits, bool sameKey, bool encrypting, const uint64_t* input, uint64_t* output) {
+        run<Vec512>(keyBits, sameKey, encrypting, input, output);
+    }
+#endif
+
+    static void cryptGroup(const uint64_t* keyBits, bool sameKey, bool encrypting, const uint64_t* input, uint64_t* output) {
+#if CRIPTO_X86_SIMD
+        if (CpuFeatures::level() >= SimdLevel::AVX512) {
+            runAVX512(keyBits, sameKey, encrypting, input, output);
+            return;
+        }
+        if (CpuFeatures::level() >= SimdLevel::AVX2) {
+            runAVX2(keyBits, sameKey, encrypting, input, output);
+            return;
+        }
+#endif
+        run<uint64_t>(keyBits, sameKey, encrypting, input, output);
+    }
+};
@@ -0,0 +1,204 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Cipher.h"
+#include "XOREncoder.h"
+#include "CesarEncoder.h"
+#include "VigenereEncoder.h"
+#include "DESEncoder.h"
+#include "Cryptanalysis.h"
+#include <algorithm>
+#include <cstring>
+#include <variant>
+
+/**
+ * @brief Una etapa de una cascada: el algoritmo (1 XOR, 2 Cesar, 3 Vigenere, 4 DES, igual
+ * que en el menú) y su clave.
+ */
+struct CascadeStage {
+    int algorithm = 0;
+    std::string key;
+};
+
+/**
+ * @class CascadeEncoder
+ * @brief Aplica varios cifrados seguidos (por ejemplo Vigenère, luego XOR y luego DES)
+ * en una sola pasada, sin archivos intermedios.
+ *
+ * Las etapas byte a byte (XOR, César y Vigenère) se aplican una tras otra sobre cada
+ * trozo de FUSED_CHUNK bytes mientras sigue en la caché, y DES, si está, va siempre al
+ * final sobre el mismo buffer, de una vez por fragmento para que pueda repartir los
+ * bloques entre hilos. Al descifrar se recorre la cadena al revés: primero DES y después
+ * las etapas byte a byte en orden inverso, en el sitio sobre la salida.
+ *
+ * La salida es la de la última etapa en el formato antiguo (sin contenedor .cif): el
+ * índice de un contenedor no puede guardar el estado de varias etapas.
+ */
+class CascadeEncoder {
+public:
+    /// Trozo sobre el que se encadenan las etapas; cabe en la caché L2.
+    static constexpr size_t FUSED_CHUNK = 32 << 10;
+
+    /**
+     * @brief Comprueba que la cadena se puede aplicar: al menos una etapa, algoritmos
+     * conocidos, claves no vacías y DES solo como última etapa.
+     */
+    static bool validate(const std::vector<CascadeStage>& stages, std::string& error) {
+        if (stages.empty()) {
+            error = "la cascada no tiene etapas";
+            return false;
+        }
+        for (size_t i = 0; i < stages.size(); ++i) {
+            if (stages[i].algorithm < 1 || stages[i].algorithm > 4) {
+                error = "algoritmo desconocido en la etapa " + std::to_string(i + 1);
+                return false;
+            }
+            if (stages[i].key.empty()) {
+                error = "la clave de la etapa " + std::to_string(i + 1) + " esta vacia";
+                return false;
+            }
+            if (stages[i].algorithm == 4 && i + 1 != stages.size()) {
+                error = "DES cifra por bloques y solo puede ser la ultima etapa";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Hilos para los bloques de la etapa DES (ver DESEncoder::setThreads()).
+     */
+    void setThreads(unsigned int threads) {
+        blockStage.setThreads(threads);
+    }
+
+    /**
+     * @brief Prepara la cadena. `stages` va siempre en el orden de cifrado; al descifrar
+     * se invierte aquí.
+     * @param desMode Modo de la etapa DES al cifrar; al descifrar se detecta en su cabecera.
+     */
+    void beginStream(const std::vector<CascadeStage>& stages, bool encrypting, DESMode desMode = DESMode::ECB) {
+        byteStages.clear();
+        hasBlockStage = false;
+        streamEncrypting = encrypting;
+        for (const CascadeStage& stage : stages) {
+            switch (stage.algorithm) {
+                case 1:
+                    std::get<XOREncoder>(byteStages.emplace_back(std::in_place_type<XOREncoder>)).beginStream(stage.key, encrypting);
+                    break;
+                case 2:
+                    // Se descifra cifrando con la clave inversa: el descifrado de César conserva
+                    // su fallo histórico con los dígitos y aquí entran bytes cualesquiera.
+                    std::get<CesarEncoder>(byteStages.emplace_back(std::in_place_type<CesarEncoder>))
+                        .beginStream(encrypting ? stage.key : Cryptanalysis::cesarInverseKey(stage.key), true);
+                    break;
+                case 3:
+                    std::get<VigenereEncoder>(byteStages.emplace_back(std::in_place_type<VigenereEncoder>)).beginStream(stage.key, encrypting);
+                    break;
+                default:
+                    blockStage.beginStream(DESKey(stage.key), encrypting, desMode);
+                    hasBlockStage = true;
+                    break;
+            }
+        }
+        if (!encrypting) {
+            std::reverse(byteStages.begin(), byteStages.end());
+        }
+    }
+
+    /**
+     * @brief Empieza un flujo nuevo en todas las etapas.
+     */
+    void restart() {
+        for (ByteStage& stage : byteStages) {
+            std::visit([](auto& cipher) { cipher.restart(); }, stage);
+        }
+        if (hasBlockStage) {
+            blockStage.restart();
+        }
+    }
+
+    /**
+     * @brief Solo DES cambia la longitud; las demás etapas no.
+     */
+    size_t outputBound(size_t inputSize) const {
+        return hasBlockStage ? blockStage.outputBound(inputSize) : inputSize;
+    }
+
+    /**
+     * @brief Pasa el siguiente fragmento por toda la cadena.
+     * @return Bytes escritos en `output` (como mucho `outputBound(input.size())`).
+     */
+    size_t transform(std::span<const std::byte> input, std::span<std::byte> output) {
+        if (!hasBlockStage) {
+            applyByteStages(input, output);
+            return input.size();
+        }
+        if (streamEncrypting) {
+            std::span<const std::byte> staged = input;
+            if (!byteStages.empty()) {
+                scratch.resize(std::max(scratch.size(), input.size()));
+                applyByteStages(input, std::span(scratch).first(input.size()));
+                staged = std::span(scratch).first(input.size());
+            }
+            return blockStage.transform(staged, output);
+        }
+        const size_t written = blockStage.transform(input, output);
+        applyByteStagesInPlace(output.first(written));
+        return written;
+    }
+
+    /**
+     * @brief Termina la etapa DES (padding al cifrar; al descifrar, el último bloque pasa
+     * además por las etapas byte a byte).
+     */
+    size_t finish(std::span<std::byte> output) {
+        if (!hasBlockStage) {
+            return 0;
+        }
+        const size_t written = blockStage.finish(output);
+        if (!streamEncrypting) {
+            applyByteStagesInPlace(output.first(written));
+        }
+        return written;
+    }
+
+private:
+    using ByteStage = std::variant<XOREncoder, CesarEncoder, VigenereEncoder>;
+
+    std::vector<ByteStage> byteStages;  ///< En el orden en que se aplican.
+    DESEncoder blockStage;
+    bool hasBlockStage = false;
+    bool streamEncrypting = true;
+    std::vector<std::byte> scratch;     ///< Fragmento ya pasado por las etapas byte a byte, antes de DES.
+
+    /**
+     * @brief Todas las etapas byte a byte, trozo a trozo: en cada trozo la primera etapa
+     * lee de `input` y escribe en `output`, y las demás trabajan en el sitio mientras el
+     * trozo sigue en la caché. Sin etapas, copia.
+     */
+    void applyByteStages(std::span<const std::byte> input, std::span<std::byte> output) {
+        if (byteStages.empty()) {
+            std::memmove(output.data(), input.data(), input.size());
+            return;
+        }
+        for (size_t offset = 0; offset < input.size(); offset += FUSED_CHUNK) {
+            const size_t size = std::min(FUSED_CHUNK, input.size() - offset);
+            const auto piece = output.subspan(offset, size);
+            std::visit([&](auto& cipher) { cipher.transform(input.subspan(offset, size), piece); }, byteStages.front());
+            for (size_t i = 1; i < byteStages.size(); ++i) {
+                std::visit([&](auto& cipher) { cipher.transformInPlace(piece); }, byteStages[i]);
+            }
+        }
+    }
+
+    void applyByteStagesInPlace(std::span<std::byte> data) {
+        for (size_t offset = 0; offset < data.size(); offset += FUSED_CHUNK) {
+            const auto piece = data.subspan(offset, std::min(FUSED_CHUNK, data.size() - offset));
+            for (ByteStage& stage : byteStages) {
+                std::visit([&](auto& cipher) { cipher.transformInPlace(piece); }, stage);
+            }
+        }
+    }
+};
+
+static_assert(Cipher<CascadeEncoder>);
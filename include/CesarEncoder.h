@@ -1,6 +1,9 @@
 ﻿#pragma once
 #include "Prerequisites.h"
+#include "ShiftKernel.h"
+#include "Cipher.h"
 #include <numeric>
+#include <string_view>
 
 /**
  * @class CesarEncoder
@@ -24,22 +27,12 @@ public:
      */
     std::string encode(const std::string& text, const std::string& key) {
         int shift = deriveShiftFromKey(key);
-        std::string result = "";
+        std::string result(text.size(), '\0');
 
         int letter_shift = (shift % 26 + 26) % 26;
         int digit_shift = (shift % 10 + 10) % 10;
 
-        for (char c : text) {
-            if (c >= 'A' && c <= 'Z') {
-                result += (char)(((c - 'A' + letter_shift) % 26) + 'A');
-            } else if (c >= 'a' && c <= 'z') {
-                result += (char)(((c - 'a' + letter_shift) % 26) + 'a');
-            } else if (c >= '0' && c <= '9') {
-                result += (char)(((c - '0' + digit_shift) % 10) + '0');
-            } else {
-                result += c;
-            }
-        }
+        ShiftKernel::caesar(text.data(), result.data(), text.size(), letter_shift, digit_shift);
         return result;
     }
 
@@ -58,17 +51,103 @@ public:
         return encode(text, std::string(1, (char)letter_shift_decode));
     }
 
+    // --- PROCESAMIENTO POR BLOQUES (STREAMING) ---
+
+    /**
+     * @brief Prepara el codificador para procesar un flujo de datos por fragmentos.
+     * @param key La clave en formato string.
+     * @param encrypting Verdadero para codificar, falso para decodificar.
+     */
+    void beginStream(const std::string& key, bool encrypting) {
+        int shift = deriveShiftFromKey(key);
+        if (!encrypting) {
+            // Mismo desplazamiento inverso que usa decode(), para que ambos caminos coincidan.
+            shift = 26 - (shift % 26);
+        }
+        streamLetterShift = (shift % 26 + 26) % 26;
+        streamDigitShift = (shift % 10 + 10) % 10;
+    }
+
+    /**
+     * @brief La clave tal como la usa César, para el valor de comprobación de un
+     * contenedor: el desplazamiento módulo 130 (26 letras y 10 dígitos), así que las
+     * claves equivalentes coinciden.
+     */
+    static std::string keyCheckMaterial(const std::string& key) {
+        return std::to_string(deriveShiftFromKey(key) % 130);
+    }
+
+    /**
+     * @brief Empieza un flujo nuevo con la misma clave. César no guarda estado entre
+     * fragmentos, así que no hay nada que reiniciar.
+     */
+    void restart() {}
+
+    /**
+     * @brief Estado para el índice de un contenedor. César no tiene estado: siempre 0.
+     */
+    uint64_t chunkState() const {
+        return 0;
+    }
+
+    /**
+     * @brief Continúa el flujo en cualquier fragmento; no hay nada que restaurar.
+     */
+    void seekChunk(uint64_t state, bool finalChunk) {
+        (void)state;
+        (void)finalChunk;
+    }
+
+    /**
+     * @brief César no cambia la longitud: la salida de un fragmento mide lo mismo que la entrada.
+     */
+    size_t outputBound(size_t inputSize) const {
+        return inputSize;
+    }
+
+    /**
+     * @brief Procesa el siguiente fragmento del flujo.
+     * @param input El fragmento de entrada.
+     * @param output Destino, de al menos `input.size()` bytes.
+     * @return Bytes escritos (siempre `input.size()`).
+     */
+    size_t transform(std::span<const std::byte> input, std::span<std::byte> output) {
+        ShiftKernel::caesar(reinterpret_cast<const char*>(input.data()), reinterpret_cast<char*>(output.data()), input.size(), streamLetterShift, streamDigitShift);
+        return input.size();
+    }
+
+    /**
+     * @brief Variante en el sitio de transform(): transforma el buffer sin copiarlo.
+     */
+    void transformInPlace(std::span<std::byte> data) {
+        char* bytes = reinterpret_cast<char*>(data.data());
+        ShiftKernel::caesar(bytes, bytes, data.size(), streamLetterShift, streamDigitShift);
+    }
+
+    /**
+     * @brief Termina el flujo. César no retiene datos, así que no produce salida.
+     */
+    size_t finish(std::span<std::byte> output) {
+        (void)output;
+        return 0;
+    }
+
 private:
+    int streamLetterShift = 0;
+    int streamDigitShift = 0;
+
     /**
      * @brief Deriva un desplazamiento numérico a partir de una clave de tipo string.
      * @param key La clave de entrada.
      * @return El desplazamiento numérico resultante.
      */
-    int deriveShiftFromKey(const std::string& key) {
+    static int deriveShiftFromKey(const std::string& key) {
         if (key.empty()) {
             return 0;
         }
         // Suma los valores ASCII de los caracteres de la clave para obtener el desplazamiento.
         return std::accumulate(key.begin(), key.end(), 0);
     }
-};
\ No newline at end of file
+};
+
+static_assert(InPlaceCipher<CesarEncoder> && ChunkedCipher<CesarEncoder>);
@@ -0,0 +1,313 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Cipher.h"
+#include "XXHash64.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+
+/**
+ * @class ChangeManifest
+ * @brief Registro de un lote incremental (--incremental): por cada archivo de entrada,
+ * su tamaño, su fecha de modificación, el resumen XXH64 de su contenido y la salida que
+ * produjo.
+ *
+ * Un archivo cuyo tamaño y fecha coinciden con el registro no se vuelve a leer; si solo
+ * cambió la fecha, el resumen evita cifrarlo otra vez. Si cambió el tamaño, el resumen se
+ * calcula al cifrarlo, sin una lectura aparte (HashingCipher). El registro guarda también la
+ * configuración del lote (algoritmo, modo, formato y una comprobación salada de la
+ * clave): si cambia, todo se vuelve a procesar.
+ *
+ * Es un archivo de texto: una cabecera y una línea por archivo con los campos
+ * separados por tabuladores.
+ */
+class ChangeManifest {
+public:
+    struct Entry {
+        uint64_t size = 0;
+        int64_t modified = 0;   ///< Fecha de modificación en ticks del reloj de archivos.
+        uint64_t hash = 0;      ///< XXH64 del contenido.
+        std::string output;     ///< Nombre del archivo de salida, dentro de la carpeta de salida.
+    };
+
+    /**
+     * @brief Lee el registro. Si el archivo no existe, el registro queda vacío.
+     * @return Falso si el archivo existe pero no es un registro válido (queda vacío).
+     */
+    bool load(const fs::path& path, std::string& error) {
+        entries.clear();
+        configuration.clear();
+        hasSalt = false;
+        std::ifstream input(path, std::ios::binary);
+        if (!input.is_open()) {
+            if (fs::exists(path)) {
+                error = "no se pudo leer";
+                return false;
+            }
+            return true;
+        }
+        std::string line;
+        if (!std::getline(input, line) || line != MAGIC) {
+            error = "no es un registro de cambios";
+            return false;
+        }
+        while (std::getline(input, line)) {
+            if (line.empty()) {
+                continue;
+            }
+            std::vector<std::string> fields = split(line);
+            bool ok = false;
+            if (fields[0] == "config" && fields.size() == 2) {
+                configuration = fields[1];
+                ok = true;
+            } else if (fields[0] == "salt" && fields.size() == 2 && fields[1].size() == 2 * saltBytes.size()) {
+                ok = true;
+                for (size_t i = 0; i < saltBytes.size(); ++i) {
+                    ok = ok && parseHex(fields[1].substr(2 * i, 2), saltBytes[i]);
+                }
+                hasSalt = ok;
+            } else if (fields[0] == "file" && fields.size() == 6) {
+                Entry entry;
+                try {
+                    entry.size = std::stoull(fields[2]);
+                    entry.modified = std::stoll(fields[3]);
+                    entry.hash = std::stoull(fields[4], nullptr, 16);
+                    entry.output = fields[5];
+                    entries[fields[1]] = entry;
+                    ok = true;
+                } catch (const std::exception&) {
+                }
+            }
+            if (!ok) {
+                entries.clear();
+                configuration.clear();
+                hasSalt = false;
+                error = "linea no valida: '" + line + "'";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Escribe el registro en un archivo temporal y lo renombra sobre `path`, así
+     * que una interrupción deja el registro anterior completo.
+     */
+    bool save(const fs::path& path, std::string& error) const {
+        fs::path temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+            if (!output.is_open()) {
+                error = "no se pudo crear '" + temporary.string() + "'";
+                return false;
+            }
+            output << MAGIC << "\n";
+            output << "config\t" << configuration << "\n";
+            output << "salt\t" << toHex(saltBytes.data(), saltBytes.size()) << "\n";
+            for (const auto& [name, entry] : entries) {
+                char hash[17];
+                std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(entry.hash));
+                output << "file\t" << name << "\t" << entry.size << "\t" << entry.modified << "\t" << hash << "\t" << entry.output << "\n";
+            }
+            output.flush();
+            if (!output) {
+                error = "no se pudo escribir '" + temporary.string() + "'";
+                return false;
+            }
+        }
+        std::error_code ec;
+        fs::rename(temporary, path, ec);
+        if (ec) {
+            error = "no se pudo reemplazar: " + ec.message();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Fija la configuración del lote. Si no coincide con la registrada, se
+     * descartan todas las entradas.
+     * @return Verdadero si la configuración cambió.
+     */
+    bool setConfiguration(const std::string& value) {
+        if (value == configuration) {
+            return false;
+        }
+        bool changed = !configuration.empty() || !entries.empty();
+        configuration = value;
+        entries.clear();
+        return changed;
+    }
+
+    /**
+     * @brief Sal de la comprobación de clave; se crea la primera vez.
+     */
+    const std::array<uint8_t, 16>& salt() {
+        if (!hasSalt) {
+            std::random_device device;
+            for (uint8_t& byte : saltBytes) {
+                byte = static_cast<uint8_t>(device());
+            }
+            hasSalt = true;
+        }
+        return saltBytes;
+    }
+
+    const Entry* find(const std::string& name) const {
+        auto it = entries.find(name);
+        return it == entries.end() ? nullptr : &it->second;
+    }
+
+    /**
+     * @brief Registra un archivo. Los nombres con tabuladores o saltos de línea no se
+     * registran: se vuelven a procesar siempre.
+     */
+    void set(const std::string& name, const Entry& entry) {
+        if ((name + entry.output).find_first_of("\t\r\n") != std::string::npos) {
+            return;
+        }
+        entries[name] = entry;
+    }
+
+    void erase(const std::string& name) {
+        entries.erase(name);
+    }
+
+    /**
+     * @brief Quita las entradas de archivos que ya no están en `inputDir`.
+     * @return Cuántas se quitaron.
+     */
+    size_t prune(const fs::path& inputDir) {
+        size_t removed = 0;
+        std::error_code ec;
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (fs::exists(inputDir / it->first, ec)) {
+                ++it;
+            } else {
+                it = entries.erase(it);
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    /**
+     * @brief Fecha de modificación de un archivo tal como se guarda en el registro.
+     */
+    static int64_t modificationTime(const fs::path& path, std::error_code& ec) {
+        return static_cast<int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+    }
+
+    /**
+     * @brief XXH64 del contenido de un archivo, leído por fragmentos en `buffer`.
+     */
+    static bool hashFile(const fs::path& path, std::vector<std::byte>& buffer, uint64_t& hash, std::string& error) {
+        std::ifstream input(path, std::ios::binary);
+        if (!input.is_open()) {
+            error = "Error: No se pudo leer el contenido de '" + path.string() + "'. Omitiendo.\n";
+            return false;
+        }
+        buffer.resize(std::max<size_t>(buffer.size(), 1 << 20));
+        XXHash64 hasher;
+        while (input.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size())) || input.gcount() > 0) {
+            hasher.update(buffer.data(), static_cast<size_t>(input.gcount()));
+        }
+        if (input.bad()) {
+            error = "Error: Fallo la lectura de '" + path.string() + "'. Omitiendo.\n";
+            return false;
+        }
+        hash = hasher.digest();
+        return true;
+    }
+
+    static std::string toHex(const uint8_t* data, size_t size) {
+        static const char* digits = "0123456789abcdef";
+        std::string hex;
+        for (size_t i = 0; i < size; ++i) {
+            hex += digits[data[i] >> 4];
+            hex += digits[data[i] & 0x0F];
+        }
+        return hex;
+    }
+
+private:
+    static constexpr const char* MAGIC = "CRIPTO-MANIFEST 1";
+
+    std::map<std::string, Entry> entries;
+    std::string configuration;
+    std::array<uint8_t, 16> saltBytes{};
+    bool hasSalt = false;
+
+    static std::vector<std::string> split(const std::string& line) {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (true) {
+            size_t tab = line.find('\t', start);
+            fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+            if (tab == std::string::npos) {
+                return fields;
+            }
+            start = tab + 1;
+        }
+    }
+
+    static bool parseHex(const std::string& text, uint8_t& value) {
+        try {
+            size_t used = 0;
+            unsigned long parsed = std::stoul(text, &used, 16);
+            value = static_cast<uint8_t>(parsed);
+            return used == text.size();
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+};
+
+/**
+ * @class HashingCipher
+ * @brief Pasa cada fragmento al codificador `inner` y acumula antes el XXH64 de la
+ * entrada, para resumir un archivo en la misma lectura que lo cifra.
+ */
+template <Cipher C>
+class HashingCipher {
+public:
+    explicit HashingCipher(C& inner) : inner(inner) {}
+
+    void restart() {
+        inner.restart();
+        hasher.reset();
+    }
+
+    size_t outputBound(size_t inputSize) const {
+        return inner.outputBound(inputSize);
+    }
+
+    size_t transform(std::span<const std::byte> input, std::span<std::byte> output) {
+        hasher.update(input.data(), input.size());
+        return inner.transform(input, output);
+    }
+
+    void transformInPlace(std::span<std::byte> data) requires InPlaceCipher<C> {
+        hasher.update(data.data(), data.size());
+        inner.transformInPlace(data);
+    }
+
+    size_t finish(std::span<std::byte> output) {
+        return inner.finish(output);
+    }
+
+    /**
+     * @brief XXH64 de todo lo que pasó por transform() desde el último restart().
+     */
+    uint64_t digest() const {
+        return hasher.digest();
+    }
+
+private:
+    C& inner;
+    XXHash64 hasher;
+};
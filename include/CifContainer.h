@@ -0,0 +1,614 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Cipher.h"
+#include "DESEncoder.h"
+#include "BatchExecutor.h"
+#include "SHA256.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string_view>
+
+/**
+ * @brief Parámetros guardados en la cabecera de un contenedor .cif.
+ */
+struct CifHeader {
+    uint8_t algorithm = 0;                        ///< 1 XOR, 2 Cesar, 3 Vigenere, 4 DES (igual que en el menú).
+    DESMode desMode = DESMode::ECB;               ///< Modo DES; ECB en los demás algoritmos.
+    uint16_t headerSize = 0;                      ///< Bytes de cabecera; los datos empiezan ahí.
+    uint32_t chunkSize = 0;                       ///< Bytes de texto plano por fragmento (múltiplo de 8).
+    uint64_t iv = 0;                              ///< IV de DES en CBC y CTR.
+    bool hasKeyCheck = false;                     ///< Lleva sal y valor de comprobación de clave.
+    std::array<uint8_t, 16> salt{};               ///< Sal aleatoria del valor de comprobación.
+    uint64_t keyCheck = 0;                        ///< Ver CifContainer::computeKeyCheck().
+};
+
+/**
+ * @brief Entrada del índice: dónde está un fragmento y el estado del codificador al empezarlo.
+ */
+struct CifChunk {
+    uint64_t recordOffset = 0; ///< Posición en el archivo del registro (longitud + datos).
+    uint64_t state = 0;        ///< Valor de chunkState() al empezar el fragmento.
+};
+
+/**
+ * @brief Índice de un contenedor, leído del final del archivo.
+ */
+struct CifIndex {
+    std::vector<CifChunk> chunks;
+    uint64_t plaintextSize = 0;
+    uint64_t indexOffset = 0;
+};
+
+/**
+ * @brief Buffers y codificadores para descifrar varios fragmentos a la vez. Se reutilizan
+ * entre archivos.
+ */
+template <typename C>
+struct CifWorkspace {
+    std::vector<C> ciphers;
+    std::vector<std::vector<std::byte>> input;
+    std::vector<std::vector<std::byte>> output;
+    std::vector<size_t> inputSizes;
+    std::vector<size_t> outputSizes;
+};
+
+/**
+ * @class CifContainer
+ * @brief Formato de los archivos .cif: cabecera con el algoritmo y sus parámetros,
+ * fragmentos que se descifran de forma independiente y un índice al final.
+ *
+ * Estructura (enteros big-endian):
+ * - Cabecera de HEADER_SIZE bytes: "CIFC", versión, algoritmo, modo DES, flags, tamaño
+ *   de cabecera, tamaño de fragmento e IV.
+ * - Con FLAG_KEY_CHECK, KEY_CHECK_SIZE bytes más: la sal y el valor de comprobación de
+ *   clave, para rechazar una clave incorrecta sin descifrar nada.
+ * - Un registro por fragmento: longitud (4 bytes) y el texto cifrado de `chunkSize`
+ *   bytes de texto plano. El último puede ser más corto (o tener el padding de DES).
+ * - Un registro de longitud 0 que marca el final de los datos.
+ * - El índice: por fragmento, la posición de su registro y el estado del codificador.
+ * - Un pie de FOOTER_SIZE bytes: posición del índice, número de fragmentos, tamaño del
+ *   texto plano y "CIDX".
+ *
+ * Los fragmentos forman un único flujo cifrado, así que el archivo se puede descifrar
+ * de principio a fin sin el índice (por ejemplo, desde la entrada estándar). Con el
+ * índice se descifra solo un rango o varios fragmentos en paralelo.
+ */
+class CifContainer {
+public:
+    static constexpr char MAGIC[4] = {'C', 'I', 'F', 'C'};
+    static constexpr char INDEX_MAGIC[4] = {'C', 'I', 'D', 'X'};
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 32;
+    static constexpr uint8_t FLAG_KEY_CHECK = 0x01;
+    static constexpr size_t KEY_CHECK_SIZE = 24;
+    static constexpr size_t RECORD_HEADER_SIZE = 4;
+    static constexpr size_t INDEX_ENTRY_SIZE = 16;
+    static constexpr size_t FOOTER_SIZE = 28;
+    static constexpr uint32_t DEFAULT_CHUNK_SIZE = 1 << 20;
+    static constexpr uint32_t MAX_CHUNK_SIZE = 64 << 20;
+    // Un registro puede tener un bloque más que su texto plano (el padding de DES).
+    static constexpr size_t MAX_RECORD_OVERHEAD = 8;
+
+    /**
+     * @brief Verdadero si los datos empiezan con la firma de un contenedor.
+     */
+    static bool isContainer(std::string_view data) {
+        return data.size() >= sizeof(MAGIC) && data.substr(0, sizeof(MAGIC)) == std::string_view(MAGIC, sizeof(MAGIC));
+    }
+
+    /**
+     * @brief Escribe la cabecera en `output` (HEADER_SIZE bytes, más KEY_CHECK_SIZE si
+     * lleva comprobación de clave).
+     * @return Bytes escritos.
+     */
+    static size_t writeHeader(const CifHeader& header, char* output) {
+        const size_t size = HEADER_SIZE + (header.hasKeyCheck ? KEY_CHECK_SIZE : 0);
+        std::memset(output, 0, HEADER_SIZE);
+        std::memcpy(output, MAGIC, sizeof(MAGIC));
+        output[4] = static_cast<char>(VERSION);
+        output[5] = static_cast<char>(header.algorithm);
+        output[6] = static_cast<char>(header.desMode);
+        output[7] = static_cast<char>(header.hasKeyCheck ? FLAG_KEY_CHECK : 0);
+        storeU16(output + 8, static_cast<uint16_t>(size));
+        storeU32(output + 12, header.chunkSize);
+        storeU64(output + 16, header.iv);
+        if (header.hasKeyCheck) {
+            std::memcpy(output + HEADER_SIZE, header.salt.data(), header.salt.size());
+            storeU64(output + HEADER_SIZE + header.salt.size(), header.keyCheck);
+        }
+        return size;
+    }
+
+    /**
+     * @brief Valor de comprobación de clave: los primeros 8 bytes de
+     * SHA-256("CIFC-KCV" || sal || algoritmo || clave). Con la sal, el mismo valor no se
+     * repite entre archivos y no dice nada de la clave si no se adivina.
+     * @param keyMaterial La clave tal como la usa el algoritmo (ver keyCheckMaterial()
+     * de cada codificador), para que claves equivalentes den el mismo valor.
+     */
+    static uint64_t computeKeyCheck(const std::array<uint8_t, 16>& salt, uint8_t algorithm, std::string_view keyMaterial) {
+        SHA256 sha;
+        sha.update("CIFC-KCV");
+        sha.update(salt.data(), salt.size());
+        sha.update(&algorithm, 1);
+        sha.update(keyMaterial);
+        const SHA256::Digest digest = sha.finish();
+        return loadU64(reinterpret_cast<const char*>(digest.data()));
+    }
+
+    /**
+     * @brief Lee la sal y el valor de comprobación que siguen a los primeros HEADER_SIZE
+     * bytes, si la cabecera los tiene.
+     */
+    static bool readKeyCheck(std::istream& input, CifHeader& header, std::string& error) {
+        if (!header.hasKeyCheck) {
+            return true;
+        }
+        char data[KEY_CHECK_SIZE];
+        if (!input.read(data, KEY_CHECK_SIZE)) {
+            error = "la cabecera del contenedor esta incompleta";
+            return false;
+        }
+        std::memcpy(header.salt.data(), data, header.salt.size());
+        header.keyCheck = loadU64(data + header.salt.size());
+        return true;
+    }
+
+    /**
+     * @brief Lee y valida la cabecera de un contenedor.
+     * @param data Los primeros HEADER_SIZE bytes del archivo.
+     * @param error Recibe el motivo si la cabecera no es válida.
+     */
+    static bool parseHeader(std::string_view data, CifHeader& header, std::string& error) {
+        if (!isContainer(data) || data.size() < HEADER_SIZE) {
+            error = "la cabecera del contenedor esta incompleta";
+            return false;
+        }
+        uint8_t version = static_cast<uint8_t>(data[4]);
+        if (version != VERSION) {
+            error = "version de contenedor " + std::to_string(version) + " no soportada";
+            return false;
+        }
+        header.algorithm = static_cast<uint8_t>(data[5]);
+        uint8_t mode = static_cast<uint8_t>(data[6]);
+        uint8_t flags = static_cast<uint8_t>(data[7]);
+        header.hasKeyCheck = (flags & FLAG_KEY_CHECK) != 0;
+        header.headerSize = loadU16(data.data() + 8);
+        header.chunkSize = loadU32(data.data() + 12);
+        header.iv = loadU64(data.data() + 16);
+        if (header.algorithm < 1 || header.algorithm > 4 || mode > static_cast<uint8_t>(DESMode::CTR) ||
+            (mode != 0 && header.algorithm != 4) || (flags & ~FLAG_KEY_CHECK) != 0 ||
+            header.headerSize < HEADER_SIZE + (header.hasKeyCheck ? KEY_CHECK_SIZE : 0) ||
+            header.chunkSize == 0 || header.chunkSize % 8 != 0 || header.chunkSize > MAX_CHUNK_SIZE) {
+            error = "la cabecera del contenedor no es valida";
+            return false;
+        }
+        header.desMode = static_cast<DESMode>(mode);
+        return true;
+    }
+
+    /**
+     * @brief Lee y valida el índice del final del archivo.
+     */
+    static bool readIndex(std::istream& input, const CifHeader& header, CifIndex& index, std::string& error) {
+        error = "el indice del contenedor esta danado";
+        input.clear();
+        input.seekg(0, std::ios::end);
+        const uint64_t fileSize = static_cast<uint64_t>(input.tellg());
+        if (!input || fileSize < header.headerSize + RECORD_HEADER_SIZE + FOOTER_SIZE) {
+            return false;
+        }
+
+        char footer[FOOTER_SIZE];
+        input.seekg(static_cast<std::streamoff>(fileSize - FOOTER_SIZE));
+        if (!input.read(footer, FOOTER_SIZE) || std::memcmp(footer + 24, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+            return false;
+        }
+        index.indexOffset = loadU64(footer);
+        const uint64_t chunkCount = loadU64(footer + 8);
+        index.plaintextSize = loadU64(footer + 16);
+
+        // El índice va entre los registros y el pie, y sus entradas lo llenan justo. Se
+        // comprueba antes de reservar nada y sin sumas que puedan dar la vuelta: los
+        // valores del pie vienen del archivo.
+        const uint64_t indexEnd = fileSize - FOOTER_SIZE;
+        if (index.indexOffset < header.headerSize + RECORD_HEADER_SIZE || index.indexOffset > indexEnd ||
+            (indexEnd - index.indexOffset) % INDEX_ENTRY_SIZE != 0 || chunkCount != (indexEnd - index.indexOffset) / INDEX_ENTRY_SIZE) {
+            return false;
+        }
+        // Todos los fragmentos salvo el último (o los dos últimos, si el último solo
+        // lleva padding) están completos.
+        const uint64_t fullChunks = index.plaintextSize / header.chunkSize;
+        const uint64_t minChunks = fullChunks + (index.plaintextSize % header.chunkSize != 0 ? 1 : 0);
+        if (chunkCount < minChunks || chunkCount > fullChunks + 1) {
+            return false;
+        }
+
+        index.chunks.resize(static_cast<size_t>(chunkCount));
+        input.seekg(static_cast<std::streamoff>(index.indexOffset));
+        uint64_t previousEnd = header.headerSize;
+        for (CifChunk& chunk : index.chunks) {
+            char entry[INDEX_ENTRY_SIZE];
+            if (!input.read(entry, INDEX_ENTRY_SIZE)) {
+                return false;
+            }
+            chunk.recordOffset = loadU64(entry);
+            chunk.state = loadU64(entry + 8);
+            if (chunk.recordOffset < previousEnd || chunk.recordOffset > index.indexOffset - RECORD_HEADER_SIZE) {
+                return false;
+            }
+            previousEnd = chunk.recordOffset + RECORD_HEADER_SIZE;
+        }
+        error.clear();
+        return true;
+    }
+
+    /**
+     * @brief Descifra un contenedor de principio a fin, registro a registro, sin usar el
+     * índice: sirve para entradas que no permiten saltos. Al final comprueba el pie.
+     * @param input Flujo situado justo después de los primeros HEADER_SIZE bytes y, si
+     * la cabecera la tiene, de la comprobación de clave (readKeyCheck()).
+     * @param cipher Codificador preparado con los parámetros de la cabecera.
+     * @param inputBuffer Buffer de trabajo para los registros.
+     * @param outputBuffer Buffer de trabajo para el texto descifrado.
+     */
+    template <ChunkedCipher C>
+    static bool decodeStream(std::istream& input, std::ostream& output, const CifHeader& header, C& cipher,
+                             std::vector<std::byte>& inputBuffer, std::vector<std::byte>& outputBuffer, std::string& error) {
+        const size_t maxRecord = header.chunkSize + MAX_RECORD_OVERHEAD;
+        inputBuffer.resize(std::max(inputBuffer.size(), maxRecord));
+        outputBuffer.resize(std::max(outputBuffer.size(), cipher.outputBound(maxRecord)));
+        input.ignore(static_cast<std::streamsize>(header.headerSize - HEADER_SIZE - (header.hasKeyCheck ? KEY_CHECK_SIZE : 0)));
+
+        auto writeBytes = [&output](std::span<const std::byte> bytes) {
+            output.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        };
+
+        uint64_t records = 0;
+        uint64_t plaintextSize = 0;
+        while (true) {
+            char lengthBytes[RECORD_HEADER_SIZE];
+            if (!input.read(lengthBytes, RECORD_HEADER_SIZE)) {
+                error = "el contenedor esta incompleto";
+                return false;
+            }
+            const uint32_t length = loadU32(lengthBytes);
+            if (length == 0) {
+                break;
+            }
+            if (length > maxRecord || !input.read(reinterpret_cast<char*>(inputBuffer.data()), length)) {
+                error = "el contenedor esta danado o incompleto";
+                return false;
+            }
+            size_t produced = cipher.transform(std::span(inputBuffer).first(length), outputBuffer);
+            writeBytes(std::span(outputBuffer).first(produced));
+            plaintextSize += produced;
+            records++;
+        }
+        size_t produced = cipher.finish(outputBuffer);
+        writeBytes(std::span(outputBuffer).first(produced));
+        plaintextSize += produced;
+
+        char footer[FOOTER_SIZE];
+        input.ignore(static_cast<std::streamsize>(records * INDEX_ENTRY_SIZE));
+        if (!input.read(footer, FOOTER_SIZE) || std::memcmp(footer + 24, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+            loadU64(footer + 8) != records || loadU64(footer + 16) != plaintextSize) {
+            error = "el indice del contenedor no coincide con los datos (archivo danado o clave incorrecta)";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Descifra los bytes [offset, offset + length) del texto plano leyendo solo
+     * los fragmentos que los contienen. Los fragmentos se leen en grupos de `threads` y
+     * cada grupo se descifra en paralelo, con una copia de `model` por fragmento.
+     * @param model Codificador preparado con los parámetros de la cabecera.
+     */
+    template <ChunkedCipher C>
+    static bool decodeRange(std::istream& input, std::ostream& output, const CifHeader& header, const CifIndex& index,
+                            uint64_t offset, uint64_t length, const C& model, CifWorkspace<C>& workspace,
+                            unsigned int threads, std::string& error) {
+        if (offset >= index.plaintextSize || length == 0) {
+            return true;
+        }
+        const uint64_t end = offset + std::min(length, index.plaintextSize - offset);
+        const size_t firstChunk = static_cast<size_t>(offset / header.chunkSize);
+        const size_t lastChunk = std::min(index.chunks.size() - 1, static_cast<size_t>((end - 1) / header.chunkSize));
+        const size_t maxRecord = header.chunkSize + MAX_RECORD_OVERHEAD;
+
+        const size_t window = std::max<size_t>(1, std::min<size_t>(threads, lastChunk - firstChunk + 1));
+        workspace.ciphers.assign(window, model);
+        workspace.input.resize(window);
+        workspace.output.resize(window);
+        workspace.inputSizes.resize(window);
+        workspace.outputSizes.resize(window);
+        for (size_t slot = 0; slot < window; ++slot) {
+            workspace.input[slot].resize(maxRecord);
+            workspace.output[slot].resize(model.outputBound(maxRecord));
+        }
+        BatchExecutor executor(static_cast<unsigned int>(window));
+
+        for (size_t group = firstChunk; group <= lastChunk; group += window) {
+            const size_t count = std::min(window, lastChunk - group + 1);
+
+            // --- Lectura secuencial de los registros del grupo ---
+            for (size_t slot = 0; slot < count; ++slot) {
+                const size_t chunk = group + slot;
+                const uint64_t recordEnd = (chunk + 1 < index.chunks.size()) ? index.chunks[chunk + 1].recordOffset : index.indexOffset - RECORD_HEADER_SIZE;
+                char lengthBytes[RECORD_HEADER_SIZE];
+                input.seekg(static_cast<std::streamoff>(index.chunks[chunk].recordOffset));
+                const uint32_t recordLength = input.read(lengthBytes, RECORD_HEADER_SIZE) ? loadU32(lengthBytes) : 0;
+                if (recordLength == 0 || recordLength > maxRecord ||
+                    index.chunks[chunk].recordOffset + RECORD_HEADER_SIZE + recordLength != recordEnd ||
+                    !input.read(reinterpret_cast<char*>(workspace.input[slot].data()), recordLength)) {
+                    error = "el contenedor esta danado (fragmento " + std::to_string(chunk) + ")";
+                    return false;
+                }
+                workspace.inputSizes[slot] = recordLength;
+            }
+
+            // --- Descifrado en paralelo: cada fragmento con su codificador ---
+            executor.run(count, [&](size_t slot, unsigned int) {
+                const size_t chunk = group + slot;
+                const bool finalChunk = chunk + 1 == index.chunks.size();
+                C& cipher = workspace.ciphers[slot];
+                std::span<std::byte> out(workspace.output[slot]);
+                cipher.seekChunk(index.chunks[chunk].state, finalChunk);
+                size_t produced = cipher.transform(std::span(workspace.input[slot]).first(workspace.inputSizes[slot]), out);
+                if (finalChunk) {
+                    produced += cipher.finish(out.subspan(produced));
+                }
+                workspace.outputSizes[slot] = produced;
+            });
+
+            // --- Escritura en orden, recortada al rango pedido ---
+            for (size_t slot = 0; slot < count; ++slot) {
+                const uint64_t chunkStart = static_cast<uint64_t>(group + slot) * header.chunkSize;
+                const uint64_t expected = std::min<uint64_t>(header.chunkSize, index.plaintextSize - std::min(index.plaintextSize, chunkStart));
+                if (workspace.outputSizes[slot] != expected) {
+                    error = "el fragmento " + std::to_string(group + slot) + " no tiene el tamano esperado (archivo danado o clave incorrecta)";
+                    return false;
+                }
+                const uint64_t from = std::max(offset, chunkStart) - chunkStart;
+                const uint64_t to = std::min(end, chunkStart + expected) - chunkStart;
+                if (from < to) {
+                    output.write(reinterpret_cast<const char*>(workspace.output[slot].data() + from), static_cast<std::streamsize>(to - from));
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Lee hasta `maxBytes` del texto cifrado, sin cabecera ni registros (por
+     * ejemplo, para el criptoanálisis). Deja `input` en un estado indefinido.
+     */
+    static bool readCiphertext(std::istream& input, const CifHeader& header, size_t maxBytes, std::string& ciphertext) {
+        ciphertext.clear();
+        input.clear();
+        input.seekg(static_cast<std::streamoff>(header.headerSize));
+        while (ciphertext.size() < maxBytes) {
+            char lengthBytes[RECORD_HEADER_SIZE];
+            if (!input.read(lengthBytes, RECORD_HEADER_SIZE)) {
+                return false;
+            }
+            const uint32_t length = loadU32(lengthBytes);
+            if (length == 0) {
+                break;
+            }
+            if (length > header.chunkSize + MAX_RECORD_OVERHEAD) {
+                return false;
+            }
+            size_t base = ciphertext.size();
+            ciphertext.resize(base + length);
+            if (!input.read(ciphertext.data() + base, length)) {
+                return false;
+            }
+        }
+        if (ciphertext.size() > maxBytes) {
+            ciphertext.resize(maxBytes);
+        }
+        return true;
+    }
+
+    // --- ENTEROS BIG-ENDIAN ---
+
+    static uint16_t loadU16(const char* data) {
+        return static_cast<uint16_t>((static_cast<unsigned char>(data[0]) << 8) | static_cast<unsigned char>(data[1]));
+    }
+
+    static uint32_t loadU32(const char* data) {
+        uint32_t value = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            value = (value << 8) | static_cast<unsigned char>(data[i]);
+        }
+        return value;
+    }
+
+    static uint64_t loadU64(const char* data) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            value = (value << 8) | static_cast<unsigned char>(data[i]);
+        }
+        return value;
+    }
+
+    static void storeU16(char* data, uint16_t value) {
+        data[0] = static_cast<char>(value >> 8);
+        data[1] = static_cast<char>(value);
+    }
+
+    static void storeU32(char* data, uint32_t value) {
+        for (size_t i = 0; i < 4; ++i) {
+            data[i] = static_cast<char>(value >> (8 * (3 - i)));
+        }
+    }
+
+    static void storeU64(char* data, uint64_t value) {
+        for (size_t i = 0; i < 8; ++i) {
+            data[i] = static_cast<char>(value >> (8 * (7 - i)));
+        }
+    }
+};
+
+/**
+ * @class ContainerEncoder
+ * @brief Envuelve un codificador para que su salida sea un contenedor .cif. Cumple la
+ * interfaz Cipher, así que se usa igual que cualquier codificador.
+ *
+ * Los fragmentos completos que llegan en una sola llamada se cifran directamente en la
+ * salida; solo se copian los trozos de fragmento que quedan a medias entre llamadas.
+ */
+template <ChunkedCipher C>
+class ContainerEncoder {
+public:
+    /**
+     * @brief El codificador interno, para prepararlo con beginStream() (o con
+     * beginRawStream() en DES) antes de llamar a beginContainer().
+     */
+    C& cipher() {
+        return inner;
+    }
+
+    /**
+     * @brief Empieza el primer contenedor con el codificador interno ya preparado.
+     * @param algorithm Identificador del algoritmo (1 XOR, 2 Cesar, 3 Vigenere, 4 DES).
+     * @param keyMaterial La clave para el valor de comprobación de la cabecera.
+     */
+    void beginContainer(uint8_t algorithm, std::string keyMaterial, uint32_t chunkSize = CifContainer::DEFAULT_CHUNK_SIZE) {
+        header.algorithm = algorithm;
+        header.chunkSize = chunkSize;
+        header.hasKeyCheck = true;
+        header.headerSize = static_cast<uint16_t>(CifContainer::HEADER_SIZE + CifContainer::KEY_CHECK_SIZE);
+        checkMaterial = std::move(keyMaterial);
+        pending.resize(chunkSize);
+        restart();
+    }
+
+    /**
+     * @brief Empieza un contenedor nuevo con la misma clave (en DES, con un IV nuevo) y
+     * una sal nueva.
+     */
+    void restart() {
+        inner.restart();
+        for (size_t i = 0; i < header.salt.size(); i += 8) {
+            const uint64_t bits = saltGenerator();
+            std::memcpy(header.salt.data() + i, &bits, 8);
+        }
+        header.keyCheck = CifContainer::computeKeyCheck(header.salt, header.algorithm, checkMaterial);
+        headerWritten = false;
+        pendingFill = 0;
+        chunks.clear();
+        plaintextSize = 0;
+        position = 0;
+    }
+
+    /**
+     * @brief Tamaño máximo de la salida de transform() para `inputSize` bytes; con 0, el
+     * de finish() (que incluye el índice, así que crece con el archivo).
+     */
+    size_t outputBound(size_t inputSize) const {
+        const size_t record = CifContainer::RECORD_HEADER_SIZE + inner.outputBound(header.chunkSize);
+        return header.headerSize + (inputSize / header.chunkSize + 1) * record + CifContainer::RECORD_HEADER_SIZE +
+               (chunks.size() + 1) * CifContainer::INDEX_ENTRY_SIZE + CifContainer::FOOTER_SIZE;
+    }
+
+    size_t transform(std::span<const std::byte> input, std::span<std::byte> output) {
+        char* out = reinterpret_cast<char*>(output.data());
+        size_t written = writeHeaderOnce(out);
+        while (!input.empty()) {
+            if (pendingFill == 0 && input.size() >= header.chunkSize) {
+                written += writeRecord(input.first(header.chunkSize), out + written, false);
+                input = input.subspan(header.chunkSize);
+                continue;
+            }
+            size_t take = std::min(header.chunkSize - pendingFill, input.size());
+            std::memcpy(pending.data() + pendingFill, input.data(), take);
+            pendingFill += take;
+            input = input.subspan(take);
+            if (pendingFill == header.chunkSize) {
+                written += writeRecord(std::span(pending).first(pendingFill), out + written, false);
+                pendingFill = 0;
+            }
+        }
+        return written;
+    }
+
+    /**
+     * @brief Escribe el último fragmento, el registro de fin, el índice y el pie.
+     */
+    size_t finish(std::span<std::byte> output) {
+        char* out = reinterpret_cast<char*>(output.data());
+        size_t written = writeHeaderOnce(out);
+        written += writeRecord(std::span(pending).first(pendingFill), out + written, true);
+        pendingFill = 0;
+
+        CifContainer::storeU32(out + written, 0);
+        written += CifContainer::RECORD_HEADER_SIZE;
+        position += CifContainer::RECORD_HEADER_SIZE;
+        const uint64_t indexOffset = position;
+        for (const CifChunk& chunk : chunks) {
+            CifContainer::storeU64(out + written, chunk.recordOffset);
+            CifContainer::storeU64(out + written + 8, chunk.state);
+            written += CifContainer::INDEX_ENTRY_SIZE;
+        }
+        CifContainer::storeU64(out + written, indexOffset);
+        CifContainer::storeU64(out + written + 8, chunks.size());
+        CifContainer::storeU64(out + written + 16, plaintextSize);
+        std::memcpy(out + written + 24, CifContainer::INDEX_MAGIC, sizeof(CifContainer::INDEX_MAGIC));
+        written += CifContainer::FOOTER_SIZE;
+        position = indexOffset + chunks.size() * CifContainer::INDEX_ENTRY_SIZE + CifContainer::FOOTER_SIZE;
+        return written;
+    }
+
+private:
+    C inner;
+    CifHeader header;
+    bool headerWritten = false;
+    std::vector<std::byte> pending;
+    size_t pendingFill = 0;
+    std::vector<CifChunk> chunks;
+    uint64_t plaintextSize = 0;
+    uint64_t position = 0; ///< Bytes del contenedor escritos hasta ahora.
+    std::string checkMaterial;
+    // La sal solo tiene que no repetirse, así que basta con sembrar una vez por codificador.
+    std::mt19937_64 saltGenerator{(static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}()};
+
+    size_t writeHeaderOnce(char* output) {
+        if (headerWritten) {
+            return 0;
+        }
+        if constexpr (requires { inner.initVector(); inner.mode(); }) {
+            header.desMode = inner.mode();
+            header.iv = inner.initVector();
+        }
+        headerWritten = true;
+        const size_t written = CifContainer::writeHeader(header, output);
+        position += written;
+        return written;
+    }
+
+    /**
+     * @brief Cifra un fragmento como registro. El último puede quedar vacío (y no se
+     * escribe) salvo que el codificador añada padding en finish().
+     */
+    size_t writeRecord(std::span<const std::byte> plain, char* output, bool finalChunk) {
+        const uint64_t state = inner.chunkState();
+        std::span<std::byte> data(reinterpret_cast<std::byte*>(output + CifContainer::RECORD_HEADER_SIZE), inner.outputBound(plain.size()));
+        size_t length = inner.transform(plain, data);
+        if (finalChunk) {
+            length += inner.finish(data.subspan(length));
+        }
+        plaintextSize += plain.size();
+        if (length == 0) {
+            return 0;
+        }
+        chunks.push_back(CifChunk{position, state});
+        CifContainer::storeU32(output, static_cast<uint32_t>(length));
+        position += CifContainer::RECORD_HEADER_SIZE + length;
+        return CifContainer::RECORD_HEADER_SIZE + length;
+    }
+};
@@ -0,0 +1,54 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+/**
+ * @brief Interfaz común de los codificadores por flujo (XOR, César, Vigenère y DES).
+ *
+ * - `restart()` empieza un flujo nuevo con la clave y la dirección de `beginStream()`,
+ *   sin volver a expandir la clave ni reservar memoria.
+ * - `transform(in, out)` procesa el siguiente fragmento y devuelve los bytes escritos;
+ *   `out` debe tener al menos `outputBound(in.size())` bytes y no solapar `in`.
+ * - `finish(out)` escribe los últimos bytes (como mucho `outputBound(0)`).
+ */
+template <typename C>
+concept Cipher = requires(C cipher, std::span<const std::byte> input, std::span<std::byte> output, size_t size) {
+    cipher.restart();
+    { cipher.outputBound(size) } -> std::same_as<size_t>;
+    { cipher.transform(input, output) } -> std::same_as<size_t>;
+    { cipher.finish(output) } -> std::same_as<size_t>;
+};
+
+/**
+ * @brief Codificadores que no cambian la longitud de los datos y pueden transformar
+ * un buffer en el sitio (XOR, César y Vigenère).
+ */
+template <typename C>
+concept InPlaceCipher = Cipher<C> && requires(C cipher, std::span<std::byte> data) {
+    cipher.transformInPlace(data);
+};
+
+/**
+ * @brief Codificadores que pueden empezar en cualquier fragmento de un contenedor .cif.
+ *
+ * - `chunkState()` resume en un entero el estado del flujo en la posición actual (que
+ *   debe ser múltiplo de 8 bytes), para guardarlo en el índice del contenedor.
+ * - `seekChunk(state, finalChunk)` continúa el flujo desde ese estado. Solo el último
+ *   fragmento del contenedor lleva el padding que quita finish().
+ */
+template <typename C>
+concept ChunkedCipher = Cipher<C> && requires(C cipher, const C& constCipher, uint64_t state, bool finalChunk) {
+    { constCipher.chunkState() } -> std::same_as<uint64_t>;
+    cipher.seekChunk(state, finalChunk);
+};
+
+/**
+ * @brief Vista de bytes de un texto, para pasar strings a la interfaz Cipher.
+ */
+inline std::span<const std::byte> asBytes(std::string_view text) {
+    return {reinterpret_cast<const std::byte*>(text.data()), text.size()};
+}
@@ -0,0 +1,76 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include <cstring>
+
+// Los núcleos SIMD usan atributos `target` de GCC/Clang para compilar cada variante
+// con su conjunto de instrucciones sin exigirlo al resto del programa.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CRIPTO_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define CRIPTO_X86_SIMD 0
+#endif
+
+/**
+ * @brief Niveles de instrucciones vectoriales, de menor a mayor.
+ */
+enum class SimdLevel {
+    Scalar = 0,
+    SSE2 = 1,
+    SSSE3 = 2,
+    AVX2 = 3,
+    AVX512 = 4
+};
+
+/**
+ * @class CpuFeatures
+ * @brief Detecta en tiempo de ejecución el mejor nivel SIMD que soporta el procesador.
+ *
+ * La variable de entorno `CRIPTO_SIMD` (scalar, sse2, ssse3, avx2, avx512) permite
+ * limitar el nivel, útil para comparar rendimiento o verificar los caminos alternativos.
+ */
+class CpuFeatures {
+public:
+    /**
+     * @brief Nivel SIMD a usar. Se calcula una vez y se reutiliza.
+     */
+    static SimdLevel level() {
+        static const SimdLevel detected = detect();
+        return detected;
+    }
+
+    /**
+     * @brief Nombre legible de un nivel SIMD.
+     */
+    static const char* name(SimdLevel simd) {
+        switch (simd) {
+            case SimdLevel::SSE2: return "SSE2";
+            case SimdLevel::SSSE3: return "SSSE3";
+            case SimdLevel::AVX2: return "AVX2";
+            case SimdLevel::AVX512: return "AVX-512";
+            default: return "escalar";
+        }
+    }
+
+private:
+    static SimdLevel detect() {
+        SimdLevel best = SimdLevel::Scalar;
+#if CRIPTO_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse2")) best = SimdLevel::SSE2;
+        if (__builtin_cpu_supports("ssse3")) best = SimdLevel::SSSE3;
+        if (__builtin_cpu_supports("avx2")) best = SimdLevel::AVX2;
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) best = SimdLevel::AVX512;
+#endif
+        const char* requested = std::getenv("CRIPTO_SIMD");
+        if (requested != nullptr) {
+            SimdLevel limit = best;
+            if (std::strcmp(requested, "scalar") == 0) limit = SimdLevel::Scalar;
+            else if (std::strcmp(requested, "sse2") == 0) limit = SimdLevel::SSE2;
+            else if (std::strcmp(requested, "ssse3") == 0) limit = SimdLevel::SSSE3;
+            else if (std::strcmp(requested, "avx2") == 0) limit = SimdLevel::AVX2;
+            if (limit < best) best = limit;
+        }
+        return best;
+    }
+};
@@ -0,0 +1,597 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "BatchExecutor.h"
+#include "CpuFeatures.h"
+#include "CesarEncoder.h"
+#include "VigenereEncoder.h"
+#include "XOREncoder.h"
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+/**
+ * @class Cryptanalysis
+ * @brief Recupera claves perdidas de archivos cifrados con César, Vigenère o XOR.
+ *
+ * Se asume que el texto original es texto en español o inglés:
+ *  - César: se prueban los 26 desplazamientos de letras y se elige el de menor
+ *    chi-cuadrado; el de dígitos (10 posibles, misma paridad) se elige con la ley de Benford.
+ *  - Vigenère: las longitudes de clave candidatas salen del índice de coincidencia y
+ *    del método de Kasiski, y cada columna se resuelve por chi-cuadrado.
+ *  - XOR: las candidatas salen de la distancia de Hamming normalizada entre bloques y
+ *    cada byte de la clave se elige maximizando la verosimilitud de texto de su columna.
+ *
+ * Entre las candidatas gana la de mayor verosimilitud penalizada por la longitud de la
+ * clave, y se evalúan en paralelo con un BatchExecutor. El texto se recorre una sola
+ * vez por longitud para sacar los histogramas de todas las columnas; a partir de ahí
+ * todo se puntúa sobre los histogramas (en XOR, 256 bytes de clave a la vez con AVX2).
+ */
+class Cryptanalysis {
+public:
+    /**
+     * @brief Resultado de un ataque: la clave encontrada y el texto descifrado.
+     */
+    struct Result {
+        std::string key;        ///< Clave (o clave equivalente) que descifra el texto.
+        std::string plaintext;  ///< Texto descifrado con esa clave.
+        double score = 0.0;     ///< Log-verosimilitud del texto descifrado (mayor es mejor).
+    };
+
+    explicit Cryptanalysis(unsigned int jobs = 0) : executor(jobs) {}
+
+    /**
+     * @brief Rompe un texto cifrado con CesarEncoder.
+     * @summary La clave original solo importa por la suma S de sus caracteres: las letras
+     * se desplazan S mod 26 y los dígitos S mod 10. La clave devuelta es una clave
+     * equivalente cuya suma es igual a S módulo 130, así que cifra exactamente igual.
+     */
+    Result crackCesar(const std::string& ciphertext) const {
+        std::array<uint64_t, 26> letterCounts = countLetters(ciphertext);
+
+        int letterShift = 0;
+        double bestChi = std::numeric_limits<double>::max();
+        for (int shift = 0; shift < 26; ++shift) {
+            double chi = chiSquaredShifted(letterCounts, shift);
+            if (chi < bestChi) {
+                bestChi = chi;
+                letterShift = shift;
+            }
+        }
+
+        // S mod 10 tiene la misma paridad que S mod 26: quedan 5 candidatos para los dígitos.
+        int digitShift = letterShift % 2;
+        double bestDigitScore = -std::numeric_limits<double>::max();
+        for (int candidate = letterShift % 2; candidate < 10; candidate += 2) {
+            double score = benfordScore(ciphertext, candidate);
+            if (score > bestDigitScore) {
+                bestDigitScore = score;
+                digitShift = candidate;
+            }
+        }
+
+        int sum = 0; // S mod 130 por el teorema chino del resto.
+        while (sum % 26 != letterShift || sum % 10 != digitShift) {
+            sum++;
+        }
+
+        Result result;
+        result.key = keyWithSum(sum);
+        // Descifrar = cifrar con la suma opuesta, así también los dígitos vuelven a su valor.
+        CesarEncoder cesar;
+        result.plaintext = cesar.encode(ciphertext, keyWithSum((130 - sum) % 130));
+        result.score = textScore(result.plaintext);
+        return result;
+    }
+
+    /**
+     * @brief Rompe un texto cifrado con VigenereEncoder.
+     * @param maxKeyLength Longitud máxima de clave que se prueba.
+     */
+    Result crackVigenere(const std::string& ciphertext, size_t maxKeyLength = 32) const {
+        // La clave solo avanza con las letras, así que se analizan solo las letras. Sin
+        // saltos: cada byte se escribe y solo avanza la posición si era una letra.
+        std::vector<uint8_t> letters(ciphertext.size());
+        size_t letterCount = 0;
+        for (char c : ciphertext) {
+            unsigned int x = static_cast<unsigned int>((c | 0x20) - 'a');
+            letters[letterCount] = static_cast<uint8_t>(x);
+            letterCount += (x < 26) ? 1 : 0;
+        }
+        letters.resize(letterCount);
+
+        Result result;
+        if (letters.empty()) {
+            result.plaintext = ciphertext;
+            return result;
+        }
+
+        maxKeyLength = std::max<size_t>(1, std::min(maxKeyLength, letters.size() / 2));
+        std::vector<double> coincidence(maxKeyLength + 1, 0.0);
+        executor.run(maxKeyLength, [&](size_t index, unsigned int) {
+            coincidence[index + 1] = averageCoincidence(letters, index + 1);
+        });
+
+        // Candidatas: las de mayor índice de coincidencia y la que más apoya Kasiski.
+        std::vector<size_t> candidates;
+        for (size_t length = 1; length <= maxKeyLength; ++length) {
+            candidates.push_back(length);
+        }
+        std::sort(candidates.begin(), candidates.end(), [&](size_t a, size_t b) {
+            return coincidence[a] > coincidence[b] || (coincidence[a] == coincidence[b] && a < b);
+        });
+        candidates.resize(std::min<size_t>(candidates.size(), LENGTH_CANDIDATES));
+        size_t kasiski = kasiskiLength(letters, maxKeyLength);
+        if (std::find(candidates.begin(), candidates.end(), kasiski) == candidates.end()) {
+            candidates.push_back(kasiski);
+        }
+
+        std::vector<std::string> keys(candidates.size());
+        std::vector<double> scores(candidates.size());
+        executor.run(candidates.size(), [&](size_t index, unsigned int) {
+            const std::vector<std::array<uint64_t, 26>> counts = columnCounts<26>(letters.data(), letters.size(), candidates[index]);
+            keys[index] = solveVigenereLength(counts);
+            scores[index] = vigenereLikelihood(counts, keys[index]) - static_cast<double>(keys[index].size()) * std::log(26.0);
+        });
+
+        size_t best = 0;
+        for (size_t index = 1; index < candidates.size(); ++index) {
+            if (scores[index] > scores[best] || (scores[index] == scores[best] && keys[index].size() < keys[best].size())) {
+                best = index;
+            }
+        }
+
+        VigenereEncoder vigenere;
+        result.key = shortestPeriod(keys[best]);
+        result.plaintext = vigenere.decode(ciphertext, result.key);
+        result.score = textScore(result.plaintext);
+        return result;
+    }
+
+    /**
+     * @brief Rompe un texto cifrado con XOREncoder (clave repetida).
+     * @param maxKeyLength Longitud máxima de clave que se prueba.
+     */
+    Result crackXOR(const std::string& ciphertext, size_t maxKeyLength = 40) const {
+        Result best;
+        best.plaintext = ciphertext;
+        if (ciphertext.empty()) {
+            return best;
+        }
+
+        maxKeyLength = std::max<size_t>(1, std::min(maxKeyLength, ciphertext.size() / 2));
+        std::vector<double> distances(maxKeyLength + 1, std::numeric_limits<double>::max());
+        executor.run(maxKeyLength, [&](size_t index, unsigned int) {
+            distances[index + 1] = normalizedHamming(ciphertext, index + 1);
+        });
+
+        // Se resuelven las longitudes con menor distancia de Hamming.
+        std::vector<size_t> candidates;
+        for (size_t length = 1; length <= maxKeyLength; ++length) {
+            candidates.push_back(length);
+        }
+        std::sort(candidates.begin(), candidates.end(), [&](size_t a, size_t b) {
+            return distances[a] < distances[b] || (distances[a] == distances[b] && a < b);
+        });
+        candidates.resize(std::min<size_t>(candidates.size(), LENGTH_CANDIDATES));
+
+        std::vector<std::string> keys(candidates.size());
+        std::vector<double> scores(candidates.size());
+        executor.run(candidates.size(), [&](size_t index, unsigned int) {
+            keys[index] = solveXORLength(ciphertext, candidates[index], scores[index]);
+            scores[index] -= static_cast<double>(candidates[index]) * std::log(256.0);
+        });
+
+        size_t chosen = 0;
+        for (size_t index = 1; index < candidates.size(); ++index) {
+            if (scores[index] > scores[chosen] || (scores[index] == scores[chosen] && keys[index].size() < keys[chosen].size())) {
+                chosen = index;
+            }
+        }
+
+        XOREncoder xorEncoder;
+        best.key = shortestPeriod(keys[chosen]);
+        best.plaintext = xorEncoder.encode(ciphertext, best.key);
+        best.score = textScore(best.plaintext);
+        return best;
+    }
+
+    /**
+     * @brief Clave de César que, al cifrar, deshace exactamente lo que cifra `key`
+     * (letras y dígitos). CesarEncoder::decode conserva su tratamiento histórico de los dígitos.
+     */
+    static std::string cesarInverseKey(const std::string& key) {
+        int sum = 0;
+        for (char c : key) {
+            sum += static_cast<int>(c);
+        }
+        int residue = ((sum % 130) + 130) % 130;
+        return keyWithSum((130 - residue) % 130);
+    }
+
+    /**
+     * @brief Log-verosimilitud de unos bytes bajo un modelo de texto (mayor es mejor).
+     */
+    static double textScore(std::string_view text) {
+        const std::array<double, 256>& logProbabilities = byteLogProbabilities();
+        double score = 0.0;
+        for (char c : text) {
+            score += logProbabilities[static_cast<unsigned char>(c)];
+        }
+        return score;
+    }
+
+private:
+    BatchExecutor executor;
+
+    // Longitudes de clave que se resuelven por completo en Vigenère y XOR.
+    static constexpr size_t LENGTH_CANDIDATES = 8;
+
+    // Frecuencias de letras (en %) del inglés y del español.
+    static constexpr double ENGLISH_FREQUENCIES[26] = {
+        8.167, 1.492, 2.782, 4.253, 12.702, 2.228, 2.015, 6.094, 6.966, 0.153, 0.772, 4.025, 2.406,
+        6.749, 7.507, 1.929, 0.095, 5.987, 6.327, 9.056, 2.758, 0.978, 2.360, 0.150, 1.974, 0.074
+    };
+    static constexpr double SPANISH_FREQUENCIES[26] = {
+        12.53, 1.42, 4.68, 5.86, 13.68, 0.69, 1.01, 0.70, 6.25, 0.44, 0.02, 4.97, 3.15,
+        6.71, 8.68, 2.51, 0.88, 6.87, 7.98, 4.63, 3.93, 0.90, 0.01, 0.22, 0.90, 0.52
+    };
+
+    static std::array<uint64_t, 26> countLetters(std::string_view text) {
+        std::array<uint64_t, 26> counts{};
+        for (char c : text) {
+            int x = (c | 0x20) - 'a';
+            if (x >= 0 && x < 26) {
+                counts[x]++;
+            }
+        }
+        return counts;
+    }
+
+    /**
+     * @brief Chi-cuadrado de las letras desplazadas `shift` posiciones hacia atrás,
+     * contra el idioma (español o inglés) que mejor encaje.
+     */
+    static double chiSquaredShifted(const std::array<uint64_t, 26>& counts, int shift) {
+        uint64_t total = 0;
+        for (uint64_t count : counts) {
+            total += count;
+        }
+        if (total == 0) {
+            return 0.0;
+        }
+        double chiEnglish = 0.0;
+        double chiSpanish = 0.0;
+        for (int letter = 0; letter < 26; ++letter) {
+            double observed = static_cast<double>(counts[(letter + shift) % 26]);
+            double expectedEnglish = ENGLISH_FREQUENCIES[letter] / 100.0 * total;
+            double expectedSpanish = SPANISH_FREQUENCIES[letter] / 100.0 * total;
+            chiEnglish += (observed - expectedEnglish) * (observed - expectedEnglish) / expectedEnglish;
+            chiSpanish += (observed - expectedSpanish) * (observed - expectedSpanish) / expectedSpanish;
+        }
+        return std::min(chiEnglish, chiSpanish);
+    }
+
+    /**
+     * @brief Log-verosimilitud de los primeros dígitos de cada número según Benford,
+     * tras deshacer un desplazamiento de dígitos.
+     */
+    static double benfordScore(std::string_view text, int digitShift) {
+        double score = 0.0;
+        bool previousIsDigit = false;
+        for (char c : text) {
+            bool isDigit = (c >= '0' && c <= '9');
+            if (isDigit && !previousIsDigit) {
+                int digit = ((c - '0') - digitShift + 10) % 10;
+                score += (digit == 0) ? std::log(0.02) : std::log(std::log10(1.0 + 1.0 / digit));
+            }
+            previousIsDigit = isDigit;
+        }
+        return score;
+    }
+
+    /**
+     * @brief Una clave imprimible cuya suma de caracteres es `sum` (módulo 130).
+     */
+    static std::string keyWithSum(int sum) {
+        int target = (sum < 33) ? sum + 130 : sum;
+        if (target <= 126) {
+            return std::string(1, static_cast<char>(target));
+        }
+        int first = std::min(126, target - 33);
+        return std::string{static_cast<char>(first), static_cast<char>(target - first)};
+    }
+
+    /**
+     * @brief Reduce una clave repetida a su periodo mínimo ("abab" -> "ab"); cifra igual.
+     */
+    static std::string shortestPeriod(const std::string& key) {
+        for (size_t period = 1; period < key.size(); ++period) {
+            if (key.size() % period != 0) {
+                continue;
+            }
+            bool periodic = true;
+            for (size_t i = period; i < key.size() && periodic; ++i) {
+                periodic = (key[i] == key[i - period]);
+            }
+            if (periodic) {
+                return key.substr(0, period);
+            }
+        }
+        return key;
+    }
+
+    /**
+     * @brief Índice de coincidencia medio de las columnas para una longitud de clave.
+     */
+    static double averageCoincidence(const std::vector<uint8_t>& letters, size_t keyLength) {
+        double total = 0.0;
+        for (const std::array<uint64_t, 26>& counts : columnCounts<26>(letters.data(), letters.size(), keyLength)) {
+            uint64_t n = 0;
+            uint64_t pairs = 0;
+            for (uint64_t count : counts) {
+                n += count;
+                pairs += count * (count - 1);
+            }
+            if (n < 2) {
+                continue;
+            }
+            total += static_cast<double>(pairs) / static_cast<double>(n * (n - 1));
+        }
+        return total / static_cast<double>(keyLength);
+    }
+
+    /**
+     * @brief Histogramas de las `keyLength` columnas en una sola pasada secuencial: la
+     * columna avanza con un contador, en lugar de recorrer el texto una vez por columna
+     * con saltos de `keyLength` bytes (que tocan todas las líneas de caché cada vez).
+     */
+    template <size_t Symbols>
+    static std::vector<std::array<uint64_t, Symbols>> columnCounts(const uint8_t* data, size_t size, size_t keyLength) {
+        std::vector<std::array<uint64_t, Symbols>> counts(keyLength, std::array<uint64_t, Symbols>{});
+        size_t column = 0;
+        for (size_t i = 0; i < size; ++i) {
+            counts[column][data[i]]++;
+            if (++column == keyLength) {
+                column = 0;
+            }
+        }
+        return counts;
+    }
+
+    /**
+     * @brief Método de Kasiski: la longitud que más distancias entre trigramas repetidos
+     * divide, corregida por lo que dividiría al azar (1 de cada `length`).
+     */
+    static size_t kasiskiLength(const std::vector<uint8_t>& letters, size_t maxKeyLength) {
+        // Primero se cuenta cada distancia y después, por longitud, sus múltiplos: así no
+        // hay una división por longitud candidata en cada trigrama repetido.
+        std::vector<int64_t> lastSeen(26 * 26 * 26, -1);
+        size_t limit = std::min<size_t>(letters.size(), 1 << 20);
+        std::vector<uint32_t> distances(limit, 0);
+        for (size_t i = 0; i + 2 < limit; ++i) {
+            size_t trigram = (letters[i] * 26 + letters[i + 1]) * 26 + letters[i + 2];
+            if (lastSeen[trigram] >= 0) {
+                distances[i - static_cast<size_t>(lastSeen[trigram])]++;
+            }
+            lastSeen[trigram] = static_cast<int64_t>(i);
+        }
+        std::vector<uint64_t> support(maxKeyLength + 1, 0);
+        for (size_t length = 1; length <= maxKeyLength; ++length) {
+            for (size_t distance = length; distance < limit; distance += length) {
+                support[length] += distances[distance];
+            }
+        }
+
+        // Los múltiplos de la longitud real empatan en esta medida; se queda la menor.
+        size_t chosen = 1;
+        for (size_t length = 2; length <= maxKeyLength; ++length) {
+            if (support[length] * length > support[chosen] * chosen) {
+                chosen = length;
+            }
+        }
+        return chosen;
+    }
+
+    /**
+     * @brief Resuelve cada columna de Vigenère por chi-cuadrado a partir de sus histogramas.
+     */
+    static std::string solveVigenereLength(const std::vector<std::array<uint64_t, 26>>& columns) {
+        std::string key(columns.size(), 'A');
+        for (size_t column = 0; column < columns.size(); ++column) {
+            int bestShift = 0;
+            double bestChi = std::numeric_limits<double>::max();
+            for (int shift = 0; shift < 26; ++shift) {
+                double chi = chiSquaredShifted(columns[column], shift);
+                if (chi < bestChi) {
+                    bestChi = chi;
+                    bestShift = shift;
+                }
+            }
+            key[column] = static_cast<char>('A' + bestShift);
+        }
+        return key;
+    }
+
+    /**
+     * @brief Log-verosimilitud de las letras descifradas con `key` en el idioma que mejor encaje.
+     * @summary Al restarle log(26) por letra de clave (longitud de descripción), una clave
+     * más larga solo gana si explica mejor el texto y no solo por tener más columnas libres.
+     * Las letras descifradas se cuentan desplazando los histogramas de las columnas, sin
+     * volver a recorrer el texto.
+     */
+    static double vigenereLikelihood(const std::vector<std::array<uint64_t, 26>>& columns, const std::string& key) {
+        std::array<uint64_t, 26> counts{};
+        for (size_t column = 0; column < columns.size(); ++column) {
+            const int shift = key[column] - 'A';
+            for (int letter = 0; letter < 26; ++letter) {
+                counts[(letter + 26 - shift) % 26] += columns[column][letter];
+            }
+        }
+        double english = 0.0;
+        double spanish = 0.0;
+        for (int letter = 0; letter < 26; ++letter) {
+            english += static_cast<double>(counts[letter]) * std::log(ENGLISH_FREQUENCIES[letter] / 100.0);
+            spanish += static_cast<double>(counts[letter]) * std::log(SPANISH_FREQUENCIES[letter] / 100.0);
+        }
+        return std::max(english, spanish);
+    }
+
+    /**
+     * @brief Distancia de Hamming media por bit entre bloques consecutivos de `keyLength` bytes.
+     * Se comparan palabras de 8 bytes con popcount.
+     */
+    static double normalizedHamming(const std::string& data, size_t keyLength) {
+        size_t blocks = std::min<size_t>(data.size() / keyLength, 4096);
+        if (blocks < 2) {
+            return std::numeric_limits<double>::max();
+        }
+        uint64_t bits = 0;
+        uint64_t compared = 0;
+        for (size_t b = 0; b + 1 < blocks; ++b) {
+            const char* first = data.data() + b * keyLength;
+            const char* second = first + keyLength;
+            size_t i = 0;
+            for (; i + 8 <= keyLength; i += 8) {
+                uint64_t x;
+                uint64_t y;
+                std::memcpy(&x, first + i, 8);
+                std::memcpy(&y, second + i, 8);
+                bits += static_cast<uint64_t>(std::popcount(x ^ y));
+            }
+            for (; i < keyLength; ++i) {
+                bits += static_cast<uint64_t>(std::popcount(static_cast<unsigned int>(static_cast<unsigned char>(first[i] ^ second[i]))));
+            }
+            compared += keyLength;
+        }
+        return static_cast<double>(bits) / static_cast<double>(compared * 8);
+    }
+
+    /**
+     * @brief Recupera una clave XOR de longitud fija, byte a byte.
+     * @summary Cada columna se resume en un histograma de 256 entradas; probar un byte de
+     * clave es entonces recorrer el histograma y no el texto.
+     * @param score Recibe la log-verosimilitud del texto descifrado con la clave.
+     */
+    static std::string solveXORLength(const std::string& ciphertext, size_t keyLength, double& score) {
+        const std::array<double, 256>& logProbabilities = byteLogProbabilities();
+        const std::vector<std::array<uint64_t, 256>> columns =
+            columnCounts<256>(reinterpret_cast<const uint8_t*>(ciphertext.data()), ciphertext.size(), keyLength);
+        std::string key(keyLength, '\0');
+        score = 0.0;
+        alignas(32) double candidateScores[256];
+        for (size_t column = 0; column < keyLength; ++column) {
+            scoreKeyBytes(columns[column], logProbabilities.data(), candidateScores);
+            double bestScore = -std::numeric_limits<double>::max();
+            for (int candidate = 0; candidate < 256; ++candidate) {
+                if (candidateScores[candidate] > bestScore) {
+                    bestScore = candidateScores[candidate];
+                    key[column] = static_cast<char>(candidate);
+                }
+            }
+            score += bestScore;
+        }
+        return key;
+    }
+
+    /**
+     * @brief Puntúa los 256 bytes de clave posibles de una columna:
+     * `scores[k]` = suma de `histogram[b] * logProbabilities[b ^ k]`.
+     * Se suma en el mismo orden (b creciente) en todos los caminos, así que el resultado
+     * es idéntico con y sin AVX2.
+     */
+    static void scoreKeyBytes(const std::array<uint64_t, 256>& histogram, const double* logProbabilities, double* scores) {
+#if CRIPTO_X86_SIMD
+        if (CpuFeatures::level() >= SimdLevel::AVX2) {
+            scoreKeyBytesAVX2(histogram, logProbabilities, scores);
+            return;
+        }
+#endif
+        std::fill(scores, scores + 256, 0.0);
+        for (int byte = 0; byte < 256; ++byte) {
+            if (histogram[byte] == 0) {
+                continue;
+            }
+            const double weight = static_cast<double>(histogram[byte]);
+            for (int candidate = 0; candidate < 256; ++candidate) {
+                scores[candidate] += logProbabilities[byte ^ candidate] * weight;
+            }
+        }
+    }
+
+#if CRIPTO_X86_SIMD
+    /**
+     * @brief scoreKeyBytes() con 4 candidatos por registro. Para k = 4a + j, b ^ k es
+     * 4(a ^ b/4) + (j ^ b%4): se carga el bloque (a ^ b/4) de la tabla y se reordena
+     * según b%4 (intercambiar parejas, mitades o ambas).
+     */
+    __attribute__((target("avx2")))
+    static void scoreKeyBytesAVX2(const std::array<uint64_t, 256>& histogram, const double* logProbabilities, double* scores) {
+        for (int block = 0; block < 64; ++block) {
+            _mm256_store_pd(scores + block * 4, _mm256_setzero_pd());
+        }
+        for (int byte = 0; byte < 256; ++byte) {
+            if (histogram[byte] == 0) {
+                continue;
+            }
+            const __m256d weight = _mm256_set1_pd(static_cast<double>(histogram[byte]));
+            const int high = byte >> 2;
+            const int low = byte & 3;
+            for (int block = 0; block < 64; ++block) {
+                __m256d values = _mm256_loadu_pd(logProbabilities + ((block ^ high) << 2));
+                if (low & 1) {
+                    values = _mm256_permute_pd(values, 0x5);
+                }
+                if (low & 2) {
+                    values = _mm256_permute2f128_pd(values, values, 0x01);
+                }
+                const __m256d sum = _mm256_load_pd(scores + block * 4);
+                _mm256_store_pd(scores + block * 4, _mm256_add_pd(sum, _mm256_mul_pd(values, weight)));
+            }
+        }
+    }
+#endif
+
+    /**
+     * @brief Log-probabilidad de cada byte en un texto: letras según su frecuencia,
+     * espacios y signos habituales probables, y bytes de control casi imposibles.
+     */
+    static const std::array<double, 256>& byteLogProbabilities() {
+        static const std::array<double, 256> logProbabilities = [] {
+            std::array<double, 256> weight{};
+            for (int byte = 0; byte < 256; ++byte) {
+                if (byte == ' ') {
+                    weight[byte] = 16.0;
+                } else if (byte >= 'a' && byte <= 'z') {
+                    weight[byte] = (ENGLISH_FREQUENCIES[byte - 'a'] + SPANISH_FREQUENCIES[byte - 'a']) / 2.0;
+                } else if (byte >= 'A' && byte <= 'Z') {
+                    weight[byte] = (ENGLISH_FREQUENCIES[byte - 'A'] + SPANISH_FREQUENCIES[byte - 'A']) / 16.0;
+                } else if (byte >= '0' && byte <= '9') {
+                    weight[byte] = 0.3;
+                } else if (byte == '\n' || byte == '.' || byte == ',') {
+                    weight[byte] = 1.0;
+                } else if (byte >= 32 && byte < 127) {
+                    weight[byte] = 0.1;
+                } else if (byte == '\r' || byte == '\t') {
+                    weight[byte] = 0.1;
+                } else if (byte >= 0x80) {
+                    weight[byte] = 0.01; // Acentos en UTF-8: posibles pero raros.
+                } else {
+                    weight[byte] = 0.0001;
+                }
+            }
+            double total = 0.0;
+            for (double w : weight) {
+                total += w;
+            }
+            std::array<double, 256> result{};
+            for (int byte = 0; byte < 256; ++byte) {
+                result[byte] = std::log(weight[byte] / total);
+            }
+            return result;
+        }();
+        return logProbabilities;
+    }
+};
@@ -1,7 +1,33 @@
 ﻿#pragma once
 #include "Prerequisites.h"
-#include <bitset>
-#include <vector>
+#include "DESKey.h"
+#include "DESTables.h"
+#include "BitslicedDES.h"
+#include "BatchExecutor.h"
+#include "Cipher.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string_view>
+
+/**
+ * @brief Modos de operación de DES.
+ */
+enum class DESMode : uint8_t {
+    ECB = 0, ///< Bloques independientes; es el formato original, sin cabecera.
+    CBC = 1, ///< Encadenamiento de bloques con IV; descifrado en paralelo.
+    CTR = 2  ///< Modo contador: sin padding, paralelo y con acceso aleatorio.
+};
+
+/**
+ * @brief Núcleo con el que se procesan los bloques en ECB y CTR.
+ */
+enum class DESBackend {
+    Auto,      ///< Bitsliced si el procesador tiene AVX2 o AVX-512; si no, tablas.
+    Table,     ///< Núcleo por tablas SP, bloque a bloque.
+    Bitsliced  ///< Núcleo bitsliced, 64/256/512 bloques a la vez.
+};
 
 /**
  * @class DESEncoder
@@ -9,6 +35,9 @@
  *
  * Maneja el cifrado y descifrado de datos de longitud variable mediante el
  * procesamiento en bloques de 64 bits y la aplicación de relleno PKCS#7.
+ * El núcleo por bloque trabaja sobre mitades de 32 bits (`uint32_t`) y usa
+ * tablas combinadas S-box + permutación P ("SP boxes") calculadas en compilación.
+ * Las subclaves viven en un `DESKey`, que puede expandirse una vez y reutilizarse.
  */
 class DESEncoder {
 public:
@@ -26,16 +55,21 @@ public:
      * @return El texto codificado en formato binario (string).
      */
     std::string encode(const std::string& text, const std::string& key) {
+        return encode(text, DESKey(key));
+    }
+
+    /**
+     * @brief Codifica un texto con un contexto de clave ya expandido.
+     * @param text El texto a codificar.
+     * @param key El contexto de clave DES.
+     * @return El texto codificado en formato binario (string).
+     */
+    std::string encode(const std::string& text, const DESKey& key) const {
         std::string padded_text = apply_pkcs7_padding(text);
-        std::bitset<64> des_key = stringToBitset64(normalizeKey(key));
-        generateSubkeys(des_key);
 
-        std::string result = "";
+        std::string result(padded_text.length(), '\0');
         for (size_t i = 0; i < padded_text.length(); i += 8) {
-            std::string block_str = padded_text.substr(i, 8);
-            std::bitset<64> block_bits = stringToBitset64(block_str);
-            std::bitset<64> encrypted_block = encode_block(block_bits);
-            result += bitset64ToString(encrypted_block);
+            storeBlock(&result[i], encode_block(loadBlock(&padded_text[i]), key));
         }
         return result;
     }
@@ -49,26 +83,506 @@ public:
      * @return El texto original decodificado.
      */
     std::string decode(const std::string& text, const std::string& key) {
-        std::bitset<64> des_key = stringToBitset64(normalizeKey(key));
-        generateSubkeys(des_key);
+        return decode(text, DESKey(key));
+    }
 
-        std::string decrypted_padded_text = "";
-        for (size_t i = 0; i < text.length(); i += 8) {
-            std::string block_str = text.substr(i, 8);
-            std::bitset<64> block_bits = stringToBitset64(block_str);
-            std::bitset<64> decrypted_block = decode_block(block_bits);
-            decrypted_padded_text += bitset64ToString(decrypted_block);
+    /**
+     * @brief Decodifica un texto cifrado con un contexto de clave ya expandido.
+     * @param text El texto cifrado.
+     * @param key El contexto de clave DES usado para codificar.
+     * @return El texto original decodificado.
+     */
+    std::string decode(const std::string& text, const DESKey& key) const {
+        // Un bloque final incompleto se completa con ceros, igual que antes.
+        size_t full_length = (text.length() + 7) / 8 * 8;
+        std::string input = text;
+        input.resize(full_length, '\0');
+
+        std::string decrypted_padded_text(full_length, '\0');
+        for (size_t i = 0; i < full_length; i += 8) {
+            storeBlock(&decrypted_padded_text[i], decode_block(loadBlock(&input[i]), key));
         }
 
         return remove_pkcs7_padding(decrypted_padded_text);
     }
 
+    // --- PROCESAMIENTO POR BLOQUES (STREAMING) ---
+
+    /**
+     * @brief Fija cuántos hilos se usan para repartir los bloques de un fragmento grande
+     * (ECB, descifrado CBC y CTR). Por defecto se usa un solo hilo.
+     */
+    void setThreads(unsigned int threads) {
+        blockThreads = std::max(1u, threads);
+    }
+
+    /**
+     * @brief Elige el núcleo para los bloques ECB y el keystream CTR. El resultado es
+     * idéntico con cualquiera de ellos; solo cambia el rendimiento.
+     */
+    void setBackend(DESBackend backend) {
+        blockBackend = backend;
+    }
+
+    /**
+     * @brief Prepara el codificador para procesar un flujo de datos por fragmentos.
+     * @summary Al codificar en CBC o CTR el flujo empieza con una cabecera de 13 bytes
+     * ("DESM", el modo y el IV). Al decodificar el modo se detecta con esa cabecera; si
+     * no está, el flujo se trata como ECB, el formato original sin cabecera.
+     * @param key El contexto de clave DES.
+     * @param encrypting Verdadero para codificar, falso para decodificar.
+     * @param mode Modo de operación al codificar; se ignora al decodificar.
+     */
+    void beginStream(const DESKey& key, bool encrypting, DESMode mode = DESMode::ECB) {
+        streamKey = key;
+        streamEncrypting = encrypting;
+        requestedMode = mode;
+        inBandHeader = true;
+        restart();
+    }
+
+    /**
+     * @brief Prepara un flujo sin cabecera "DESM": el modo y el IV los guarda quien lo
+     * usa (la cabecera de un contenedor .cif).
+     * @param initVector IV al decodificar. Al codificar se genera uno nuevo en cada
+     * flujo; se consulta con initVector().
+     */
+    void beginRawStream(const DESKey& key, bool encrypting, DESMode mode, uint64_t initVector = 0) {
+        streamKey = key;
+        streamEncrypting = encrypting;
+        requestedMode = mode;
+        inBandHeader = false;
+        rawIV = initVector;
+        restart();
+    }
+
+    /**
+     * @brief Empieza un flujo nuevo con la misma clave, dirección y modo que beginStream().
+     * Al codificar en CBC o CTR se genera un IV nuevo.
+     */
+    void restart() {
+        streamMode = (streamEncrypting || !inBandHeader) ? requestedMode : DESMode::ECB;
+        headerDone = !inBandHeader;
+        headerFill = 0;
+        pendingSize = 0;
+        if (streamEncrypting) {
+            iv = (requestedMode != DESMode::ECB) ? randomIV() : 0;
+        } else {
+            iv = inBandHeader ? 0 : rawIV;
+        }
+        chain = iv;
+        counter = 0;
+        keystreamOffset = 0;
+        retainLastBlock = true;
+    }
+
+    /**
+     * @brief Los 8 bytes de la clave normalizada, para el valor de comprobación de un
+     * contenedor (las contraseñas con los mismos 8 primeros bytes coinciden).
+     */
+    static std::string keyCheckMaterial(const DESKey& key) {
+        std::string material(8, '\0');
+        storeBlock(material.data(), key.keyBits());
+        return material;
+    }
+
+    /**
+     * @brief IV del flujo actual (0 en ECB).
+     */
+    uint64_t initVector() const {
+        return iv;
+    }
+
+    /**
+     * @brief Estado para el índice de un contenedor: el último bloque cifrado en CBC, el
+     * contador en CTR y 0 en ECB. Solo es válido en un límite de bloque.
+     */
+    uint64_t chunkState() const {
+        return streamMode == DESMode::CBC ? chain : streamMode == DESMode::CTR ? counter : 0;
+    }
+
+    /**
+     * @brief Continúa un flujo sin cabecera desde un estado guardado con chunkState().
+     * @param finalChunk Falso si el fragmento no es el último: al decodificar no se
+     * retiene su último bloque, porque no lleva padding.
+     */
+    void seekChunk(uint64_t state, bool finalChunk) {
+        headerDone = true;
+        pendingSize = 0;
+        keystreamOffset = 0;
+        chain = (streamMode == DESMode::CBC) ? state : iv;
+        counter = (streamMode == DESMode::CTR) ? state : 0;
+        retainLastBlock = finalChunk;
+    }
+
+    /**
+     * @brief Tamaño máximo de la salida de transform() para `inputSize` bytes de entrada:
+     * la cabecera de modo y un bloque retenido de fragmentos anteriores.
+     */
+    size_t outputBound(size_t inputSize) const {
+        return inputSize + MODE_HEADER_SIZE + 8;
+    }
+
+    /**
+     * @brief Procesa el siguiente fragmento del flujo.
+     * @summary Los bytes que no completan un bloque se guardan para el siguiente
+     * fragmento. Al decodificar se retiene además el último bloque completo, porque
+     * solo en finish() se sabe si contiene el padding PKCS#7. CTR no usa padding.
+     * @param input El fragmento de entrada.
+     * @param output Destino, de al menos `outputBound(input.size())` bytes; no debe solapar `input`.
+     * @return Bytes escritos en `output`.
+     */
+    size_t transform(std::span<const std::byte> input, std::span<std::byte> output) {
+        const char* in = reinterpret_cast<const char*>(input.data());
+        size_t size = input.size();
+        char* out = reinterpret_cast<char*>(output.data());
+        size_t written = 0;
+        if (!headerDone) {
+            if (streamEncrypting) {
+                written = writeHeader(out);
+            } else {
+                size_t take = std::min(size, MODE_HEADER_SIZE - headerFill);
+                std::memcpy(headerBytes + headerFill, in, take);
+                headerFill += take;
+                in += take;
+                size -= take;
+                if (headerFill < MODE_HEADER_SIZE) {
+                    return 0;
+                }
+                written = flushHeader(out);
+            }
+        }
+        return written + processData(in, size, out + written);
+    }
+
+    /**
+     * @brief Termina el flujo: al codificar añade el bloque con padding PKCS#7 y al
+     * decodificar procesa el último bloque retenido y le quita el padding.
+     * @param output Destino, de al menos `outputBound(0)` bytes.
+     * @return Bytes escritos en `output`.
+     */
+    size_t finish(std::span<std::byte> output) {
+        char* out = reinterpret_cast<char*>(output.data());
+        size_t written = 0;
+        if (!headerDone) {
+            // Al decodificar, un flujo más corto que la cabecera solo puede ser ECB.
+            written = streamEncrypting ? writeHeader(out) : flushHeader(out);
+        }
+
+        if (streamMode != DESMode::CTR) {
+            if (streamEncrypting) {
+                char padding = static_cast<char>(8 - pendingSize);
+                std::memset(pendingBlock + pendingSize, padding, 8 - pendingSize);
+                transformBlocks(pendingBlock, out + written, 1);
+                written += 8;
+            } else if (pendingSize > 0) {
+                // Un bloque final incompleto se completa con ceros, igual que en decode().
+                char block[8];
+                std::memset(pendingBlock + pendingSize, 0, 8 - pendingSize);
+                transformBlocks(pendingBlock, block, 1);
+                size_t padding_len = static_cast<size_t>(block[7]);
+                size_t kept = padding_len <= 8 ? 8 - padding_len : 8;
+                std::memcpy(out + written, block, kept);
+                written += kept;
+            }
+        }
+        pendingSize = 0;
+        return written;
+    }
+
+    /**
+     * @brief Como transform(), pero sobre strings (reemplaza el contenido de `output`).
+     */
+    void update(std::string_view input, std::string& output) {
+        output.resize(outputBound(input.size()));
+        output.resize(transform(asBytes(input), std::as_writable_bytes(std::span(output))));
+    }
+
+    /**
+     * @brief Como finish(), pero sobre strings (reemplaza el contenido de `output`).
+     */
+    void finish(std::string& output) {
+        output.resize(outputBound(0));
+        output.resize(finish(std::as_writable_bytes(std::span(output))));
+    }
+
+    /**
+     * @brief Modo del flujo actual (al decodificar, el detectado en la cabecera).
+     */
+    DESMode mode() const {
+        return streamMode;
+    }
+
+    /**
+     * @brief Lee la cabecera de modo de un texto cifrado, si la tiene.
+     * @param data Los primeros bytes del texto cifrado.
+     * @param mode Recibe el modo (ECB si no hay cabecera).
+     * @param initVector Recibe el IV (0 si no hay cabecera).
+     * @return El tamaño de la cabecera (0 si el texto es ECB sin cabecera).
+     */
+    static size_t parseModeHeader(std::string_view data, DESMode& mode, uint64_t& initVector) {
+        mode = DESMode::ECB;
+        initVector = 0;
+        if (data.size() < MODE_HEADER_SIZE || data.substr(0, 4) != std::string_view(MODE_MAGIC, 4)) {
+            return 0;
+        }
+        uint8_t modeByte = static_cast<uint8_t>(data[4]);
+        if (modeByte != static_cast<uint8_t>(DESMode::CBC) && modeByte != static_cast<uint8_t>(DESMode::CTR)) {
+            return 0;
+        }
+        mode = static_cast<DESMode>(modeByte);
+        initVector = loadBlock(data.data() + 5);
+        return MODE_HEADER_SIZE;
+    }
+
+    /**
+     * @brief Cifra o descifra un único bloque de 64 bits (big-endian) con el núcleo por tablas.
+     */
+    static uint64_t cryptBlock(uint64_t block, const DESKey& key, bool encrypting) {
+        return encrypting ? encode_block(block, key) : decode_block(block, key);
+    }
+
+    /**
+     * @brief Cifra o descifra en modo CTR empezando en cualquier bloque (acceso aleatorio).
+     * @summary El bloque `n` del flujo se combina con E(IV + n), así que cualquier rango
+     * puede procesarse sin tocar los anteriores, y los bloques se reparten entre hilos.
+     * @param key El contexto de clave DES.
+     * @param initVector El IV guardado en la cabecera.
+     * @param firstBlock Índice (desde 0) del bloque en el que empieza `input`.
+     * @param input Datos a procesar, alineados al inicio de un bloque.
+     * @param output Destino; puede ser igual a `input`.
+     * @param size Número de bytes; el último bloque puede estar incompleto.
+     */
+    void ctrTransform(const DESKey& key, uint64_t initVector, uint64_t firstBlock, const char* input, char* output, size_t size) const {
+        size_t fullBlocks = size / 8;
+        parallelBlocks(fullBlocks, [&](size_t begin, size_t end) {
+            size_t j = begin;
+            if (useBitsliced()) {
+                const size_t lanes = BitslicedDESEngine::lanes();
+                uint64_t counters[BitslicedDESEngine::MAX_LANES];
+                uint64_t keystream[BitslicedDESEngine::MAX_LANES];
+                for (; j + lanes <= end; j += lanes) {
+                    for (size_t lane = 0; lane < lanes; ++lane) {
+                        counters[lane] = initVector + firstBlock + j + lane;
+                    }
+                    BitslicedDESEngine::cryptGroup(key, true, counters, keystream);
+                    for (size_t lane = 0; lane < lanes; ++lane) {
+                        char* out = output + (j + lane) * 8;
+                        storeBlock(out, loadBlock(input + (j + lane) * 8) ^ keystream[lane]);
+                    }
+                }
+            }
+            for (; j < end; ++j) {
+                uint64_t keystream = encode_block(initVector + firstBlock + j, key);
+                storeBlock(output + j * 8, loadBlock(input + j * 8) ^ keystream);
+            }
+        });
+        size_t tail = size % 8;
+        if (tail > 0) {
+            char keystream[8];
+            storeBlock(keystream, encode_block(initVector + firstBlock + fullBlocks, key));
+            for (size_t i = 0; i < tail; ++i) {
+                output[fullBlocks * 8 + i] = static_cast<char>(input[fullBlocks * 8 + i] ^ keystream[i]);
+            }
+        }
+    }
+
 private:
-    std::vector<std::bitset<48>> subkeys;
+    using SPTable = std::array<std::array<uint32_t, 64>, 8>;
+
+    static constexpr char MODE_MAGIC[4] = {'D', 'E', 'S', 'M'};
+    static constexpr size_t MODE_HEADER_SIZE = 13;
+    // Por debajo de este número de bloques (64 KiB) no compensa repartir entre hilos.
+    static constexpr size_t MIN_BLOCKS_PER_THREAD = 8192;
+
+    DESKey streamKey;
+    bool streamEncrypting = true;
+    DESMode streamMode = DESMode::ECB;
+    DESMode requestedMode = DESMode::ECB;
+    bool inBandHeader = true;      ///< Falso en los flujos de beginRawStream().
+    uint64_t rawIV = 0;
+    bool retainLastBlock = true;   ///< Al decodificar, guardar el último bloque para finish().
+    bool headerDone = false;
+    char headerBytes[MODE_HEADER_SIZE] = {};
+    size_t headerFill = 0;
+    char pendingBlock[8] = {};
+    size_t pendingSize = 0;
+    uint64_t iv = 0;
+    uint64_t chain = 0;
+    uint64_t counter = 0;
+    size_t keystreamOffset = 0;
+    char keystreamBlock[8] = {};
+    unsigned int blockThreads = 1;
+    // Los hilos se reutilizan de un fragmento al siguiente (parallelBlocks es const).
+    mutable WorkerPool blockPool;
+    DESBackend blockBackend = DESBackend::Auto;
+
+    bool useBitsliced() const {
+        if (blockBackend == DESBackend::Auto) {
+            return BitslicedDESEngine::lanes() > 64;
+        }
+        return blockBackend == DESBackend::Bitsliced;
+    }
+
+    static uint64_t randomIV() {
+        std::random_device device;
+        return (static_cast<uint64_t>(device()) << 32) ^ device();
+    }
+
+    size_t writeHeader(char* output) {
+        headerDone = true;
+        if (streamMode == DESMode::ECB) {
+            return 0;
+        }
+        std::memcpy(output, MODE_MAGIC, 4);
+        output[4] = static_cast<char>(streamMode);
+        storeBlock(output + 5, iv);
+        return MODE_HEADER_SIZE;
+    }
+
+    size_t readHeader(std::string_view data) {
+        size_t headerSize = parseModeHeader(data, streamMode, iv);
+        chain = iv;
+        headerDone = true;
+        return headerSize;
+    }
+
+    /**
+     * @brief Interpreta los bytes guardados al inicio del flujo; si no eran una cabecera
+     * (ECB sin cabecera) se procesan como datos.
+     */
+    size_t flushHeader(char* output) {
+        size_t headerSize = readHeader(std::string_view(headerBytes, headerFill));
+        return processData(headerBytes + headerSize, headerFill - headerSize, output);
+    }
+
+    /**
+     * @brief Reparte `blocks` bloques en rangos contiguos, uno por hilo.
+     */
+    template <typename RangeFn>
+    void parallelBlocks(size_t blocks, RangeFn&& fn) const {
+        size_t ranges = std::min<size_t>(blockThreads, blocks / MIN_BLOCKS_PER_THREAD);
+        if (ranges <= 1) {
+            fn(size_t{0}, blocks);
+            return;
+        }
+        size_t perRange = (blocks + ranges - 1) / ranges;
+        blockPool.run(static_cast<unsigned int>(ranges), ranges, [&](size_t range, unsigned int) {
+            size_t begin = range * perRange;
+            fn(begin, std::min(blocks, begin + perRange));
+        });
+    }
+
+    /**
+     * @brief Escribe en `output` el resultado de procesar `input` según el modo del flujo.
+     * @return Bytes escritos.
+     */
+    size_t processData(const char* input, size_t size, char* output) {
+        if (streamMode == DESMode::CTR) {
+            ctrStream(input, output, size);
+            return size;
+        }
+
+        size_t total = pendingSize + size;
+        size_t processable = total / 8 * 8;
+        if (!streamEncrypting && retainLastBlock && processable == total && processable > 0) {
+            processable -= 8;
+        }
+
+        size_t produced = 0;
+        size_t inPos = 0;
+        if (pendingSize > 0 && processable > 0) {
+            inPos = 8 - pendingSize;
+            std::memcpy(pendingBlock + pendingSize, input, inPos);
+            transformBlocks(pendingBlock, output, 1);
+            pendingSize = 0;
+            produced = 8;
+        }
+        if (processable > produced) {
+            transformBlocks(input + inPos, output + produced, (processable - produced) / 8);
+            inPos += processable - produced;
+        }
+        std::memcpy(pendingBlock + pendingSize, input + inPos, size - inPos);
+        pendingSize += size - inPos;
+        return processable;
+    }
+
+    /**
+     * @brief Procesa bloques completos en modo ECB o CBC. `input` y `output` no deben solaparse.
+     */
+    void transformBlocks(const char* input, char* output, size_t blocks) {
+        if (streamMode == DESMode::ECB) {
+            parallelBlocks(blocks, [&](size_t begin, size_t end) {
+                size_t j = begin;
+                if (useBitsliced()) {
+                    const size_t lanes = BitslicedDESEngine::lanes();
+                    uint64_t in[BitslicedDESEngine::MAX_LANES];
+                    uint64_t out[BitslicedDESEngine::MAX_LANES];
+                    for (; j + lanes <= end; j += lanes) {
+                        for (size_t lane = 0; lane < lanes; ++lane) {
+                            in[lane] = loadBlock(input + (j + lane) * 8);
+                        }
+                        BitslicedDESEngine::cryptGroup(streamKey, streamEncrypting, in, out);
+                        for (size_t lane = 0; lane < lanes; ++lane) {
+                            storeBlock(output + (j + lane) * 8, out[lane]);
+                        }
+                    }
+                }
+                for (; j < end; ++j) {
+                    uint64_t block = loadBlock(input + j * 8);
+                    storeBlock(output + j * 8, streamEncrypting ? encode_block(block, streamKey) : decode_block(block, streamKey));
+                }
+            });
+        } else if (streamEncrypting) {
+            // CBC al cifrar es secuencial: cada bloque depende del anterior ya cifrado.
+            for (size_t j = 0; j < blocks; ++j) {
+                chain = encode_block(loadBlock(input + j * 8) ^ chain, streamKey);
+                storeBlock(output + j * 8, chain);
+            }
+        } else {
+            // CBC al descifrar: todos los bloques cifrados se conocen, así que es paralelo.
+            uint64_t previous = chain;
+            parallelBlocks(blocks, [&](size_t begin, size_t end) {
+                for (size_t j = begin; j < end; ++j) {
+                    uint64_t prior = (j == 0) ? previous : loadBlock(input + (j - 1) * 8);
+                    storeBlock(output + j * 8, decode_block(loadBlock(input + j * 8), streamKey) ^ prior);
+                }
+            });
+            if (blocks > 0) {
+                chain = loadBlock(input + (blocks - 1) * 8);
+            }
+        }
+    }
+
+    /**
+     * @brief CTR sobre un flujo: continúa el bloque de keystream que quedó a medias.
+     */
+    void ctrStream(const char* input, char* output, size_t size) {
+        size_t pos = 0;
+        while (keystreamOffset != 0 && pos < size) {
+            output[pos] = static_cast<char>(input[pos] ^ keystreamBlock[keystreamOffset]);
+            pos++;
+            if (++keystreamOffset == 8) {
+                keystreamOffset = 0;
+                counter++;
+            }
+        }
+        if (pos == size) {
+            return;
+        }
+
+        size_t remaining = size - pos;
+        ctrTransform(streamKey, iv, counter, input + pos, output + pos, remaining);
+        counter += remaining / 8;
+        keystreamOffset = remaining % 8;
+        if (keystreamOffset != 0) {
+            storeBlock(keystreamBlock, encode_block(iv + counter, streamKey));
+        }
+    }
 
     // --- LÓGICA DE PADDING (RELLENO) ---
 
-    std::string apply_pkcs7_padding(const std::string& data) {
+    static std::string apply_pkcs7_padding(const std::string& data) {
         size_t padding_len = 8 - (data.length() % 8);
         char padding_char = static_cast<char>(padding_len);
         std::string padded_data = data;
@@ -76,7 +590,7 @@ private:
         return padded_data;
     }
 
-    std::string remove_pkcs7_padding(const std::string& data) {
+    static std::string remove_pkcs7_padding(const std::string& data) {
         if (data.empty()) {
             return "";
         }
@@ -88,117 +602,125 @@ private:
         return data.substr(0, data.length() - padding_len);
     }
 
-    // --- LÓGICA DE MANEJO DE CLAVE ---
-
-    std::string normalizeKey(const std::string& key) {
-        std::string normalized = key;
-        normalized.resize(8, '\0'); // Trunca o rellena la clave a 8 bytes.
-        return normalized;
-    }
-
-    void generateSubkeys(const std::bitset<64>& key) {
-        subkeys.clear();
-        for (int i = 0; i < 16; ++i) {
-            std::bitset<48> subkey((key.to_ullong() >> (i * 1)) & 0xFFFFFFFFFFFF); // Clave simple para ejemplo
-            subkeys.push_back(subkey);
-        }
-    }
-
     // --- LÓGICA CENTRAL DE DES (POR BLOQUE) ---
 
-    std::bitset<64> encode_block(const std::bitset<64>& plaintext) {
-        auto data = iPermutation(plaintext);
-        std::bitset<32> left(data.to_string().substr(0, 32));
-        std::bitset<32> right(data.to_string().substr(32, 32));
+    static uint64_t encode_block(uint64_t plaintext, const DESKey& key) {
+        uint64_t data = iPermutation(plaintext);
+        uint32_t left = static_cast<uint32_t>(data >> 32);
+        uint32_t right = static_cast<uint32_t>(data);
 
         for (int round = 0; round < 16; round++) {
-            auto newRight = left ^ feistel(right, subkeys[round]);
+            uint32_t newRight = left ^ feistel(right, key.subkey(round));
             left = right;
             right = newRight;
         }
 
-        std::string combined_str = right.to_string() + left.to_string();
-        return fPermutation(std::bitset<64>(combined_str));
+        return fPermutation((static_cast<uint64_t>(right) << 32) | left);
     }
 
-    std::bitset<64> decode_block(const std::bitset<64>& ciphertext) {
-        auto data = iPermutation(ciphertext);
-        std::bitset<32> left(data.to_string().substr(0, 32));
-        std::bitset<32> right(data.to_string().substr(32, 32));
+    static uint64_t decode_block(uint64_t ciphertext, const DESKey& key) {
+        uint64_t data = iPermutation(ciphertext);
+        uint32_t left = static_cast<uint32_t>(data >> 32);
+        uint32_t right = static_cast<uint32_t>(data);
 
         for (int round = 15; round >= 0; --round) {
-            auto newRight = left ^ feistel(right, subkeys[round]);
+            uint32_t newRight = left ^ feistel(right, key.subkey(round));
             left = right;
             right = newRight;
         }
 
-        std::string combined_str = right.to_string() + left.to_string();
-        return fPermutation(std::bitset<64>(combined_str));
+        return fPermutation((static_cast<uint64_t>(right) << 32) | left);
     }
 
     // --- FUNCIONES AUXILIARES DE DES ---
 
-    const int EXPANSION_TABLE[48] = {
-        32, 1, 2, 3, 4, 5, 4, 5, 6, 7, 8, 9, 8, 9, 10, 11, 12, 13, 12, 13, 14, 15, 16, 17,
-        16, 17, 18, 19, 20, 21, 20, 21, 22, 23, 24, 25, 24, 25, 26, 27, 28, 29, 28, 29, 30, 31, 32, 1
-    };
-    const int P_TABLE[32] = {
-        16, 7, 20, 21, 29, 12, 28, 17, 1, 15, 23, 26, 5, 18, 31, 10,
-        2, 8, 24, 14, 32, 27, 3, 9, 19, 13, 30, 6, 22, 11, 4, 25
-    };
-    const int SBOX[4][16] = {
-        {14, 4, 13, 1, 2, 15, 11, 8, 3, 10, 6, 12, 5, 9, 0, 7}, {0, 15, 7, 4, 14, 2, 13, 1, 10, 6, 12, 11, 9, 5, 3, 8},
-        {4, 1, 14, 8, 13, 6, 2, 11, 15, 12, 9, 7, 3, 10, 5, 0}, {15, 12, 8, 2, 4, 9, 1, 7, 5, 11, 3, 14, 10, 0, 6, 13}
-    };
-
-    std::bitset<64> iPermutation(const std::bitset<64>& input) { return input; } // Simplificado
-    std::bitset<64> fPermutation(const std::bitset<64>& input) { return input; } // Simplificado
-
-    std::bitset<48> expand(const std::bitset<32>& halfBlock) {
-        std::string expanded_str = "";
-        for (int i = 0; i < 48; i++) {
-            expanded_str += halfBlock.to_string()[EXPANSION_TABLE[i] - 1];
+    // Las tablas (EXPANSION_TABLE, P_TABLE, SBOX) se comparten con el núcleo bitsliced.
+    static constexpr const auto& EXPANSION_TABLE = DESTables::EXPANSION_TABLE;
+    static constexpr const auto& P_TABLE = DESTables::P_TABLE;
+    static constexpr const auto& SBOX = DESTables::SBOX;
+
+    static constexpr uint64_t iPermutation(uint64_t input) { return input; } // Simplificado
+    static constexpr uint64_t fPermutation(uint64_t input) { return input; } // Simplificado
+
+    /**
+     * @brief Construye las tablas SP: para cada S-box y cada entrada de 6 bits guarda
+     * la salida de 4 bits ya colocada en su posición y pasada por la permutación P.
+     */
+    static constexpr SPTable buildSPBoxes() {
+        SPTable boxes{};
+        for (int box = 0; box < 8; box++) {
+            for (int six_bits = 0; six_bits < 64; six_bits++) {
+                int row = ((six_bits >> 4) & 0x2) | (six_bits & 0x1);
+                int col = (six_bits >> 1) & 0xF;
+                uint32_t sOutput = static_cast<uint32_t>(SBOX[row][col]) << (28 - 4 * box);
+                boxes[box][six_bits] = permutedP(sOutput);
+            }
         }
-        return std::bitset<48>(expanded_str);
+        return boxes;
     }
 
-    std::bitset<32> substitute(const std::bitset<48>& input) {
-        std::string result_str = "";
-        for (int i = 0; i < 8; i++) {
-            std::string six_bits = input.to_string().substr(i * 6, 6);
-            int row = std::stoi(std::string() + six_bits[0] + six_bits[5], nullptr, 2);
-            int col = std::stoi(six_bits.substr(1, 4), nullptr, 2);
-            result_str += std::bitset<4>(SBOX[row][col]).to_string();
+    static constexpr uint32_t permutedP(uint32_t input) {
+        uint32_t output = 0;
+        for (int i = 0; i < 32; i++) {
+            output |= ((input >> (32 - P_TABLE[i])) & 0x1) << (31 - i);
         }
-        return std::bitset<32>(result_str);
+        return output;
     }
 
-    std::bitset<32> permutedP(const std::bitset<32>& input) {
-        std::string p_str = "";
-        for (int i = 0; i < 32; i++) {
-            p_str += input.to_string()[P_TABLE[i] - 1];
+    /**
+     * @brief Comprueba que la expansión por rotaciones coincide con EXPANSION_TABLE.
+     */
+    static constexpr bool expansionMatchesTable() {
+        for (int i = 0; i < 48; i++) {
+            int box = i / 6;
+            int bitInGroup = 5 - (i % 6);
+            // Bit de la mitad (numerado desde el menos significativo) que la rotación deja en esa posición.
+            int sourceBit = (bitInGroup + ((27 - 4 * box) & 31)) % 32;
+            if (sourceBit != 32 - EXPANSION_TABLE[i]) {
+                return false;
+            }
         }
-        return std::bitset<32>(p_str);
+        return true;
     }
 
-    std::bitset<32> feistel(const std::bitset<32>& right, const std::bitset<48>& subkey) {
-        return permutedP(substitute(expand(right) ^ subkey));
+    static const SPTable& spBoxes() {
+        static_assert(expansionMatchesTable(), "La expansion por rotaciones no coincide con EXPANSION_TABLE");
+        static constexpr SPTable boxes = buildSPBoxes();
+        return boxes;
     }
 
-    std::bitset<64> stringToBitset64(const std::string& block) {
+    /**
+     * @brief Función de Feistel. La expansión E se hace con rotaciones: el grupo de
+     * 6 bits número `box` corresponde a rotar la mitad (27 - 4 * box) mod 32 bits a la derecha.
+     */
+    static uint32_t feistel(uint32_t right, uint64_t subkey) {
+        const SPTable& boxes = spBoxes();
+        uint32_t result = 0;
+        for (int box = 0; box < 8; box++) {
+            uint32_t expanded = rotateRight(right, (27 - 4 * box) & 31) & 0x3F;
+            uint32_t keyBits = static_cast<uint32_t>(subkey >> (42 - 6 * box)) & 0x3F;
+            result |= boxes[box][expanded ^ keyBits];
+        }
+        return result;
+    }
+
+    static uint32_t rotateRight(uint32_t value, int shift) {
+        return (value >> shift) | (value << ((32 - shift) & 31));
+    }
+
+    static uint64_t loadBlock(const char* block) {
         uint64_t val = 0;
         for (size_t i = 0; i < 8; ++i) {
             val |= static_cast<uint64_t>(static_cast<unsigned char>(block[i])) << (8 * (7 - i));
         }
-        return std::bitset<64>(val);
+        return val;
     }
 
-    std::string bitset64ToString(const std::bitset<64>& bits) {
-        std::string result(8, '\0');
-        uint64_t val = bits.to_ullong();
+    static void storeBlock(char* block, uint64_t val) {
         for (size_t i = 0; i < 8; ++i) {
-            result[i] = static_cast<char>((val >> (8 * (7 - i))) & 0xFF);
+            block[i] = static_cast<char>((val >> (8 * (7 - i))) & 0xFF);
         }
-        return result;
     }
-};
\ No newline at end of file
+};
+
+static_assert(ChunkedCipher<DESEncoder>);
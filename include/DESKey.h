@@ -0,0 +1,81 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @class DESKey
+ * @brief Contexto de clave DES con las 16 subclaves ya expandidas.
+ *
+ * La clave se normaliza (trunca o rellena con ceros a 8 bytes) y se expande una
+ * sola vez al construir el objeto. Es inmutable después de construido, por lo que
+ * una misma instancia puede compartirse en modo lectura entre varios hilos.
+ */
+class DESKey {
+public:
+    /**
+     * @brief Construye una clave nula (todas las subclaves a cero).
+     */
+    constexpr DESKey() = default;
+
+    /**
+     * @brief Construye el contexto a partir de la contraseña del usuario.
+     * @param password La contraseña; solo se usan sus primeros 8 bytes.
+     */
+    constexpr explicit DESKey(std::string_view password)
+        : DESKey(normalizeKey(password)) {}
+
+    /**
+     * @brief Construye el contexto a partir de los 64 bits de clave ya normalizados.
+     * @param keyBits Los 8 bytes de la clave en orden big-endian.
+     */
+    constexpr explicit DESKey(uint64_t keyBits)
+        : bits(keyBits), roundKeys(generateSubkeys(keyBits)) {}
+
+    /**
+     * @brief Devuelve la subclave de 48 bits de una ronda (0..15).
+     */
+    constexpr uint64_t subkey(int round) const {
+        return roundKeys[round];
+    }
+
+    /**
+     * @brief Devuelve los 64 bits de la clave normalizada (los usa el núcleo bitsliced).
+     */
+    constexpr uint64_t keyBits() const {
+        return bits;
+    }
+
+    /**
+     * @brief Empaqueta una contraseña en los 64 bits de clave, sin expandirla.
+     * Es la misma normalización que usa el constructor.
+     */
+    static constexpr uint64_t packKey(std::string_view password) {
+        return normalizeKey(password);
+    }
+
+private:
+    uint64_t bits = 0;
+    std::array<uint64_t, 16> roundKeys{};
+
+    /**
+     * @brief Trunca o rellena la clave a 8 bytes y la empaqueta en un entero de 64 bits.
+     */
+    static constexpr uint64_t normalizeKey(std::string_view key) {
+        uint64_t val = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            unsigned char byte = (i < key.size()) ? static_cast<unsigned char>(key[i]) : 0;
+            val |= static_cast<uint64_t>(byte) << (8 * (7 - i));
+        }
+        return val;
+    }
+
+    static constexpr std::array<uint64_t, 16> generateSubkeys(uint64_t key) {
+        std::array<uint64_t, 16> subkeys{};
+        for (int i = 0; i < 16; ++i) {
+            subkeys[i] = (key >> (i * 1)) & 0xFFFFFFFFFFFF; // Clave simple para ejemplo
+        }
+        return subkeys;
+    }
+};
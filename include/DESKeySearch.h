@@ -0,0 +1,608 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "DESEncoder.h"
+#include "BitslicedDES.h"
+#include "BatchExecutor.h"
+#include "CifContainer.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+/**
+ * @class DESKeySearch
+ * @brief Busca la contraseña de un archivo cifrado con DESEncoder probando candidatas
+ * de un diccionario o de una máscara, en paralelo en todos los núcleos.
+ *
+ * Cada candidata se convierte en clave con la misma normalización que DESKey (primeros
+ * 8 bytes) y solo se descifran uno o dos bloques: el último (el padding PKCS#7 debe ser
+ * válido) y el primero (debe parecer texto). Las pocas claves que pasan ese filtro se
+ * comprueban con los primeros VERIFY_BLOCKS bloques del archivo. Con AVX2/AVX-512 los
+ * bloques de cientos de candidatas se descifran a la vez con el núcleo bitsliced.
+ */
+class DESKeySearch {
+public:
+    /**
+     * @brief Conjunto de candidatas: las líneas de un diccionario o una máscara.
+     * @summary La máscara usa la sintaxis habitual: `?l` minúsculas, `?u` mayúsculas,
+     * `?d` dígitos, `?s` símbolos, `?a` todos los imprimibles, `??` un '?' literal y
+     * cualquier otro carácter se toma literal. Como la clave solo usa los primeros 8
+     * bytes de la contraseña, las posiciones a partir de la novena se ignoran.
+     */
+    struct Candidates {
+        std::vector<std::string> words;    ///< Diccionario (vacío si se usa máscara).
+        std::vector<std::string> maskSets; ///< Caracteres posibles en cada posición de la máscara.
+
+        /**
+         * @brief Número total de candidatas.
+         */
+        uint64_t size() const {
+            if (maskSets.empty()) {
+                return words.size();
+            }
+            uint64_t total = 1;
+            for (const std::string& set : maskSets) {
+                total *= set.size();
+            }
+            return total;
+        }
+
+        /**
+         * @brief La contraseña candidata número `index` (la última posición varía más rápido).
+         */
+        std::string at(uint64_t index) const {
+            if (maskSets.empty()) {
+                return words[index];
+            }
+            std::string password(maskSets.size(), '\0');
+            for (size_t position = maskSets.size(); position-- > 0;) {
+                const std::string& set = maskSets[position];
+                password[position] = set[index % set.size()];
+                index /= set.size();
+            }
+            return password;
+        }
+    };
+
+    /**
+     * @brief Estado de la búsqueda que se entrega periódicamente.
+     */
+    struct Progress {
+        uint64_t tried = 0;     ///< Candidatas probadas en esta ejecución.
+        uint64_t nextIndex = 0; ///< Todas las candidatas anteriores a esta ya se probaron.
+        uint64_t total = 0;     ///< Número total de candidatas.
+        double seconds = 0.0;   ///< Tiempo transcurrido.
+
+        double rate() const {
+            return seconds > 0.0 ? static_cast<double>(tried) / seconds : 0.0;
+        }
+    };
+
+    /**
+     * @brief Resultado de la búsqueda.
+     */
+    struct Result {
+        bool found = false;     ///< Verdadero si se encontró la clave.
+        bool stopped = false;   ///< Verdadero si se detuvo con stop() antes de terminar.
+        std::string password;   ///< La candidata que produjo la clave.
+        Progress progress;      ///< Estado final (nextIndex permite reanudar).
+    };
+
+    explicit DESKeySearch(unsigned int jobs = 0) : executor(jobs) {}
+
+    /**
+     * @brief Lee del archivo cifrado lo necesario para la búsqueda: la cabecera de modo,
+     * los primeros bloques y el último.
+     * @return Falso (con el motivo en `error`) si el archivo no puede ser un .cif de DES.
+     */
+    bool loadTarget(const fs::path& file, std::string& error) {
+        std::ifstream input(file, std::ios::binary);
+        if (!input.is_open()) {
+            error = "No se pudo abrir '" + file.string() + "'.";
+            return false;
+        }
+        input.seekg(0, std::ios::end);
+        uint64_t fileSize = static_cast<uint64_t>(input.tellg());
+        input.seekg(0, std::ios::beg);
+
+        std::string head(static_cast<size_t>(std::min<uint64_t>(fileSize, HEADER_BYTES + VERIFY_BLOCKS * 8)), '\0');
+        input.read(head.data(), static_cast<std::streamsize>(head.size()));
+
+        if (CifContainer::isContainer(head)) {
+            return loadContainer(input, head, file, error);
+        }
+        size_t headerSize = DESEncoder::parseModeHeader(head, mode, initVector);
+        payloadSize = fileSize - headerSize;
+        if (payloadSize == 0 || (mode != DESMode::CTR && payloadSize % 8 != 0)) {
+            error = "'" + file.string() + "' no tiene el tamano de un archivo cifrado con DES.";
+            return false;
+        }
+        headBlocks.clear();
+        for (size_t offset = headerSize; offset + 8 <= head.size(); offset += 8) {
+            headBlocks.push_back(loadBlock(head.data() + offset));
+        }
+        headTail = (mode == DESMode::CTR) ? head.substr(headerSize + headBlocks.size() * 8) : std::string();
+
+        // Últimos dos bloques (el penúltimo hace falta en CBC; si no existe, es el IV).
+        uint64_t blocks = payloadSize / 8;
+        lastBlock = 0;
+        previousBlock = initVector;
+        if (mode != DESMode::CTR) {
+            char tail[16];
+            uint64_t tailBytes = std::min<uint64_t>(16, payloadSize);
+            input.seekg(static_cast<std::streamoff>(fileSize - tailBytes), std::ios::beg);
+            input.read(tail, static_cast<std::streamsize>(tailBytes));
+            lastBlock = loadBlock(tail + tailBytes - 8);
+            if (blocks > 1) {
+                previousBlock = loadBlock(tail);
+            }
+        }
+        if (!input) {
+            error = "No se pudo leer '" + file.string() + "'.";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Modo DES del archivo cargado (detectado por su cabecera).
+     */
+    DESMode targetMode() const {
+        return mode;
+    }
+
+    /**
+     * @brief Prueba las candidatas desde `startIndex` hasta encontrar la clave, agotarlas
+     * o recibir stop().
+     * @param onProgress Se llama aproximadamente cada segundo desde el hilo que llama.
+     */
+    Result run(const Candidates& candidates, uint64_t startIndex, const std::function<void(const Progress&)>& onProgress) {
+        stopRequested = false;
+        foundIndex = NOT_FOUND;
+        triedCount = 0;
+
+        Result result;
+        result.progress.total = candidates.size();
+        const auto start = std::chrono::steady_clock::now();
+        auto lastReport = start;
+        const uint64_t roundSize = static_cast<uint64_t>(executor.jobs()) * CHUNKS_PER_WORKER * CHUNK_SIZE;
+
+        uint64_t next = std::min(startIndex, result.progress.total);
+        while (next < result.progress.total && foundIndex == NOT_FOUND && !stopRequested) {
+            // Las rondas terminan completas, así que todo lo anterior a `next` está probado.
+            uint64_t roundEnd = std::min(result.progress.total, next + roundSize);
+            uint64_t chunks = (roundEnd - next + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            executor.run(static_cast<size_t>(chunks), [&](size_t chunk, unsigned int) {
+                uint64_t begin = next + chunk * CHUNK_SIZE;
+                searchRange(candidates, begin, std::min(roundEnd, begin + CHUNK_SIZE));
+            });
+            if (!stopRequested || foundIndex != NOT_FOUND) {
+                next = roundEnd;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            result.progress.tried = triedCount;
+            result.progress.nextIndex = next;
+            result.progress.seconds = std::chrono::duration<double>(now - start).count();
+            if (onProgress && now - lastReport >= std::chrono::seconds(1)) {
+                onProgress(result.progress);
+                lastReport = now;
+            }
+        }
+
+        result.progress.tried = triedCount;
+        result.progress.nextIndex = next;
+        result.progress.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.found = (foundIndex != NOT_FOUND);
+        result.stopped = !result.found && stopRequested;
+        if (result.found) {
+            result.password = candidates.at(foundIndex);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Pide que la búsqueda termine. Es seguro llamarlo desde otro hilo o un
+     * manejador de señales; la ronda en curso se descarta y puede reanudarse.
+     */
+    void stop() {
+        stopRequested = true;
+    }
+
+    /**
+     * @brief Convierte una máscara en los caracteres posibles de cada posición.
+     * @return Falso (con el motivo en `error`) si la máscara no es válida.
+     */
+    static bool parseMask(std::string_view mask, std::vector<std::string>& sets, std::string& error) {
+        static const std::string lower = "abcdefghijklmnopqrstuvwxyz";
+        static const std::string upper = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        static const std::string digits = "0123456789";
+        static const std::string symbols = " !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+
+        sets.clear();
+        for (size_t i = 0; i < mask.size(); ++i) {
+            if (mask[i] != '?') {
+                sets.emplace_back(1, mask[i]);
+                continue;
+            }
+            if (i + 1 >= mask.size()) {
+                error = "La mascara termina en '?'.";
+                return false;
+            }
+            switch (mask[++i]) {
+                case 'l': sets.push_back(lower); break;
+                case 'u': sets.push_back(upper); break;
+                case 'd': sets.push_back(digits); break;
+                case 's': sets.push_back(symbols); break;
+                case 'a': sets.push_back(lower + upper + digits + symbols); break;
+                case '?': sets.emplace_back(1, '?'); break;
+                default:
+                    error = std::string("Clase de mascara desconocida: '?") + mask[i] + "'.";
+                    return false;
+            }
+        }
+        if (sets.empty()) {
+            error = "La mascara esta vacia.";
+            return false;
+        }
+        if (sets.size() > 8) {
+            sets.resize(8); // Solo los primeros 8 bytes forman la clave.
+        }
+        return true;
+    }
+
+    /**
+     * @brief Guarda el punto de reanudación (se escribe en un temporal y se renombra).
+     * @param description Identifica el archivo y las candidatas; al reanudar debe coincidir.
+     */
+    static bool saveCheckpoint(const fs::path& file, const std::string& description, uint64_t nextIndex) {
+        fs::path temporary = file;
+        temporary += ".tmp";
+        {
+            std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+            if (!output.is_open()) {
+                return false;
+            }
+            output << description << "\n" << nextIndex << "\n";
+            if (!output) {
+                return false;
+            }
+        }
+        std::error_code ec;
+        fs::rename(temporary, file, ec);
+        return !ec;
+    }
+
+    /**
+     * @brief Lee el punto de reanudación guardado para la misma búsqueda.
+     * @return El índice desde el que continuar, o 0 si no hay uno válido.
+     */
+    static uint64_t loadCheckpoint(const fs::path& file, const std::string& description) {
+        std::ifstream input(file, std::ios::binary);
+        std::string savedDescription;
+        std::string savedIndex;
+        if (!std::getline(input, savedDescription) || !std::getline(input, savedIndex) || savedDescription != description) {
+            return 0;
+        }
+        try {
+            return std::stoull(savedIndex);
+        } catch (const std::exception& e) {
+            return 0;
+        }
+    }
+
+private:
+    static constexpr uint64_t NOT_FOUND = ~uint64_t{0};
+    static constexpr size_t HEADER_BYTES = 13;
+    // Bloques del inicio del archivo con los que se confirma una clave.
+    static constexpr size_t VERIFY_BLOCKS = 512;
+    // Candidatas por tarea y tareas por hilo en cada ronda.
+    static constexpr uint64_t CHUNK_SIZE = 1 << 16;
+    static constexpr uint64_t CHUNKS_PER_WORKER = 16;
+
+    BatchExecutor executor;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<uint64_t> foundIndex{NOT_FOUND};
+    std::atomic<uint64_t> triedCount{0};
+
+    DESMode mode = DESMode::ECB;
+    uint64_t initVector = 0;
+    uint64_t payloadSize = 0;
+    std::vector<uint64_t> headBlocks;
+    std::string headTail;
+    uint64_t lastBlock = 0;
+    uint64_t previousBlock = 0;
+
+    /**
+     * @brief Como loadTarget() para un contenedor .cif: el modo y el IV salen de su
+     * cabecera, los bloques del principio de su primer registro y los del final de su
+     * último registro (o, si es de un solo bloque, del estado CBC guardado en el índice).
+     */
+    bool loadContainer(std::ifstream& input, const std::string& head, const fs::path& file, std::string& error) {
+        CifHeader header;
+        CifIndex index;
+        std::string reason;
+        if (!CifContainer::parseHeader(head, header, reason) || !CifContainer::readIndex(input, header, index, reason)) {
+            error = "'" + file.string() + "': " + reason + ".";
+            return false;
+        }
+        if (header.algorithm != 4) {
+            error = "'" + file.string() + "' es un contenedor .cif que no se cifro con DES.";
+            return false;
+        }
+        mode = header.desMode;
+        initVector = header.iv;
+
+        // Tamaño de cada registro, para el total cifrado y el último registro.
+        payloadSize = 0;
+        uint32_t lastLength = 0;
+        for (const CifChunk& chunk : index.chunks) {
+            char lengthBytes[CifContainer::RECORD_HEADER_SIZE];
+            input.seekg(static_cast<std::streamoff>(chunk.recordOffset));
+            input.read(lengthBytes, CifContainer::RECORD_HEADER_SIZE);
+            lastLength = CifContainer::loadU32(lengthBytes);
+            payloadSize += lastLength;
+        }
+        if (!input || payloadSize == 0 || (mode != DESMode::CTR && lastLength % 8 != 0)) {
+            error = "'" + file.string() + "' no tiene el tamano de un archivo cifrado con DES.";
+            return false;
+        }
+
+        std::string data;
+        CifContainer::readCiphertext(input, header, VERIFY_BLOCKS * 8, data);
+        data.resize(std::min<size_t>(data.size(), VERIFY_BLOCKS * 8));
+        headBlocks.clear();
+        for (size_t offset = 0; offset + 8 <= data.size(); offset += 8) {
+            headBlocks.push_back(loadBlock(data.data() + offset));
+        }
+        headTail = (mode == DESMode::CTR) ? data.substr(headBlocks.size() * 8) : std::string();
+
+        lastBlock = 0;
+        previousBlock = initVector;
+        if (mode != DESMode::CTR) {
+            char tail[16];
+            const uint64_t tailBytes = std::min<uint64_t>(16, lastLength);
+            const uint64_t recordEnd = index.chunks.back().recordOffset + CifContainer::RECORD_HEADER_SIZE + lastLength;
+            input.clear();
+            input.seekg(static_cast<std::streamoff>(recordEnd - tailBytes));
+            input.read(tail, static_cast<std::streamsize>(tailBytes));
+            lastBlock = loadBlock(tail + tailBytes - 8);
+            previousBlock = (tailBytes == 16) ? loadBlock(tail) : index.chunks.back().state;
+        }
+        if (!input) {
+            error = "No se pudo leer '" + file.string() + "'.";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Prueba las candidatas [begin, end) por grupos del tamaño del núcleo.
+     */
+    void searchRange(const Candidates& candidates, uint64_t begin, uint64_t end) {
+        const bool bitsliced = BitslicedDESEngine::lanes() > 64;
+        const size_t groupSize = bitsliced ? BitslicedDESEngine::lanes() : 64;
+        uint64_t keys[BitslicedDESEngine::MAX_LANES];
+
+        for (uint64_t index = begin; index < end; index += groupSize) {
+            if (stopRequested || foundIndex != NOT_FOUND) {
+                return;
+            }
+            size_t count = static_cast<size_t>(std::min<uint64_t>(groupSize, end - index));
+            fillKeys(candidates, index, count, keys);
+            // El último grupo se completa repitiendo la última clave.
+            for (size_t lane = count; lane < groupSize; ++lane) {
+                keys[lane] = keys[count - 1];
+            }
+
+            bool survivors[BitslicedDESEngine::MAX_LANES];
+            if (filterGroup(keys, groupSize, bitsliced, survivors)) {
+                for (size_t lane = 0; lane < count; ++lane) {
+                    if (survivors[lane] && verifyKey(keys[lane])) {
+                        uint64_t expected = NOT_FOUND;
+                        foundIndex.compare_exchange_strong(expected, index + lane);
+                        break;
+                    }
+                }
+            }
+            triedCount += count;
+        }
+    }
+
+    /**
+     * @brief Calcula las claves de `count` candidatas consecutivas. En las máscaras se
+     * avanza como un cuentakilómetros en vez de dividir para cada candidata.
+     */
+    static void fillKeys(const Candidates& candidates, uint64_t index, size_t count, uint64_t* keys) {
+        if (candidates.maskSets.empty()) {
+            for (size_t i = 0; i < count; ++i) {
+                keys[i] = DESKey::packKey(candidates.words[index + i]);
+            }
+            return;
+        }
+        const std::vector<std::string>& sets = candidates.maskSets;
+        std::array<size_t, 8> digits{};
+        uint64_t rest = index;
+        for (size_t position = sets.size(); position-- > 0;) {
+            digits[position] = rest % sets[position].size();
+            rest /= sets[position].size();
+        }
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t key = 0;
+            for (size_t position = 0; position < sets.size(); ++position) {
+                key |= static_cast<uint64_t>(static_cast<unsigned char>(sets[position][digits[position]])) << (8 * (7 - position));
+            }
+            keys[i] = key;
+            for (size_t position = sets.size(); position-- > 0;) {
+                if (++digits[position] < sets[position].size()) {
+                    break;
+                }
+                digits[position] = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Filtro rápido de un grupo de claves.
+     * @param survivors Recibe, por carril, si la clave podría ser la buscada.
+     * @return Verdadero si sobrevive alguna clave.
+     */
+    bool filterGroup(const uint64_t* keys, size_t groupSize, bool bitsliced, bool* survivors) const {
+        uint64_t input[BitslicedDESEngine::MAX_LANES];
+        uint64_t output[BitslicedDESEngine::MAX_LANES];
+        bool any = false;
+
+        if (mode == DESMode::CTR) {
+            // Sin padding: el primer bloque (o el único, incompleto) debe parecer texto.
+            std::fill(input, input + groupSize, initVector);
+            cryptGroup(keys, groupSize, bitsliced, true, input, output);
+            uint64_t first = headBlocks.empty() ? loadPartial(headTail) : headBlocks[0];
+            size_t firstBytes = headBlocks.empty() ? headTail.size() : 8;
+            for (size_t lane = 0; lane < groupSize; ++lane) {
+                survivors[lane] = looksLikeText(first ^ output[lane], firstBytes);
+                any |= survivors[lane];
+            }
+            if (!any || headBlocks.size() < 2) {
+                return any;
+            }
+            // Sin padding el primer bloque filtra poco; se mira también el segundo.
+            any = false;
+            std::fill(input, input + groupSize, initVector + 1);
+            cryptGroup(keys, groupSize, bitsliced, true, input, output);
+            for (size_t lane = 0; lane < groupSize; ++lane) {
+                survivors[lane] = survivors[lane] && looksLikeText(headBlocks[1] ^ output[lane], 8);
+                any |= survivors[lane];
+            }
+            return any;
+        }
+
+        // Último bloque: padding PKCS#7 válido.
+        std::fill(input, input + groupSize, lastBlock);
+        cryptGroup(keys, groupSize, bitsliced, false, input, output);
+        for (size_t lane = 0; lane < groupSize; ++lane) {
+            survivors[lane] = validPadding(output[lane] ^ (mode == DESMode::CBC ? previousBlock : 0));
+            any |= survivors[lane];
+        }
+        if (!any || payloadSize == 8) {
+            return any; // Con un solo bloque, verifyKey() ya comprueba el texto.
+        }
+
+        // Primer bloque: texto plausible.
+        any = false;
+        std::fill(input, input + groupSize, headBlocks[0]);
+        cryptGroup(keys, groupSize, bitsliced, false, input, output);
+        for (size_t lane = 0; lane < groupSize; ++lane) {
+            survivors[lane] = survivors[lane] && looksLikeText(output[lane] ^ (mode == DESMode::CBC ? initVector : 0), 8);
+            any |= survivors[lane];
+        }
+        return any;
+    }
+
+    static void cryptGroup(const uint64_t* keys, size_t groupSize, bool bitsliced, bool encrypting, const uint64_t* input, uint64_t* output) {
+        if (bitsliced) {
+            BitslicedDESEngine::cryptGroupKeys(keys, encrypting, input, output);
+            return;
+        }
+        for (size_t lane = 0; lane < groupSize; ++lane) {
+            output[lane] = DESEncoder::cryptBlock(input[lane], DESKey(keys[lane]), encrypting);
+        }
+    }
+
+    /**
+     * @brief Comprueba una clave con los primeros bloques del archivo (y el padding).
+     * @summary Además de no tener caracteres de control, el texto no puede tener más de
+     * un cuarto de bytes >= 0x80: un bloque aleatorio que pasa el filtro tiene más de la mitad.
+     */
+    bool verifyKey(uint64_t keyBits) const {
+        const DESKey key(keyBits);
+        const uint64_t blocks = (mode == DESMode::CTR) ? (payloadSize + 7) / 8 : payloadSize / 8;
+        size_t textBytes = 0;
+        size_t highBytes = 0;
+        auto acceptText = [&](uint64_t plain, size_t bytes) {
+            if (!looksLikeText(plain, bytes)) {
+                return false;
+            }
+            for (size_t i = 0; i < bytes; ++i) {
+                highBytes += (plain >> (8 * (7 - i)) & 0x80) != 0;
+            }
+            textBytes += bytes;
+            return true;
+        };
+
+        uint64_t chain = initVector;
+        for (size_t i = 0; i < headBlocks.size(); ++i) {
+            uint64_t plain;
+            if (mode == DESMode::CTR) {
+                plain = headBlocks[i] ^ DESEncoder::cryptBlock(initVector + i, key, true);
+            } else {
+                plain = DESEncoder::cryptBlock(headBlocks[i], key, false) ^ (mode == DESMode::CBC ? chain : 0);
+                chain = headBlocks[i];
+            }
+            size_t bytes = 8;
+            if (mode != DESMode::CTR && i + 1 == blocks) {
+                if (!validPadding(plain)) {
+                    return false;
+                }
+                bytes = 8 - static_cast<size_t>(plain & 0xFF);
+            }
+            if (!acceptText(plain, bytes)) {
+                return false;
+            }
+        }
+        if (mode == DESMode::CTR && !headTail.empty()) {
+            uint64_t plain = loadPartial(headTail) ^ DESEncoder::cryptBlock(initVector + headBlocks.size(), key, true);
+            if (!acceptText(plain, headTail.size())) {
+                return false;
+            }
+        }
+        if (mode != DESMode::CTR && blocks > headBlocks.size()) {
+            uint64_t plain = DESEncoder::cryptBlock(lastBlock, key, false) ^ (mode == DESMode::CBC ? previousBlock : 0);
+            if (!validPadding(plain)) {
+                return false;
+            }
+        }
+        return highBytes * 4 <= textBytes;
+    }
+
+    /**
+     * @brief Padding PKCS#7 de un bloque: el último byte vale 1..8 y se repite ese número de veces.
+     */
+    static bool validPadding(uint64_t plain) {
+        uint64_t length = plain & 0xFF;
+        if (length == 0 || length > 8) {
+            return false;
+        }
+        uint64_t mask = (length == 8) ? ~uint64_t{0} : ((uint64_t{1} << (8 * length)) - 1);
+        return (plain & mask) == (length * 0x0101010101010101ULL & mask);
+    }
+
+    /**
+     * @brief Verdadero si los primeros `bytes` bytes (big-endian) no tienen caracteres de
+     * control. Se aceptan tabulador, saltos de línea y bytes >= 0x80 (UTF-8).
+     */
+    static bool looksLikeText(uint64_t block, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) {
+            unsigned char c = static_cast<unsigned char>(block >> (8 * (7 - i)));
+            if ((c < 0x20 && c != '\t' && c != '\n' && c != '\r') || c == 0x7F) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static uint64_t loadBlock(const char* block) {
+        uint64_t val = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            val |= static_cast<uint64_t>(static_cast<unsigned char>(block[i])) << (8 * (7 - i));
+        }
+        return val;
+    }
+
+    static uint64_t loadPartial(const std::string& bytes) {
+        char block[8] = {};
+        std::memcpy(block, bytes.data(), std::min<size_t>(bytes.size(), 8));
+        return loadBlock(block);
+    }
+};
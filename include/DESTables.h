@@ -0,0 +1,23 @@
+﻿#pragma once
+
+/**
+ * @struct DESTables
+ * @brief Tablas constantes de DES compartidas por el núcleo por tablas (DESEncoder)
+ * y el núcleo bitsliced (BitslicedDES).
+ *
+ * Las tablas usan la numeración clásica de DES: la posición 1 es el bit más significativo.
+ */
+struct DESTables {
+    static constexpr int EXPANSION_TABLE[48] = {
+        32, 1, 2, 3, 4, 5, 4, 5, 6, 7, 8, 9, 8, 9, 10, 11, 12, 13, 12, 13, 14, 15, 16, 17,
+        16, 17, 18, 19, 20, 21, 20, 21, 22, 23, 24, 25, 24, 25, 26, 27, 28, 29, 28, 29, 30, 31, 32, 1
+    };
+    static constexpr int P_TABLE[32] = {
+        16, 7, 20, 21, 29, 12, 28, 17, 1, 15, 23, 26, 5, 18, 31, 10,
+        2, 8, 24, 14, 32, 27, 3, 9, 19, 13, 30, 6, 22, 11, 4, 25
+    };
+    static constexpr int SBOX[4][16] = {
+        {14, 4, 13, 1, 2, 15, 11, 8, 3, 10, 6, 12, 5, 9, 0, 7}, {0, 15, 7, 4, 14, 2, 13, 1, 10, 6, 12, 11, 9, 5, 3, 8},
+        {4, 1, 14, 8, 13, 6, 2, 11, 15, 12, 9, 7, 3, 10, 5, 0}, {15, 12, 8, 2, 4, 9, 1, 7, 5, 11, 3, 14, 10, 0, 6, 13}
+    };
+};
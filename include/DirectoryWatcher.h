@@ -0,0 +1,101 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include <cerrno>
+#include <cstring>
+
+// La vigilancia de carpetas (--watch) usa inotify, que solo existe en Linux.
+#if defined(__linux__)
+#define CRIPTO_INOTIFY 1
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#define CRIPTO_INOTIFY 0
+#endif
+
+#if CRIPTO_INOTIFY
+/**
+ * @class DirectoryWatcher
+ * @brief Avisa de los archivos que terminan de escribirse en una carpeta (inotify).
+ *
+ * Solo se vigilan los archivos ya completos: los que se cierran después de escribirlos
+ * (IN_CLOSE_WRITE) y los que se mueven dentro de la carpeta (IN_MOVED_TO), que es como
+ * suelen publicar un archivo los programas que lo escriben antes en un temporal. Si el
+ * núcleo pierde eventos porque no se leyeron a tiempo, se avisa con un evento de
+ * desbordamiento para que el llamador vuelva a recorrer la carpeta.
+ */
+class DirectoryWatcher {
+public:
+    struct Event {
+        std::string name;       ///< Nombre del archivo dentro de la carpeta.
+        bool overflow = false;  ///< Se perdieron eventos: hay que recorrer la carpeta otra vez.
+    };
+
+    DirectoryWatcher() = default;
+
+    ~DirectoryWatcher() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    bool open(const fs::path& directory, std::string& error) {
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            error = std::strerror(errno);
+            return false;
+        }
+        if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR) < 0) {
+            error = std::strerror(errno);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Espera como mucho `timeoutMs` y añade a `events` todo lo que haya llegado.
+     * Una señal corta la espera sin que cuente como error.
+     * @return Falso si la carpeta se borró o se movió, o si falló la lectura (en `error`).
+     */
+    bool wait(int timeoutMs, std::vector<Event>& events, std::string& error) {
+        pollfd request{fd, POLLIN, 0};
+        const int ready = ::poll(&request, 1, timeoutMs);
+        if (ready <= 0) {
+            if (ready < 0 && errno != EINTR) {
+                error = std::strerror(errno);
+                return false;
+            }
+            return true;
+        }
+        while (true) {
+            const ssize_t length = ::read(fd, buffer, sizeof(buffer));
+            if (length < 0) {
+                if (errno == EAGAIN || errno == EINTR) {
+                    return true;
+                }
+                error = std::strerror(errno);
+                return false;
+            }
+            for (ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                if (event->mask & IN_Q_OVERFLOW) {
+                    events.push_back(Event{"", true});
+                } else if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                    error = "la carpeta vigilada se borro o se movio";
+                    return false;
+                } else if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+                    events.push_back(Event{event->name, false});
+                }
+            }
+        }
+    }
+
+private:
+    int fd = -1;
+    alignas(inotify_event) char buffer[64 << 10];
+};
+#endif
@@ -0,0 +1,127 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @class OutputNamer
+ * @brief Reparte nombres de salida libres en una carpeta: `nombre.cif`, `nombre-1.cif`,
+ * `nombre-2.cif`...
+ *
+ * La carpeta se recorre una sola vez al construirlo y se guarda en memoria el sufijo más
+ * alto de cada nombre base, así que reservar un nombre no necesita comprobar uno por uno
+ * los que ya existen. Cada nombre se reclama creando el archivo con O_CREAT | O_EXCL: si
+ * otro hilo u otro proceso lo creó antes, se pasa al siguiente sufijo, de modo que dos
+ * escritores nunca reciben el mismo nombre. Es seguro usarlo desde varios hilos.
+ */
+class OutputNamer {
+public:
+    explicit OutputNamer(const fs::path& directory) : directory(directory) {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(directory, ec)) {
+            const std::string name = entry.path().filename().string();
+            // No se sabe con qué extensión se pedirá cada nombre: se registran las dos
+            // lecturas posibles (con su extensión y sin ninguna).
+            const std::string extension = entry.path().extension().string();
+            record(name.substr(0, name.size() - extension.size()), extension);
+            if (!extension.empty()) {
+                record(name, "");
+            }
+        }
+    }
+
+    /**
+     * @brief Reserva el primer nombre libre para `stem` + `extension` y crea el archivo
+     * vacío, que el llamador después sobrescribe.
+     * @return La ruta reservada, o vacía si el archivo no se pudo crear (en `error`).
+     */
+    fs::path claim(const std::string& stem, const std::string& extension, std::string& error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Slot& slot = slots[key(stem, extension)];
+        while (true) {
+            const bool useBase = !slot.baseTaken;
+            const uint64_t suffix = useBase ? 0 : slot.highestSuffix + 1;
+            const fs::path candidate = directory / (useBase ? stem + extension : stem + "-" + std::to_string(suffix) + extension);
+            const int result = createExclusive(candidate);
+            if (useBase) {
+                slot.baseTaken = true;
+            } else {
+                slot.highestSuffix = suffix;
+            }
+            if (result == 0) {
+                return candidate;
+            }
+            if (result != EEXIST) {
+                error = std::strerror(result);
+                return {};
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        bool baseTaken = false;
+        uint64_t highestSuffix = 0;
+    };
+
+    fs::path directory;
+    std::map<std::string, Slot> slots;
+    std::mutex mutex;
+
+    // '/' no puede aparecer en un nombre de archivo, así que separa bien las dos partes.
+    static std::string key(const std::string& stem, const std::string& extension) {
+        return stem + "/" + extension;
+    }
+
+    /**
+     * @brief Anota un nombre existente: como nombre base y, si termina en "-N", como el
+     * sufijo N de su base.
+     */
+    void record(const std::string& stem, const std::string& extension) {
+        slots[key(stem, extension)].baseTaken = true;
+        const size_t dash = stem.rfind('-');
+        if (dash == std::string::npos || dash + 1 == stem.size() || stem.size() - dash > 19) {
+            return;
+        }
+        uint64_t suffix = 0;
+        for (size_t i = dash + 1; i < stem.size(); ++i) {
+            if (stem[i] < '0' || stem[i] > '9') {
+                return;
+            }
+            suffix = suffix * 10 + static_cast<uint64_t>(stem[i] - '0');
+        }
+        Slot& slot = slots[key(stem.substr(0, dash), extension)];
+        slot.highestSuffix = std::max(slot.highestSuffix, suffix);
+    }
+
+    /**
+     * @brief Crea el archivo solo si no existe.
+     * @return 0 si se creó; si no, el código errno (EEXIST si ya existía).
+     */
+    static int createExclusive(const fs::path& path) {
+#if defined(__unix__) || defined(__APPLE__)
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return errno;
+        }
+        ::close(fd);
+#else
+        // El modo "x" de C11 abre con O_EXCL.
+        std::FILE* file = std::fopen(path.string().c_str(), "wbx");
+        if (file == nullptr) {
+            return fs::exists(path) ? EEXIST : errno;
+        }
+        std::fclose(file);
+#endif
+        return 0;
+    }
+};
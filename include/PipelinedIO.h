@@ -0,0 +1,911 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Cipher.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// pread/pwrite solo existen en sistemas POSIX; en Windows se usa el camino de iostream.
+#if defined(__unix__) || defined(__APPLE__)
+#define CRIPTO_POSIX_IO 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define CRIPTO_POSIX_IO 0
+#endif
+
+// io_uring se usa con llamadas al sistema directas, sin depender de liburing.
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define CRIPTO_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#else
+#define CRIPTO_IO_URING 0
+#endif
+
+/**
+ * @brief Cómo se leen y escriben los archivos.
+ */
+enum class IOBackend {
+    Auto,    ///< io_uring si está disponible; si no, hilos con pread/pwrite; si no, Stream.
+    Uring,   ///< io_uring (Linux 5.6 o posterior).
+    Threads, ///< Un hilo lector con pread y uno escritor con pwrite.
+    Stream,  ///< iostream, sin solapar lectura, cifrado y escritura.
+    Mmap     ///< Archivos mapeados en memoria si la salida mide lo mismo que la entrada
+             ///< (XOR, César y Vigenère sin contenedor); si no, como Auto.
+};
+
+/**
+ * @brief Parámetros de la canalización de E/S.
+ */
+struct PipelineOptions {
+    IOBackend backend = IOBackend::Auto;
+    unsigned int depth = 3;       ///< Fragmentos en vuelo (leyéndose, cifrándose o escribiéndose).
+    size_t bufferSize = 1 << 20;  ///< Bytes por fragmento.
+};
+
+/**
+ * @brief Tiempo que cada etapa estuvo ocupada en las ejecuciones acumuladas.
+ */
+struct PipelineStats {
+    IOBackend backend = IOBackend::Stream;
+    double seconds = 0;       ///< Tiempo total.
+    double readBusy = 0;      ///< Con alguna lectura en curso.
+    double transformBusy = 0; ///< Cifrando.
+    double writeBusy = 0;     ///< Con alguna escritura en curso.
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+
+    void add(const PipelineStats& other) {
+        backend = other.backend;
+        seconds += other.seconds;
+        readBusy += other.readBusy;
+        transformBusy += other.transformBusy;
+        writeBusy += other.writeBusy;
+        bytesRead += other.bytesRead;
+        bytesWritten += other.bytesWritten;
+    }
+
+    /**
+     * @brief Resumen de una línea: motor, ocupación de cada etapa y velocidad.
+     */
+    std::string describe() const {
+        auto percent = [this](double busy) {
+            return std::to_string(seconds > 0 ? static_cast<int>(100.0 * busy / seconds + 0.5) : 0) + "%";
+        };
+        const double mbPerSecond = seconds > 0 ? static_cast<double>(bytesRead) / seconds / 1e6 : 0;
+        std::ostringstream text;
+        text.setf(std::ios::fixed);
+        text.precision(1);
+        text << backendName(backend) << ": lectura " << percent(readBusy) << ", cifrado " << percent(transformBusy)
+             << ", escritura " << percent(writeBusy) << ", " << mbPerSecond << " MB/s";
+        return text.str();
+    }
+
+    static const char* backendName(IOBackend backend) {
+        switch (backend) {
+            case IOBackend::Uring: return "io_uring";
+            case IOBackend::Threads: return "hilos pread/pwrite";
+            case IOBackend::Stream: return "iostream";
+            case IOBackend::Mmap: return "mmap";
+            default: return "auto";
+        }
+    }
+};
+
+#if CRIPTO_IO_URING
+/**
+ * @class UringQueue
+ * @brief Cola de io_uring mínima: lecturas y escrituras con desplazamiento y espera de
+ * sus resultados. Solo la usa un hilo.
+ */
+class UringQueue {
+public:
+    UringQueue() = default;
+    UringQueue(const UringQueue&) = delete;
+    UringQueue& operator=(const UringQueue&) = delete;
+
+    ~UringQueue() {
+        if (sqes != nullptr) {
+            munmap(sqes, sqeBytes);
+        }
+        if (cqRing != nullptr && cqRing != sqRing) {
+            munmap(cqRing, cqRingBytes);
+        }
+        if (sqRing != nullptr) {
+            munmap(sqRing, sqRingBytes);
+        }
+        if (ringFd >= 0) {
+            close(ringFd);
+        }
+    }
+
+    /**
+     * @brief Crea la cola para `entries` operaciones a la vez.
+     * @return Falso si el núcleo no tiene io_uring (o no tiene lecturas con
+     * desplazamiento, de Linux 5.6) o no se permite usarlo.
+     */
+    bool open(unsigned int entries) {
+        io_uring_params params{};
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ringFd < 0 || (params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+            return false;
+        }
+        sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+        }
+        sqRing = mapRing(sqRingBytes, IORING_OFF_SQ_RING);
+        cqRing = singleMap ? sqRing : mapRing(cqRingBytes, IORING_OFF_CQ_RING);
+        sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqeMemory = mapRing(sqeBytes, IORING_OFF_SQES);
+        if (sqRing == nullptr || cqRing == nullptr || sqeMemory == nullptr) {
+            return false;
+        }
+        sqes = static_cast<io_uring_sqe*>(sqeMemory);
+
+        auto* sq = static_cast<char*>(sqRing);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqEntries = params.sq_entries;
+        auto* cq = static_cast<char*>(cqRing);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    /**
+     * @brief Prepara una lectura (`write` falso) o escritura; se envía con submit().
+     */
+    void push(bool write, int fd, void* data, size_t size, uint64_t offset, uint64_t userData) {
+        const unsigned tail = *sqTail;
+        const unsigned index = tail & sqMask;
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(data);
+        sqe.len = static_cast<uint32_t>(size);
+        sqe.off = offset;
+        sqe.user_data = userData;
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        pendingSubmit++;
+    }
+
+    /**
+     * @brief Envía lo preparado con push() y, si `wait`, espera al menos un resultado.
+     */
+    bool submit(bool wait) {
+        if (!wait && pendingSubmit == 0) {
+            return true;
+        }
+        while (true) {
+            const unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+            const long submitted = syscall(__NR_io_uring_enter, ringFd, pendingSubmit, wait ? 1u : 0u, flags, nullptr, 0);
+            if (submitted >= 0) {
+                pendingSubmit -= static_cast<unsigned>(submitted);
+                return true;
+            }
+            if (errno != EINTR) {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @brief Saca un resultado terminado, si hay alguno.
+     */
+    bool pop(uint64_t& userData, int& result) {
+        const unsigned head = *cqHead;
+        if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+        const io_uring_cqe& cqe = cqes[head & cqMask];
+        userData = cqe.user_data;
+        result = cqe.res;
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    unsigned int capacity() const {
+        return sqEntries;
+    }
+
+private:
+    int ringFd = -1;
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqRingBytes = 0;
+    size_t cqRingBytes = 0;
+    size_t sqeBytes = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+    unsigned pendingSubmit = 0;
+
+    void* mapRing(size_t bytes, off_t offset) const {
+        void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, offset);
+        return memory == MAP_FAILED ? nullptr : memory;
+    }
+};
+#endif
+
+/**
+ * @class FilePipeline
+ * @brief Cifra un archivo solapando la lectura del fragmento N+1, el cifrado del N y la
+ * escritura del N-1, con `depth` buffers que circulan entre las tres etapas.
+ *
+ * Con io_uring un solo hilo envía las lecturas y escrituras al núcleo y cifra mientras
+ * se completan; sin io_uring un hilo lee con pread y otro escribe con pwrite. Los
+ * buffers (y la cola de io_uring) se reservan con el primer archivo y se reutilizan, así
+ * que conviene un objeto por hilo del lote.
+ */
+class FilePipeline {
+public:
+    FilePipeline() = default;
+    FilePipeline(const FilePipeline&) = delete;
+    FilePipeline& operator=(const FilePipeline&) = delete;
+    FilePipeline(FilePipeline&&) = default;
+    FilePipeline& operator=(FilePipeline&&) = default;
+
+    /**
+     * @brief Cambia los parámetros; se aplican en el siguiente archivo.
+     */
+    void configure(const PipelineOptions& newOptions) {
+        options = newOptions;
+        options.depth = std::max(2u, options.depth);
+        options.bufferSize = std::max<size_t>(4096, options.bufferSize / 8 * 8);
+        resolved = false;
+    }
+
+    /**
+     * @brief Verdadero si se usará pread/pwrite o io_uring (y no iostream).
+     */
+    bool enabled() {
+        return backend() != IOBackend::Stream;
+    }
+
+    /**
+     * @brief El motor que se usa de verdad: `Auto` o `Uring` pasan a `Threads` si io_uring
+     * no está disponible.
+     */
+    IOBackend backend() {
+        if (!resolved) {
+            resolved = true;
+            active = CRIPTO_POSIX_IO ? options.backend : IOBackend::Stream;
+#if CRIPTO_IO_URING
+            if (active == IOBackend::Auto || active == IOBackend::Uring || active == IOBackend::Mmap) {
+                ring = std::make_unique<UringQueue>();
+                active = ring->open(2 * options.depth) ? IOBackend::Uring : IOBackend::Threads;
+                if (active != IOBackend::Uring) {
+                    ring.reset();
+                }
+            }
+#else
+            if (active == IOBackend::Auto || active == IOBackend::Uring || active == IOBackend::Mmap) {
+                active = IOBackend::Threads;
+            }
+#endif
+        }
+        return active;
+    }
+
+    /**
+     * @brief Verdadero si se pidió mapear los archivos (runMapped() y runInPlace()).
+     */
+    bool mappedIO() const {
+        return CRIPTO_POSIX_IO && options.backend == IOBackend::Mmap;
+    }
+
+    /**
+     * @brief Estadísticas acumuladas desde el último resetStats().
+     */
+    const PipelineStats& stats() const {
+        return totals;
+    }
+
+    void resetStats() {
+        totals = PipelineStats{};
+    }
+
+#if CRIPTO_POSIX_IO
+    /**
+     * @brief Cifra `inputFd` en `outputFd` (los dos desde el principio) con un
+     * codificador ya preparado, y escribe al final lo que devuelva finish().
+     * @param error Recibe la descripción del fallo de lectura o escritura.
+     */
+    template <Cipher C>
+    bool run(int inputFd, int outputFd, C& cipher, std::string& error) {
+        for (Slot& slot : slots) {
+            slot.reset();
+        }
+        slots.resize(options.depth);
+        for (Slot& slot : slots) {
+            slot.input.resize(options.bufferSize);
+            if constexpr (!InPlaceCipher<C>) {
+                slot.output.resize(std::max(slot.output.size(), cipher.outputBound(options.bufferSize)));
+            }
+        }
+
+        PipelineStats current;
+        current.backend = backend();
+        const auto start = Clock::now();
+        uint64_t outputOffset = 0;
+        bool ok = (current.backend == IOBackend::Uring) ? runUring(inputFd, outputFd, cipher, current, outputOffset, error)
+                                                    : runThreads(inputFd, outputFd, cipher, current, outputOffset, error);
+        if (ok) {
+            // El final (padding de DES, índice de un contenedor) se escribe sin solapar.
+            CRIPTO_TRACE_SCOPE(tailScope, "finalizar", "pwrite");
+            tail.resize(std::max(tail.size(), cipher.outputBound(0)));
+            std::span<std::byte> tailSpan(tail);
+            const size_t produced = cipher.finish(tailSpan);
+            CRIPTO_TRACE_BYTES(tailScope, produced);
+            const auto writeStart = Clock::now();
+            ok = writeFully(outputFd, tail.data(), produced, outputOffset, error);
+            current.writeBusy += seconds(writeStart, Clock::now());
+            current.bytesWritten += produced;
+        }
+        current.seconds = seconds(start, Clock::now());
+        totals.add(current);
+        return ok;
+    }
+
+    /**
+     * @brief Cifra `inputFd` en `outputFd` sin copias: los dos archivos se mapean en
+     * memoria y el codificador escribe directamente de un mapeo al otro. La salida se
+     * dimensiona antes con el tamaño de la entrada y las ventanas ya procesadas se
+     * sueltan, así que la memoria residente no crece con el archivo.
+     * @param outputFd Abierto para lectura y escritura (lo exige el mapeo).
+     */
+    template <InPlaceCipher C>
+    bool runMapped(int inputFd, int outputFd, C& cipher, std::string& error) {
+        const auto start = Clock::now();
+        struct stat info{};
+        if (fstat(inputFd, &info) != 0 || ftruncate(outputFd, info.st_size) != 0) {
+            error = std::strerror(errno);
+            return false;
+        }
+        const size_t size = static_cast<size_t>(info.st_size);
+#if defined(__linux__)
+        // Reserva los bloques: sin espacio falla aquí y no a mitad del archivo (SIGBUS).
+        if (size > 0 && posix_fallocate(outputFd, 0, info.st_size) == ENOSPC) {
+            error = std::strerror(ENOSPC);
+            return false;
+        }
+#endif
+        Mapping input, output;
+        if (size > 0 && (!input.map(inputFd, size, false) || !output.map(outputFd, size, true))) {
+            error = std::strerror(errno);
+            return false;
+        }
+        forEachWindow(size, [&](size_t offset, size_t length) {
+            CRIPTO_TRACE_SCOPE(transformScope, "cifrar", "mmap");
+            CRIPTO_TRACE_BYTES(transformScope, length);
+            cipher.transform(std::span<const std::byte>(input.bytes() + offset, length), std::span<std::byte>(output.bytes() + offset, length));
+            input.release(offset, length);
+            output.release(offset, length);
+        });
+        return finishMapped(outputFd, size, cipher, start, error);
+    }
+
+    /**
+     * @brief Cifra un archivo sobre sí mismo a través de un mapeo de escritura.
+     * @param fd Abierto para lectura y escritura.
+     */
+    template <InPlaceCipher C>
+    bool runInPlace(int fd, C& cipher, std::string& error) {
+        const auto start = Clock::now();
+        struct stat info{};
+        if (fstat(fd, &info) != 0) {
+            error = std::strerror(errno);
+            return false;
+        }
+        const size_t size = static_cast<size_t>(info.st_size);
+        Mapping data;
+        if (size > 0 && !data.map(fd, size, true)) {
+            error = std::strerror(errno);
+            return false;
+        }
+        forEachWindow(size, [&](size_t offset, size_t length) {
+            CRIPTO_TRACE_SCOPE(transformScope, "cifrar", "mmap");
+            CRIPTO_TRACE_BYTES(transformScope, length);
+            cipher.transformInPlace(std::span<std::byte>(data.bytes() + offset, length));
+            data.release(offset, length);
+        });
+        return finishMapped(fd, size, cipher, start, error);
+    }
+#endif
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Un buffer de la canalización y el fragmento que lleva.
+     */
+    struct Slot {
+        enum class State { Free, Reading, Ready, Writing };
+        std::vector<std::byte> input;
+        std::vector<std::byte> output;
+        State state = State::Free;
+        uint64_t chunk = 0;          ///< Número de fragmento.
+        uint64_t readOffset = 0;
+        size_t filled = 0;           ///< Bytes leídos.
+        bool endOfFile = false;      ///< La lectura terminó antes de llenar el buffer.
+        std::byte* writeData = nullptr;
+        size_t writeSize = 0;
+        size_t written = 0;
+        uint64_t writeOffset = 0;
+
+        void reset() {
+            state = State::Free;
+            filled = 0;
+            written = 0;
+            endOfFile = false;
+        }
+    };
+
+    PipelineOptions options;
+    bool resolved = false;
+    IOBackend active = IOBackend::Stream;
+    std::vector<Slot> slots;
+    std::vector<std::byte> tail;
+    PipelineStats totals;
+#if CRIPTO_IO_URING
+    std::unique_ptr<UringQueue> ring;
+#endif
+
+    static double seconds(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double>(to - from).count();
+    }
+
+#if CRIPTO_POSIX_IO
+    // Bytes que se cifran antes de soltar las páginas ya procesadas de los mapeos.
+    static constexpr size_t MAP_WINDOW = 4 << 20;
+
+    /**
+     * @brief Un archivo completo mapeado en memoria; se desmapea al destruirse.
+     */
+    class Mapping {
+    public:
+        Mapping() = default;
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+
+        ~Mapping() {
+            if (data != nullptr) {
+                munmap(data, size);
+            }
+        }
+
+        bool map(int fd, size_t bytes, bool writable) {
+            void* memory = mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+            if (memory == MAP_FAILED) {
+                return false;
+            }
+            data = memory;
+            size = bytes;
+            madvise(data, size, MADV_SEQUENTIAL);
+            return true;
+        }
+
+        std::byte* bytes() const {
+            return static_cast<std::byte*>(data);
+        }
+
+        /**
+         * @brief Suelta las páginas de una ventana ya procesada. Los cambios no se
+         * pierden: en un mapeo compartido siguen en la caché del sistema de archivos.
+         */
+        void release(size_t offset, size_t length) const {
+            if (data != nullptr) {
+                msync(bytes() + offset, length, MS_ASYNC);
+                madvise(bytes() + offset, length, MADV_DONTNEED);
+            }
+        }
+
+    private:
+        void* data = nullptr;
+        size_t size = 0;
+    };
+
+    template <typename Body>
+    static void forEachWindow(size_t size, Body&& body) {
+        for (size_t offset = 0; offset < size; offset += MAP_WINDOW) {
+            body(offset, std::min(MAP_WINDOW, size - offset));
+        }
+    }
+
+    /**
+     * @brief Termina un cifrado mapeado (los codificadores en el sitio no suelen dejar
+     * nada para finish()) y anota sus estadísticas.
+     */
+    template <Cipher C>
+    bool finishMapped(int outputFd, size_t size, C& cipher, Clock::time_point start, std::string& error) {
+        tail.resize(std::max(tail.size(), cipher.outputBound(0)));
+        const size_t produced = cipher.finish(std::span<std::byte>(tail));
+        const bool ok = writeFully(outputFd, tail.data(), produced, size, error);
+
+        PipelineStats current;
+        current.backend = IOBackend::Mmap;
+        current.seconds = seconds(start, Clock::now());
+        current.transformBusy = current.seconds;
+        current.bytesRead = size;
+        current.bytesWritten = size + produced;
+        totals.add(current);
+        return ok;
+    }
+#endif
+
+    /**
+     * @brief Cifra el fragmento leído en `slot` y deja en él lo que hay que escribir.
+     */
+    template <Cipher C>
+    static void transformSlot(Slot& slot, C& cipher) {
+        std::span<std::byte> chunk(slot.input.data(), slot.filled);
+        if constexpr (InPlaceCipher<C>) {
+            cipher.transformInPlace(chunk);
+            slot.writeData = chunk.data();
+            slot.writeSize = chunk.size();
+        } else {
+            slot.writeSize = cipher.transform(chunk, slot.output);
+            slot.writeData = slot.output.data();
+        }
+        slot.written = 0;
+    }
+
+#if CRIPTO_POSIX_IO
+    static bool writeFully(int fd, const std::byte* data, size_t size, uint64_t offset, std::string& error) {
+        while (size > 0) {
+            const ssize_t result = pwrite(fd, data, size, static_cast<off_t>(offset));
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result <= 0) {
+                error = std::strerror(result < 0 ? errno : EIO);
+                return false;
+            }
+            data += result;
+            size -= static_cast<size_t>(result);
+            offset += static_cast<uint64_t>(result);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Lee hasta llenar el buffer o llegar al final del archivo.
+     */
+    static bool readFully(int fd, std::byte* data, size_t size, uint64_t offset, size_t& filled, std::string& error) {
+        filled = 0;
+        while (filled < size) {
+            const ssize_t result = pread(fd, data + filled, size - filled, static_cast<off_t>(offset + filled));
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result < 0) {
+                error = std::strerror(errno);
+                return false;
+            }
+            if (result == 0) {
+                break;
+            }
+            filled += static_cast<size_t>(result);
+        }
+        return true;
+    }
+
+    // Índice que le indica al escritor que no vendrán más buffers.
+    static constexpr size_t END_OF_STREAM = SIZE_MAX;
+
+    /**
+     * @brief Cola bloqueante de índices de buffers entre dos hilos.
+     */
+    class SlotQueue {
+    public:
+        void push(size_t slot) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                items.push_back(slot);
+            }
+            ready.notify_one();
+        }
+
+        /**
+         * @brief Espera un buffer; falso si la cola se cerró (por un error).
+         */
+        bool pop(size_t& slot) {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return closed || !items.empty(); });
+            if (items.empty()) {
+                return false;
+            }
+            slot = items.front();
+            items.pop_front();
+            return true;
+        }
+
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closed = true;
+            }
+            ready.notify_all();
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<size_t> items;
+        bool closed = false;
+    };
+
+    /**
+     * @brief Motor con hilos: lector (pread) -> este hilo (cifrado) -> escritor (pwrite).
+     * Los buffers vuelven al lector cuando se han escrito.
+     */
+    template <Cipher C>
+    bool runThreads(int inputFd, int outputFd, C& cipher, PipelineStats& run, uint64_t& outputOffset, std::string& error) {
+        SlotQueue freeSlots, readSlots, writeSlots;
+        for (size_t i = 0; i < slots.size(); ++i) {
+            freeSlots.push(i);
+        }
+        std::atomic<bool> failed{false};
+        std::string readError, writeError;
+        double readBusy = 0, writeBusy = 0;
+        auto abort = [&] {
+            failed = true;
+            freeSlots.close();
+            readSlots.close();
+            writeSlots.close();
+        };
+
+        std::thread reader([&] {
+            uint64_t offset = 0;
+            size_t index = 0;
+            while (freeSlots.pop(index)) {
+                Slot& slot = slots[index];
+                const auto readStart = Clock::now();
+                bool ok;
+                {
+                    CRIPTO_TRACE_SCOPE(readScope, "leer", "pread");
+                    ok = readFully(inputFd, slot.input.data(), slot.input.size(), offset, slot.filled, readError);
+                    CRIPTO_TRACE_BYTES(readScope, slot.filled);
+                }
+                readBusy += seconds(readStart, Clock::now());
+                if (!ok) {
+                    abort();
+                    return;
+                }
+                offset += slot.filled;
+                slot.endOfFile = slot.filled < slot.input.size();
+                readSlots.push(index);
+                if (slot.endOfFile) {
+                    return;
+                }
+            }
+        });
+        std::thread writer([&] {
+            uint64_t offset = 0;
+            size_t index = 0;
+            while (writeSlots.pop(index) && index != END_OF_STREAM) {
+                Slot& slot = slots[index];
+                const auto writeStart = Clock::now();
+                bool ok;
+                {
+                    CRIPTO_TRACE_SCOPE(writeScope, "escribir", "pwrite");
+                    ok = writeFully(outputFd, slot.writeData, slot.writeSize, offset, writeError);
+                    CRIPTO_TRACE_BYTES(writeScope, slot.writeSize);
+                }
+                writeBusy += seconds(writeStart, Clock::now());
+                if (!ok) {
+                    abort();
+                    return;
+                }
+                offset += slot.writeSize;
+                freeSlots.push(index);
+            }
+        });
+
+        size_t index = 0;
+        bool endOfFile = false;
+        while (!endOfFile && readSlots.pop(index)) {
+            Slot& slot = slots[index];
+            endOfFile = slot.endOfFile;
+            run.bytesRead += slot.filled;
+            const auto transformStart = Clock::now();
+            {
+                CRIPTO_TRACE_SCOPE(transformScope, "cifrar", "hilos");
+                transformSlot(slot, cipher);
+                CRIPTO_TRACE_BYTES(transformScope, slot.filled);
+            }
+            run.transformBusy += seconds(transformStart, Clock::now());
+            run.bytesWritten += slot.writeSize;
+            outputOffset += slot.writeSize;
+            writeSlots.push(index);
+        }
+        writeSlots.push(END_OF_STREAM);
+        reader.join();
+        writer.join();
+        run.readBusy += readBusy;
+        run.writeBusy += writeBusy;
+        if (failed) {
+            error = !readError.empty() ? "lectura: " + readError : "escritura: " + writeError;
+            return false;
+        }
+        return true;
+    }
+#endif
+
+#if CRIPTO_IO_URING
+    /**
+     * @brief Motor con io_uring: se mantienen lecturas adelantadas en todos los buffers
+     * libres y, en orden, cada fragmento leído se cifra y se envía a escribir.
+     */
+    template <Cipher C>
+    bool runUring(int inputFd, int outputFd, C& cipher, PipelineStats& run, uint64_t& outputOffset, std::string& error) {
+        uint64_t nextReadChunk = 0;
+        uint64_t nextTransformChunk = 0;
+        bool endOfFile = false;
+        unsigned readsInFlight = 0;
+        unsigned writesInFlight = 0;
+        auto lastEvent = Clock::now();
+
+        // Ocupación de las etapas: tiempo con alguna operación en curso.
+        auto account = [&] {
+            const auto now = Clock::now();
+            const double elapsed = seconds(lastEvent, now);
+            if (readsInFlight > 0) {
+                run.readBusy += elapsed;
+            }
+            if (writesInFlight > 0) {
+                run.writeBusy += elapsed;
+            }
+            lastEvent = now;
+        };
+        auto submitRead = [&](size_t index) {
+            Slot& slot = slots[index];
+            ring->push(false, inputFd, slot.input.data() + slot.filled, slot.input.size() - slot.filled,
+                       slot.readOffset + slot.filled, index);
+        };
+        auto submitWrite = [&](size_t index) {
+            Slot& slot = slots[index];
+            ring->push(true, outputFd, slot.writeData + slot.written, slot.writeSize - slot.written,
+                       slot.writeOffset + slot.written, index);
+        };
+        auto failWith = [&](int code) {
+            error = std::strerror(code);
+            // Se esperan las operaciones pendientes: usan buffers de este objeto.
+            while (readsInFlight + writesInFlight > 0 && ring->submit(true)) {
+                uint64_t userData;
+                int result;
+                while (ring->pop(userData, result)) {
+                    (slots[userData].state == Slot::State::Reading ? readsInFlight : writesInFlight)--;
+                    slots[userData].state = Slot::State::Free;
+                }
+            }
+            return false;
+        };
+
+        while (true) {
+            // Lecturas adelantadas en los buffers libres.
+            for (size_t i = 0; i < slots.size() && !endOfFile; ++i) {
+                Slot& slot = slots[i];
+                if (slot.state == Slot::State::Free) {
+                    slot.state = Slot::State::Reading;
+                    slot.chunk = nextReadChunk;
+                    slot.readOffset = nextReadChunk * options.bufferSize;
+                    slot.filled = 0;
+                    slot.endOfFile = false;
+                    nextReadChunk++;
+                    account();
+                    readsInFlight++;
+                    submitRead(i);
+                }
+            }
+            if (!ring->submit(false)) {
+                return failWith(errno);
+            }
+
+            // El siguiente fragmento en orden, si ya se leyó.
+            auto ready = std::find_if(slots.begin(), slots.end(), [&](const Slot& slot) {
+                return slot.state == Slot::State::Ready && slot.chunk == nextTransformChunk;
+            });
+            if (ready != slots.end() && !endOfFile) {
+                Slot& slot = *ready;
+                run.bytesRead += slot.filled;
+                const auto transformStart = Clock::now();
+                {
+                    CRIPTO_TRACE_SCOPE(transformScope, "cifrar", "io_uring");
+                    transformSlot(slot, cipher);
+                    CRIPTO_TRACE_BYTES(transformScope, slot.filled);
+                }
+                run.transformBusy += seconds(transformStart, Clock::now());
+                endOfFile = slot.endOfFile;
+                nextTransformChunk++;
+                slot.writeOffset = outputOffset;
+                outputOffset += slot.writeSize;
+                run.bytesWritten += slot.writeSize;
+                if (slot.writeSize == 0) {
+                    slot.state = Slot::State::Free;
+                } else {
+                    slot.state = Slot::State::Writing;
+                    account();
+                    writesInFlight++;
+                    submitWrite(static_cast<size_t>(ready - slots.begin()));
+                }
+                continue;
+            }
+
+            if (readsInFlight + writesInFlight == 0) {
+                break;
+            }
+            if (!ring->submit(true)) {
+                return failWith(errno);
+            }
+            uint64_t userData;
+            int result;
+            while (ring->pop(userData, result)) {
+                Slot& slot = slots[userData];
+                account();
+                if (result < 0) {
+                    (slot.state == Slot::State::Reading ? readsInFlight : writesInFlight)--;
+                    slot.state = Slot::State::Free;
+                    return failWith(-result);
+                }
+                if (slot.state == Slot::State::Reading) {
+                    slot.filled += static_cast<size_t>(result);
+                    if (result > 0 && slot.filled < slot.input.size()) {
+                        submitRead(userData); // Lectura parcial: se pide el resto.
+                        continue;
+                    }
+                    readsInFlight--;
+                    slot.endOfFile = slot.filled < slot.input.size();
+                    // Las lecturas adelantadas más allá del final se descartan.
+                    slot.state = endOfFile ? Slot::State::Free : Slot::State::Ready;
+                } else {
+                    slot.written += static_cast<size_t>(result);
+                    if (result == 0) {
+                        writesInFlight--;
+                        return failWith(EIO);
+                    }
+                    if (slot.written < slot.writeSize) {
+                        submitWrite(userData);
+                        continue;
+                    }
+                    writesInFlight--;
+                    slot.state = Slot::State::Free;
+                }
+            }
+        }
+        return true;
+    }
+#elif CRIPTO_POSIX_IO
+    template <Cipher C>
+    bool runUring(int inputFd, int outputFd, C& cipher, PipelineStats& run, uint64_t& outputOffset, std::string& error) {
+        return runThreads(inputFd, outputFd, cipher, run, outputOffset, error);
+    }
+#endif
+};
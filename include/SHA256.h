@@ -0,0 +1,149 @@
+﻿#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/**
+ * @class SHA256
+ * @brief Implementación de SHA-256 (FIPS 180-4) por fragmentos.
+ *
+ * Se usa para el valor de comprobación de clave de los contenedores .cif, así que no
+ * necesita ser rápida: los datos que se resumen son de unas decenas de bytes.
+ */
+class SHA256 {
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    SHA256() {
+        reset();
+    }
+
+    /**
+     * @brief Vuelve al estado inicial para resumir otro mensaje.
+     */
+    void reset() {
+        state = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        bufferSize = 0;
+        totalBytes = 0;
+    }
+
+    /**
+     * @brief Añade bytes al mensaje.
+     */
+    void update(const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        totalBytes += size;
+        while (size > 0) {
+            size_t take = std::min(size, buffer.size() - bufferSize);
+            std::memcpy(buffer.data() + bufferSize, bytes, take);
+            bufferSize += take;
+            bytes += take;
+            size -= take;
+            if (bufferSize == buffer.size()) {
+                compress(buffer.data());
+                bufferSize = 0;
+            }
+        }
+    }
+
+    void update(std::string_view data) {
+        update(data.data(), data.size());
+    }
+
+    /**
+     * @brief Termina el mensaje (relleno y longitud) y devuelve el resumen. Después hay
+     * que llamar a reset() para resumir otro.
+     */
+    Digest finish() {
+        const uint64_t totalBits = totalBytes * 8;
+        const uint8_t marker = 0x80;
+        update(&marker, 1);
+        const uint8_t zero = 0;
+        while (bufferSize != 56) {
+            update(&zero, 1);
+        }
+        uint8_t length[8];
+        for (int i = 0; i < 8; ++i) {
+            length[i] = static_cast<uint8_t>(totalBits >> (8 * (7 - i)));
+        }
+        update(length, sizeof(length));
+
+        Digest digest;
+        for (size_t i = 0; i < state.size(); ++i) {
+            for (int j = 0; j < 4; ++j) {
+                digest[i * 4 + j] = static_cast<uint8_t>(state[i] >> (8 * (3 - j)));
+            }
+        }
+        return digest;
+    }
+
+    /**
+     * @brief Resumen de un mensaje completo.
+     */
+    static Digest hash(std::string_view data) {
+        SHA256 sha;
+        sha.update(data);
+        return sha.finish();
+    }
+
+private:
+    std::array<uint32_t, 8> state{};
+    std::array<uint8_t, 64> buffer{};
+    size_t bufferSize = 0;
+    uint64_t totalBytes = 0;
+
+    static constexpr std::array<uint32_t, 64> ROUND_CONSTANTS = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    static constexpr uint32_t rotr(uint32_t value, int bits) {
+        return (value >> bits) | (value << (32 - bits));
+    }
+
+    /**
+     * @brief Procesa un bloque de 64 bytes.
+     */
+    void compress(const uint8_t* block) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (static_cast<uint32_t>(block[i * 4]) << 24) | (static_cast<uint32_t>(block[i * 4 + 1]) << 16) |
+                   (static_cast<uint32_t>(block[i * 4 + 2]) << 8) | block[i * 4 + 3];
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + ROUND_CONSTANTS[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+};
@@ -0,0 +1,227 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+#include <cstdint>
+
+/**
+ * @class ShiftKernel
+ * @brief Núcleos vectorizados de los cifrados César y Vigenère.
+ *
+ * Cada byte se clasifica con comparaciones vectoriales: un byte es letra si
+ * `(c | 0x20) - 'a'` es menor que 26 (sin signo), y dígito si `c - '0'` es menor que 10.
+ * El desplazamiento se aplica sin módulo: como `x + shift` es menor que 2 * 26,
+ * `min(t, t - 26)` sin signo da el resultado ya reducido. Los resultados son
+ * idénticos byte a byte a los de los caminos escalares.
+ */
+class ShiftKernel {
+public:
+    /**
+     * @brief Aplica el desplazamiento César a `size` bytes (`input` puede ser igual a `output`).
+     * @param letterShift Desplazamiento de letras, entre 0 y 25.
+     * @param digitShift Desplazamiento de dígitos, entre 0 y 9.
+     */
+    static void caesar(const char* input, char* output, size_t size, int letterShift, int digitShift) {
+        size_t done = 0;
+#if CRIPTO_X86_SIMD
+        SimdLevel simd = CpuFeatures::level();
+        if (simd >= SimdLevel::AVX2) {
+            done = caesarAVX2(input, output, size, letterShift, digitShift);
+        } else if (simd >= SimdLevel::SSE2) {
+            done = caesarSSE2(input, output, size, letterShift, digitShift);
+        }
+#endif
+        for (size_t i = done; i < size; ++i) {
+            output[i] = caesarChar(input[i], letterShift, digitShift);
+        }
+    }
+
+    /**
+     * @brief Construye el patrón de desplazamientos de Vigenère: la clave normalizada
+     * (solo mayúsculas) convertida a desplazamientos 0..25 y repetida hasta `clave + 16`
+     * bytes, de modo que desde cualquier posición se pueden cargar 16 desplazamientos.
+     * @param normalizedKey La clave normalizada; no debe estar vacía.
+     * @param encrypting Si es falso se guardan los desplazamientos inversos (26 - s) % 26.
+     */
+    static std::string buildVigenerePattern(const std::string& normalizedKey, bool encrypting) {
+        std::string pattern;
+        while (pattern.size() < normalizedKey.size() + 16) {
+            for (char c : normalizedKey) {
+                int shift = c - 'A';
+                pattern += static_cast<char>(encrypting ? shift : (26 - shift) % 26);
+            }
+        }
+        return pattern;
+    }
+
+    /**
+     * @brief Aplica Vigenère a `size` bytes con un patrón de buildVigenerePattern().
+     * @param keyLength Longitud de la clave normalizada.
+     * @param letterCount Número de letras procesadas hasta ahora en el flujo; la letra
+     * siguiente usa la posición `letterCount % keyLength` de la clave. Se actualiza.
+     */
+    static void vigenere(const char* input, char* output, size_t size, const std::string& pattern, size_t keyLength, unsigned int& letterCount) {
+        size_t done = 0;
+#if CRIPTO_X86_SIMD
+        if (CpuFeatures::level() >= SimdLevel::SSSE3) {
+            done = vigenereSSSE3(input, output, size, pattern.data(), keyLength, letterCount);
+        }
+#endif
+        vigenereScalar(input, output, done, size, pattern.data(), keyLength, letterCount);
+    }
+
+private:
+    static char caesarChar(char c, int letterShift, int digitShift) {
+        if (c >= 'A' && c <= 'Z') {
+            return static_cast<char>(((c - 'A' + letterShift) % 26) + 'A');
+        } else if (c >= 'a' && c <= 'z') {
+            return static_cast<char>(((c - 'a' + letterShift) % 26) + 'a');
+        } else if (c >= '0' && c <= '9') {
+            return static_cast<char>(((c - '0' + digitShift) % 10) + '0');
+        }
+        return c;
+    }
+
+    static void vigenereScalar(const char* input, char* output, size_t begin, size_t size, const char* pattern, size_t keyLength, unsigned int& letterCount) {
+        for (size_t i = begin; i < size; ++i) {
+            char c = input[i];
+            int x = (c | 0x20) - 'a';
+            if (x >= 0 && x < 26) {
+                int shifted = (x + pattern[letterCount % keyLength]) % 26;
+                c = static_cast<char>(shifted + ((c & 0x20) | 'A'));
+                letterCount++;
+            }
+            output[i] = c;
+        }
+    }
+
+#if CRIPTO_X86_SIMD
+    __attribute__((target("sse2")))
+    static __m128i shiftRange128(__m128i offset, __m128i inRange, __m128i shift, __m128i modulus, __m128i base, __m128i fallback) {
+        __m128i t = _mm_add_epi8(offset, shift);
+        t = _mm_min_epu8(t, _mm_sub_epi8(t, modulus));
+        __m128i shifted = _mm_add_epi8(t, base);
+        return _mm_or_si128(_mm_and_si128(inRange, shifted), _mm_andnot_si128(inRange, fallback));
+    }
+
+    __attribute__((target("sse2")))
+    static size_t caesarSSE2(const char* input, char* output, size_t size, int letterShift, int digitShift) {
+        const __m128i lowerCaseBit = _mm_set1_epi8(0x20);
+        const __m128i letterBase = _mm_set1_epi8('a');
+        const __m128i digitBase = _mm_set1_epi8('0');
+        const __m128i upperA = _mm_set1_epi8('A');
+        const __m128i maxLetter = _mm_set1_epi8(25);
+        const __m128i maxDigit = _mm_set1_epi8(9);
+        const __m128i letters = _mm_set1_epi8(26);
+        const __m128i digits = _mm_set1_epi8(10);
+        const __m128i lShift = _mm_set1_epi8(static_cast<char>(letterShift));
+        const __m128i dShift = _mm_set1_epi8(static_cast<char>(digitShift));
+
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+
+            __m128i letterOffset = _mm_sub_epi8(_mm_or_si128(v, lowerCaseBit), letterBase);
+            __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letterOffset, maxLetter), letterOffset);
+            __m128i caseBase = _mm_or_si128(_mm_and_si128(v, lowerCaseBit), upperA);
+            __m128i result = shiftRange128(letterOffset, isLetter, lShift, letters, caseBase, v);
+
+            __m128i digitOffset = _mm_sub_epi8(v, digitBase);
+            __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digitOffset, maxDigit), digitOffset);
+            result = shiftRange128(digitOffset, isDigit, dShift, digits, digitBase, result);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), result);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i shiftRange256(__m256i offset, __m256i inRange, __m256i shift, __m256i modulus, __m256i base, __m256i fallback) {
+        __m256i t = _mm256_add_epi8(offset, shift);
+        t = _mm256_min_epu8(t, _mm256_sub_epi8(t, modulus));
+        return _mm256_blendv_epi8(fallback, _mm256_add_epi8(t, base), inRange);
+    }
+
+    __attribute__((target("avx2")))
+    static size_t caesarAVX2(const char* input, char* output, size_t size, int letterShift, int digitShift) {
+        const __m256i lowerCaseBit = _mm256_set1_epi8(0x20);
+        const __m256i letterBase = _mm256_set1_epi8('a');
+        const __m256i digitBase = _mm256_set1_epi8('0');
+        const __m256i upperA = _mm256_set1_epi8('A');
+        const __m256i maxLetter = _mm256_set1_epi8(25);
+        const __m256i maxDigit = _mm256_set1_epi8(9);
+        const __m256i letters = _mm256_set1_epi8(26);
+        const __m256i digits = _mm256_set1_epi8(10);
+        const __m256i lShift = _mm256_set1_epi8(static_cast<char>(letterShift));
+        const __m256i dShift = _mm256_set1_epi8(static_cast<char>(digitShift));
+
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+
+            __m256i letterOffset = _mm256_sub_epi8(_mm256_or_si256(v, lowerCaseBit), letterBase);
+            __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letterOffset, maxLetter), letterOffset);
+            __m256i caseBase = _mm256_or_si256(_mm256_and_si256(v, lowerCaseBit), upperA);
+            __m256i result = shiftRange256(letterOffset, isLetter, lShift, letters, caseBase, v);
+
+            __m256i digitOffset = _mm256_sub_epi8(v, digitBase);
+            __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digitOffset, maxDigit), digitOffset);
+            result = shiftRange256(digitOffset, isDigit, dShift, digits, digitBase, result);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), result);
+        }
+        return i;
+    }
+
+    /**
+     * @brief Vigenère de 16 en 16 bytes. El índice de clave solo avanza con las letras:
+     * una suma prefija de la máscara de letras da, para cada byte, cuántas letras lo
+     * preceden dentro del vector, y `pshufb` usa ese número para elegir su desplazamiento.
+     */
+    __attribute__((target("ssse3,popcnt")))
+    static size_t vigenereSSSE3(const char* input, char* output, size_t size, const char* pattern, size_t keyLength, unsigned int& letterCount) {
+        const __m128i lowerCaseBit = _mm_set1_epi8(0x20);
+        const __m128i letterBase = _mm_set1_epi8('a');
+        const __m128i upperA = _mm_set1_epi8('A');
+        const __m128i maxLetter = _mm_set1_epi8(25);
+        const __m128i letters = _mm_set1_epi8(26);
+        const __m128i one = _mm_set1_epi8(1);
+
+        size_t keyIndex = letterCount % keyLength;
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            if (letterCount > 0xFFFFFFFFu - 16) {
+                // El contador de 32 bits está por desbordarse: este vector va por el camino escalar.
+                vigenereScalar(input, output, i, i + 16, pattern, keyLength, letterCount);
+                keyIndex = letterCount % keyLength;
+                continue;
+            }
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+
+            __m128i letterOffset = _mm_sub_epi8(_mm_or_si128(v, lowerCaseBit), letterBase);
+            __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letterOffset, maxLetter), letterOffset);
+
+            __m128i ones = _mm_and_si128(isLetter, one);
+            __m128i prefix = _mm_add_epi8(ones, _mm_slli_si128(ones, 1));
+            prefix = _mm_add_epi8(prefix, _mm_slli_si128(prefix, 2));
+            prefix = _mm_add_epi8(prefix, _mm_slli_si128(prefix, 4));
+            prefix = _mm_add_epi8(prefix, _mm_slli_si128(prefix, 8));
+            __m128i lettersBefore = _mm_sub_epi8(prefix, ones);
+
+            __m128i keyShifts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern + keyIndex));
+            __m128i shift = _mm_shuffle_epi8(keyShifts, lettersBefore);
+
+            __m128i caseBase = _mm_or_si128(_mm_and_si128(v, lowerCaseBit), upperA);
+            __m128i result = shiftRange128(letterOffset, isLetter, shift, letters, caseBase, v);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), result);
+
+            unsigned int lettersInVector = static_cast<unsigned int>(__builtin_popcount(static_cast<unsigned int>(_mm_movemask_epi8(isLetter))));
+            letterCount += lettersInVector;
+            keyIndex += lettersInVector;
+            if (keyIndex >= keyLength) {
+                keyIndex = (keyLength > 16) ? keyIndex - keyLength : keyIndex % keyLength;
+            }
+        }
+        return i;
+    }
+#endif
+};
@@ -0,0 +1,242 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Las trazas se compilan solo con -DCRIPTO_ENABLE_TRACE=ON en CMake; sin ella las macros
+// CRIPTO_TRACE_* no generan código.
+#ifndef CRIPTO_ENABLE_TRACE
+#define CRIPTO_ENABLE_TRACE 0
+#endif
+
+/**
+ * @class Trace
+ * @brief Registro de tiempos por etapa (--trace) en el formato de eventos de Chrome
+ * (chrome://tracing o Perfetto).
+ *
+ * Cada hilo guarda sus eventos en su propio buffer, sin bloqueos; los buffers solo se
+ * recorren al escribir la traza, con los hilos ya terminados. Mientras no se llama a
+ * start(), cada TraceScope cuesta una lectura atómica.
+ */
+class Trace {
+public:
+    struct Event {
+        const char* name;      ///< Etapa (literal de cadena).
+        const char* category;  ///< Algoritmo o subsistema (literal de cadena).
+        double start;          ///< Microsegundos desde start().
+        double duration;       ///< Microsegundos.
+        uint64_t bytes;        ///< Bytes procesados, o 0 si no aplica.
+    };
+
+    static Trace& instance() {
+        static Trace trace;
+        return trace;
+    }
+
+    bool enabled() const {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Empieza a registrar eventos; los tiempos se cuentan desde aquí.
+     */
+    void start() {
+        origin = Clock::now();
+        active.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Microsegundos desde start().
+     */
+    double now() const {
+        return std::chrono::duration<double, std::micro>(Clock::now() - origin).count();
+    }
+
+    void record(const Event& event) {
+        threadLog().events.push_back(event);
+    }
+
+    /**
+     * @brief Escribe los eventos en formato JSON de Chrome. Los eventos con bytes llevan
+     * además los MB/s.
+     */
+    bool write(const fs::path& path, std::string& error) {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        if (!output.is_open()) {
+            error = "no se pudo crear '" + path.string() + "'";
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        char line[512];
+        for (const auto& log : logs) {
+            for (const Event& event : log->events) {
+                std::snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                              first ? "" : ",\n", event.name, event.category, log->id, event.start, event.duration);
+                output << line;
+                if (event.bytes > 0) {
+                    std::snprintf(line, sizeof(line), ",\"args\":{\"bytes\":%llu,\"MB/s\":%.1f}", static_cast<unsigned long long>(event.bytes),
+                                  megabytesPerSecond(event));
+                    output << line;
+                }
+                output << "}";
+                first = false;
+            }
+        }
+        output << "\n]}\n";
+        if (!output) {
+            error = "no se pudo escribir '" + path.string() + "'";
+            return false;
+        }
+        return true;
+    }
+
+    /// Nombre de la etapa que abarca un archivo entero; su categoría es el algoritmo.
+    static constexpr const char* FILE_STAGE = "archivo";
+
+    /**
+     * @brief Resumen legible: tiempo total por etapa e histograma de MB/s por archivo de
+     * cada algoritmo (intervalos de potencias de 2), a partir de los eventos FILE_STAGE.
+     */
+    void report(std::ostream& out) {
+        struct StageTotal {
+            uint64_t calls = 0;
+            double microseconds = 0;
+            uint64_t bytes = 0;
+        };
+        std::map<std::string, StageTotal> stages;
+        std::map<std::string, std::map<int, uint64_t>> histograms;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& log : logs) {
+            for (const Event& event : log->events) {
+                StageTotal& total = stages[event.name];
+                total.calls++;
+                total.microseconds += event.duration;
+                total.bytes += event.bytes;
+                if (event.bytes > 0 && std::strcmp(event.name, FILE_STAGE) == 0) {
+                    const double rate = megabytesPerSecond(event);
+                    histograms[event.category][rate < 1 ? -1 : static_cast<int>(std::log2(rate))]++;
+                }
+            }
+        }
+
+        char line[160];
+        out << "\n--- Traza por etapa ---\n";
+        for (const auto& [name, total] : stages) {
+            std::snprintf(line, sizeof(line), "  %-18s %8llu llamadas %12.3f ms", name.c_str(), static_cast<unsigned long long>(total.calls),
+                          total.microseconds / 1000.0);
+            out << line;
+            if (total.bytes > 0 && total.microseconds > 0) {
+                std::snprintf(line, sizeof(line), " %12llu bytes %10.1f MB/s", static_cast<unsigned long long>(total.bytes),
+                              static_cast<double>(total.bytes) / total.microseconds);
+                out << line;
+            }
+            out << "\n";
+        }
+        for (const auto& [category, buckets] : histograms) {
+            out << "MB/s por archivo (" << category << "):\n";
+            uint64_t most = 0;
+            for (const auto& [bucket, count] : buckets) {
+                most = std::max(most, count);
+            }
+            for (const auto& [bucket, count] : buckets) {
+                if (bucket < 0) {
+                    std::snprintf(line, sizeof(line), "  %16s ", "< 1");
+                } else {
+                    std::snprintf(line, sizeof(line), "  [%6llu, %6llu) ", 1ULL << bucket, 1ULL << (bucket + 1));
+                }
+                out << line << std::string(static_cast<size_t>(1 + 39 * count / most), '#') << " " << count << "\n";
+            }
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct ThreadLog {
+        unsigned int id = 0;
+        std::vector<Event> events;
+    };
+
+    std::atomic<bool> active{false};
+    Clock::time_point origin = Clock::now();
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadLog>> logs;
+
+    ThreadLog& threadLog() {
+        thread_local ThreadLog* log = nullptr;
+        if (log == nullptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            logs.push_back(std::make_unique<ThreadLog>());
+            log = logs.back().get();
+            log->id = static_cast<unsigned int>(logs.size());
+        }
+        return *log;
+    }
+
+    static double megabytesPerSecond(const Event& event) {
+        // Bytes por microsegundo = MB/s (10^6 bytes por segundo).
+        return event.duration > 0 ? static_cast<double>(event.bytes) / event.duration : 0.0;
+    }
+};
+
+/**
+ * @brief Mide el tiempo de un bloque y lo registra al salir, si la traza está activa.
+ */
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category) : name(name), category(category), enabled(Trace::instance().enabled()) {
+        if (enabled) {
+            start = Trace::instance().now();
+        }
+    }
+
+    ~TraceScope() {
+        if (enabled) {
+            Trace::instance().record({name, category, start, Trace::instance().now() - start, bytes});
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    bool active() const {
+        return enabled;
+    }
+
+    /**
+     * @brief Bytes procesados en el bloque, para los MB/s.
+     */
+    void setBytes(uint64_t value) {
+        bytes = value;
+    }
+
+private:
+    const char* name;
+    const char* category;
+    bool enabled;
+    double start = 0;
+    uint64_t bytes = 0;
+};
+
+#if CRIPTO_ENABLE_TRACE
+#define CRIPTO_TRACE_SCOPE(var, name, category) TraceScope var(name, category)
+// `bytes` solo se evalúa si la traza está activa.
+#define CRIPTO_TRACE_BYTES(var, bytes) \
+    do {                               \
+        if ((var).active()) {          \
+            (var).setBytes(bytes);     \
+        }                              \
+    } while (0)
+#else
+#define CRIPTO_TRACE_SCOPE(var, name, category) ((void)0)
+#define CRIPTO_TRACE_BYTES(var, bytes) ((void)0)
+#endif
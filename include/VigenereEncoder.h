@@ -1,5 +1,10 @@
 ﻿#pragma once
 #include "Prerequisites.h"
+#include "ShiftKernel.h"
+#include "Cipher.h"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
 
 /**
  * @class VigenereEncoder
@@ -28,22 +33,10 @@ public:
             return text;
         }
 
-        std::string result;
-        result.reserve(text.size());
+        std::string result(text.size(), '\0');
+        std::string pattern = ShiftKernel::buildVigenerePattern(key, true);
         unsigned int key_idx = 0;
-
-        for (char c : text) {
-            if (std::isalpha(static_cast<unsigned char>(c))) {
-                bool isLower = std::islower(static_cast<unsigned char>(c));
-                char base = isLower ? 'a' : 'A';
-                int shift = key[key_idx % key.size()] - 'A';
-
-                result += static_cast<char>((c - base + shift) % 26 + base);
-                key_idx++;
-            } else {
-                result += c;
-            }
-        }
+        ShiftKernel::vigenere(text.data(), result.data(), text.size(), pattern, key.size(), key_idx);
         return result;
     }
 
@@ -59,32 +52,135 @@ public:
             return text;
         }
 
-        std::string result;
-        result.reserve(text.size());
+        std::string result(text.size(), '\0');
+        std::string pattern = ShiftKernel::buildVigenerePattern(key, false);
         unsigned int key_idx = 0;
+        ShiftKernel::vigenere(text.data(), result.data(), text.size(), pattern, key.size(), key_idx);
+        return result;
+    }
 
-        for (char c : text) {
-            if (std::isalpha(static_cast<unsigned char>(c))) {
-                bool isLower = std::islower(static_cast<unsigned char>(c));
-                char base = isLower ? 'a' : 'A';
-                int shift = key[key_idx % key.size()] - 'A';
-
-                result += static_cast<char>(((c - base) - shift + 26) % 26 + base);
-                key_idx++;
-            } else {
-                result += c;
-            }
+    // --- PROCESAMIENTO POR BLOQUES (STREAMING) ---
+
+    /**
+     * @brief Prepara el codificador para procesar un flujo de datos por fragmentos.
+     * @param rawKey La clave de cifrado. Solo se usarán los caracteres alfabéticos.
+     * @param encrypting Verdadero para codificar, falso para decodificar.
+     */
+    void beginStream(const std::string& rawKey, bool encrypting) {
+        std::string key = normalizeKey(rawKey);
+        streamKeyLength = key.size();
+        streamPattern = key.empty() ? std::string() : ShiftKernel::buildVigenerePattern(key, encrypting);
+        restart();
+    }
+
+    /**
+     * @brief La clave tal como la usa Vigenère (solo sus letras, en mayúsculas), para el
+     * valor de comprobación de un contenedor.
+     */
+    static std::string keyCheckMaterial(const std::string& key) {
+        return normalizeKey(key);
+    }
+
+    /**
+     * @brief Empieza un flujo nuevo con la misma clave (vuelve a la primera letra de la clave).
+     */
+    void restart() {
+        streamKeyIdx = 0;
+        streamLetters = 0;
+    }
+
+    /**
+     * @brief Estado para el índice de un contenedor: las letras procesadas desde el inicio
+     * del flujo. No se deduce de la posición en el archivo, porque la clave solo avanza
+     * con las letras; y no se guarda la letra de la clave, que revelaría su longitud.
+     */
+    uint64_t chunkState() const {
+        return streamLetters;
+    }
+
+    /**
+     * @brief Continúa el flujo tras el número de letras guardado con chunkState().
+     * El contador del núcleo es de 32 bits y da la vuelta: la letra `n` del flujo usa la
+     * posición `(n mod 2^32) % longitud` de la clave, así que se trunca igual y no se
+     * reduce con la longitud de la clave.
+     */
+    void seekChunk(uint64_t state, bool finalChunk) {
+        (void)finalChunk;
+        streamLetters = state;
+        streamKeyIdx = static_cast<unsigned int>(state);
+    }
+
+    /**
+     * @brief Vigenère no cambia la longitud: la salida de un fragmento mide lo mismo que la entrada.
+     */
+    size_t outputBound(size_t inputSize) const {
+        return inputSize;
+    }
+
+    /**
+     * @brief Procesa el siguiente fragmento del flujo. El índice de la clave continúa
+     * donde quedó el fragmento anterior (solo avanza con las letras).
+     * @param input El fragmento de entrada.
+     * @param output Destino, de al menos `input.size()` bytes.
+     * @return Bytes escritos (siempre `input.size()`).
+     */
+    size_t transform(std::span<const std::byte> input, std::span<std::byte> output) {
+        const char* in = reinterpret_cast<const char*>(input.data());
+        char* out = reinterpret_cast<char*>(output.data());
+        if (streamKeyLength == 0) {
+            std::memmove(out, in, input.size());
+        } else {
+            advance(in, out, input.size());
         }
-        return result;
+        return input.size();
+    }
+
+    /**
+     * @brief Variante en el sitio de transform(): transforma el buffer sin copiarlo.
+     */
+    void transformInPlace(std::span<std::byte> data) {
+        if (streamKeyLength == 0) {
+            return;
+        }
+        char* bytes = reinterpret_cast<char*>(data.data());
+        advance(bytes, bytes, data.size());
+    }
+
+    /**
+     * @brief Termina el flujo. Vigenère no retiene datos, así que no produce salida.
+     */
+    size_t finish(std::span<std::byte> output) {
+        (void)output;
+        return 0;
     }
 
 private:
+    std::string streamPattern;
+    size_t streamKeyLength = 0;
+    unsigned int streamKeyIdx = 0;
+    uint64_t streamLetters = 0;
+
+    /**
+     * @brief Aplica la clave del flujo y suma las letras procesadas. El contador del
+     * núcleo es de 32 bits: se avanza en tramos de menos de 2^32 bytes para que la resta
+     * sin signo dé siempre las letras del tramo.
+     */
+    void advance(const char* input, char* output, size_t size) {
+        constexpr size_t MAX_PIECE = size_t(1) << 31;
+        for (size_t done = 0; done < size; done += MAX_PIECE) {
+            const size_t piece = std::min(MAX_PIECE, size - done);
+            const unsigned int before = streamKeyIdx;
+            ShiftKernel::vigenere(input + done, output + done, piece, streamPattern, streamKeyLength, streamKeyIdx);
+            streamLetters += streamKeyIdx - before;
+        }
+    }
+
     /**
      * @brief Normaliza una clave para que contenga solo letras mayúsculas.
      * @param rawKey La clave original.
      * @return La clave normalizada.
      */
-    std::string normalizeKey(const std::string& rawKey) {
+    static std::string normalizeKey(const std::string& rawKey) {
         std::string k;
         for (char c : rawKey) {
             if (std::isalpha(static_cast<unsigned char>(c))) {
@@ -93,4 +189,6 @@ private:
         }
         return k;
     }
-};
\ No newline at end of file
+};
+
+static_assert(InPlaceCipher<VigenereEncoder> && ChunkedCipher<VigenereEncoder>);
@@ -3,6 +3,10 @@
 
 #pragma once
 #include "Prerequisites.h"
+#include "XORKernel.h"
+#include "Cipher.h"
+#include <cstring>
+#include <string_view>
 
 class XOREncoder {
 public:
@@ -23,9 +27,109 @@ public:
             return input;
         }
         std::string output = input;
-        for (size_t i = 0; i < input.size(); ++i) {
-            output[i] = input[i] ^ key[i % key.length()];
-        }
+        std::string pattern = XORKernel::buildPattern(key);
+        size_t keyPos = 0;
+        XORKernel::apply(output.data(), output.data(), output.size(), pattern, key.size(), keyPos);
         return output;
     }
+
+    // --- PROCESAMIENTO POR BLOQUES (STREAMING) ---
+
+    /**
+     * @brief Prepara el codificador para procesar un flujo de datos por fragmentos.
+     * @param key La contraseña para la operación.
+     * @param encrypting Se ignora: XOR es simétrico. Existe para uniformar la interfaz.
+     */
+    void beginStream(const std::string& key, bool encrypting = true) {
+        (void)encrypting;
+        keyLength = key.size();
+        keyPattern = key.empty() ? std::string() : XORKernel::buildPattern(key);
+        restart();
+    }
+
+    /**
+     * @brief La clave tal como la usa XOR (completa), para el valor de comprobación de
+     * un contenedor.
+     */
+    static std::string keyCheckMaterial(const std::string& key) {
+        return key;
+    }
+
+    /**
+     * @brief Empieza un flujo nuevo con la misma clave (vuelve al inicio de la clave).
+     */
+    void restart() {
+        keyPosition = 0;
+        streamOffset = 0;
+    }
+
+    /**
+     * @brief Estado para el índice de un contenedor: los bytes procesados desde el inicio
+     * del flujo. La posición dentro de la clave no se guarda: revelaría su longitud.
+     */
+    uint64_t chunkState() const {
+        return streamOffset;
+    }
+
+    /**
+     * @brief Continúa el flujo en el byte guardado con chunkState().
+     */
+    void seekChunk(uint64_t state, bool finalChunk) {
+        (void)finalChunk;
+        streamOffset = state;
+        keyPosition = keyLength == 0 ? 0 : static_cast<size_t>(state % keyLength);
+    }
+
+    /**
+     * @brief XOR no cambia la longitud: la salida de un fragmento mide lo mismo que la entrada.
+     */
+    size_t outputBound(size_t inputSize) const {
+        return inputSize;
+    }
+
+    /**
+     * @brief Procesa el siguiente fragmento del flujo, continuando la posición de la clave.
+     * @param input El fragmento de entrada.
+     * @param output Destino, de al menos `input.size()` bytes.
+     * @return Bytes escritos (siempre `input.size()`).
+     */
+    size_t transform(std::span<const std::byte> input, std::span<std::byte> output) {
+        const char* in = reinterpret_cast<const char*>(input.data());
+        char* out = reinterpret_cast<char*>(output.data());
+        if (keyLength == 0) {
+            std::memmove(out, in, input.size());
+        } else {
+            XORKernel::apply(in, out, input.size(), keyPattern, keyLength, keyPosition);
+        }
+        streamOffset += input.size();
+        return input.size();
+    }
+
+    /**
+     * @brief Variante en el sitio de transform(): transforma el buffer sin copiarlo.
+     */
+    void transformInPlace(std::span<std::byte> data) {
+        streamOffset += data.size();
+        if (keyLength == 0) {
+            return;
+        }
+        char* bytes = reinterpret_cast<char*>(data.data());
+        XORKernel::apply(bytes, bytes, data.size(), keyPattern, keyLength, keyPosition);
+    }
+
+    /**
+     * @brief Termina el flujo. XOR no retiene datos, así que no produce salida.
+     */
+    size_t finish(std::span<std::byte> output) {
+        (void)output;
+        return 0;
+    }
+
+private:
+    std::string keyPattern;
+    size_t keyLength = 0;
+    size_t keyPosition = 0;
+    uint64_t streamOffset = 0;
 };
+
+static_assert(InPlaceCipher<XOREncoder> && ChunkedCipher<XOREncoder>);
@@ -0,0 +1,134 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "CpuFeatures.h"
+#include <cstdint>
+
+/**
+ * @class XORKernel
+ * @brief Núcleo de XOR con clave repetida, vectorizado y con selección en tiempo de ejecución.
+ *
+ * La clave se repite una sola vez en un "patrón" de longitud `clave + 64`, de modo que
+ * desde cualquier posición de la clave se puede cargar un registro completo (hasta 64
+ * bytes con AVX-512) sin calcular un módulo por byte. Tras cada registro la posición
+ * avanza `ancho % longitud_clave`, con una sola resta condicional.
+ */
+class XORKernel {
+public:
+    /**
+     * @brief Construye el patrón de clave repetida que usan los núcleos.
+     * @param key La clave; no debe estar vacía.
+     */
+    static std::string buildPattern(const std::string& key) {
+        std::string pattern;
+        pattern.reserve(key.size() + MAX_VECTOR_WIDTH);
+        while (pattern.size() < key.size() + MAX_VECTOR_WIDTH) {
+            pattern += key;
+        }
+        return pattern;
+    }
+
+    /**
+     * @brief Aplica XOR a `size` bytes. `input` y `output` pueden ser el mismo puntero
+     * para transformar en el sitio.
+     * @param pattern Patrón creado con buildPattern().
+     * @param keyLength Longitud de la clave original.
+     * @param keyPosition Posición actual dentro de la clave; se actualiza al terminar.
+     */
+    static void apply(const char* input, char* output, size_t size, const std::string& pattern, size_t keyLength, size_t& keyPosition) {
+        switch (CpuFeatures::level()) {
+#if CRIPTO_X86_SIMD
+            case SimdLevel::AVX512:
+                applyAVX512(input, output, size, pattern.data(), keyLength, keyPosition);
+                break;
+            case SimdLevel::AVX2:
+                applyAVX2(input, output, size, pattern.data(), keyLength, keyPosition);
+                break;
+            case SimdLevel::SSSE3:
+            case SimdLevel::SSE2:
+                applySSE2(input, output, size, pattern.data(), keyLength, keyPosition);
+                break;
+#endif
+            default:
+                applyScalar(input, output, size, pattern.data(), keyLength, keyPosition);
+                break;
+        }
+    }
+
+private:
+    static constexpr size_t MAX_VECTOR_WIDTH = 64;
+
+    /**
+     * @brief Procesa los bytes sobrantes uno a uno.
+     */
+    static void applyTail(const char* input, char* output, size_t begin, size_t size, const char* pattern, size_t keyLength, size_t& keyPosition) {
+        for (size_t i = begin; i < size; ++i) {
+            output[i] = static_cast<char>(input[i] ^ pattern[keyPosition]);
+            if (++keyPosition == keyLength) {
+                keyPosition = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Camino escalar: palabras de 8 bytes.
+     */
+    static void applyScalar(const char* input, char* output, size_t size, const char* pattern, size_t keyLength, size_t& keyPosition) {
+        const size_t step = 8 % keyLength;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t data;
+            uint64_t key;
+            std::memcpy(&data, input + i, 8);
+            std::memcpy(&key, pattern + keyPosition, 8);
+            data ^= key;
+            std::memcpy(output + i, &data, 8);
+            keyPosition += step;
+            if (keyPosition >= keyLength) keyPosition -= keyLength;
+        }
+        applyTail(input, output, i, size, pattern, keyLength, keyPosition);
+    }
+
+#if CRIPTO_X86_SIMD
+    __attribute__((target("sse2")))
+    static void applySSE2(const char* input, char* output, size_t size, const char* pattern, size_t keyLength, size_t& keyPosition) {
+        const size_t step = 16 % keyLength;
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern + keyPosition));
+            __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_xor_si128(data, key));
+            keyPosition += step;
+            if (keyPosition >= keyLength) keyPosition -= keyLength;
+        }
+        applyTail(input, output, i, size, pattern, keyLength, keyPosition);
+    }
+
+    __attribute__((target("avx2")))
+    static void applyAVX2(const char* input, char* output, size_t size, const char* pattern, size_t keyLength, size_t& keyPosition) {
+        const size_t step = 32 % keyLength;
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pattern + keyPosition));
+            __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_xor_si256(data, key));
+            keyPosition += step;
+            if (keyPosition >= keyLength) keyPosition -= keyLength;
+        }
+        applyTail(input, output, i, size, pattern, keyLength, keyPosition);
+    }
+
+    __attribute__((target("avx512f")))
+    static void applyAVX512(const char* input, char* output, size_t size, const char* pattern, size_t keyLength, size_t& keyPosition) {
+        const size_t step = 64 % keyLength;
+        size_t i = 0;
+        for (; i + 64 <= size; i += 64) {
+            __m512i key = _mm512_loadu_si512(pattern + keyPosition);
+            __m512i data = _mm512_loadu_si512(input + i);
+            _mm512_storeu_si512(output + i, _mm512_xor_si512(data, key));
+            keyPosition += step;
+            if (keyPosition >= keyLength) keyPosition -= keyLength;
+        }
+        applyTail(input, output, i, size, pattern, keyLength, keyPosition);
+    }
+#endif
+};
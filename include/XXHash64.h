@@ -0,0 +1,150 @@
+﻿#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/**
+ * @class XXHash64
+ * @brief Resumen rápido (no criptográfico) XXH64, por fragmentos.
+ *
+ * Sirve para saber si el contenido de un archivo cambió: lee a la velocidad de la
+ * memoria, mucho más rápido que SHA-256. Los bloques se leen en little-endian, como en
+ * la especificación original.
+ */
+class XXHash64 {
+public:
+    explicit XXHash64(uint64_t seed = 0) {
+        reset(seed);
+    }
+
+    void reset(uint64_t seed = 0) {
+        lanes[0] = seed + PRIME1 + PRIME2;
+        lanes[1] = seed + PRIME2;
+        lanes[2] = seed;
+        lanes[3] = seed - PRIME1;
+        hashSeed = seed;
+        bufferSize = 0;
+        totalBytes = 0;
+    }
+
+    /**
+     * @brief Añade bytes al mensaje.
+     */
+    void update(const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        totalBytes += size;
+        if (bufferSize > 0) {
+            size_t take = std::min(size, sizeof(buffer) - bufferSize);
+            std::memcpy(buffer + bufferSize, bytes, take);
+            bufferSize += take;
+            bytes += take;
+            size -= take;
+            if (bufferSize < sizeof(buffer)) {
+                return;
+            }
+            consumeStripe(buffer);
+            bufferSize = 0;
+        }
+        while (size >= sizeof(buffer)) {
+            consumeStripe(bytes);
+            bytes += sizeof(buffer);
+            size -= sizeof(buffer);
+        }
+        std::memcpy(buffer, bytes, size);
+        bufferSize = size;
+    }
+
+    void update(std::string_view data) {
+        update(data.data(), data.size());
+    }
+
+    /**
+     * @brief Resumen de lo añadido hasta ahora (se puede seguir añadiendo).
+     */
+    uint64_t digest() const {
+        uint64_t hash;
+        if (totalBytes >= sizeof(buffer)) {
+            hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+            for (uint64_t lane : lanes) {
+                hash = (hash ^ round(0, lane)) * PRIME1 + PRIME4;
+            }
+        } else {
+            hash = hashSeed + PRIME5;
+        }
+        hash += totalBytes;
+
+        const unsigned char* rest = buffer;
+        size_t remaining = bufferSize;
+        for (; remaining >= 8; rest += 8, remaining -= 8) {
+            hash ^= round(0, load64(rest));
+            hash = rotl(hash, 27) * PRIME1 + PRIME4;
+        }
+        if (remaining >= 4) {
+            hash ^= static_cast<uint64_t>(load32(rest)) * PRIME1;
+            hash = rotl(hash, 23) * PRIME2 + PRIME3;
+            rest += 4;
+            remaining -= 4;
+        }
+        for (; remaining > 0; ++rest, --remaining) {
+            hash ^= *rest * PRIME5;
+            hash = rotl(hash, 11) * PRIME1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= PRIME2;
+        hash ^= hash >> 29;
+        hash *= PRIME3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    /**
+     * @brief Resumen de un mensaje completo.
+     */
+    static uint64_t hash(std::string_view data, uint64_t seed = 0) {
+        XXHash64 hasher(seed);
+        hasher.update(data);
+        return hasher.digest();
+    }
+
+private:
+    static constexpr uint64_t PRIME1 = 11400714785074694791ULL;
+    static constexpr uint64_t PRIME2 = 14029467366897019727ULL;
+    static constexpr uint64_t PRIME3 = 1609587929392839161ULL;
+    static constexpr uint64_t PRIME4 = 9650029242287828579ULL;
+    static constexpr uint64_t PRIME5 = 2870177450012600261ULL;
+
+    uint64_t lanes[4] = {};
+    uint64_t hashSeed = 0;
+    unsigned char buffer[32] = {};
+    size_t bufferSize = 0;
+    uint64_t totalBytes = 0;
+
+    static constexpr uint64_t rotl(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    static constexpr uint64_t round(uint64_t accumulator, uint64_t input) {
+        return rotl(accumulator + input * PRIME2, 31) * PRIME1;
+    }
+
+    static uint64_t load64(const unsigned char* data) {
+        uint64_t value = 0;
+        for (int i = 7; i >= 0; --i) {
+            value = (value << 8) | data[i];
+        }
+        return value;
+    }
+
+    static uint32_t load32(const unsigned char* data) {
+        return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+               (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    void consumeStripe(const unsigned char* stripe) {
+        for (int i = 0; i < 4; ++i) {
+            lanes[i] = round(lanes[i], load64(stripe + 8 * i));
+        }
+    }
+};
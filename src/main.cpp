@@ -3,12 +3,214 @@
 #include "CesarEncoder.h"
 #include "VigenereEncoder.h"
 #include "DESEncoder.h"
+#include "CascadeEncoder.h"
+#include "BatchExecutor.h"
+#include "Cryptanalysis.h"
+#include "DESKeySearch.h"
+#include "CifContainer.h"
+#include "Armor.h"
+#include "PipelinedIO.h"
+#include "ChangeManifest.h"
+#include "OutputNamer.h"
+#include "DirectoryWatcher.h"
+#include "Trace.h"
+#include <csignal>
+#include <optional>
+#include <set>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+/**
+ * @brief Opciones recibidas por línea de comandos.
+ */
+struct CommandLineOptions {
+    unsigned int jobs = 0;          ///< Hilos para el procesamiento por lotes (0 = todos los núcleos).
+    bool desModeGiven = false;      ///< Si es falso, el modo DES se pregunta en el menú.
+    DESMode desMode = DESMode::ECB; ///< Modo DES al encriptar.
+    bool rawFormat = false;         ///< --format raw: al encriptar, el formato antiguo sin contenedor.
+    ArmorFormat armor = ArmorFormat::None; ///< --armor: al encriptar, guardar el resultado como texto.
+    PipelineOptions io;             ///< --io, --io-depth y --io-buffer.
+    bool ioGiven = false;           ///< Se pasó alguna de --io, --io-depth o --io-buffer.
+    bool ioStats = false;           ///< --io-stats: ocupación de cada etapa por archivo.
+    bool inPlace = false;           ///< --in-place: sobrescribir cada archivo y renombrarlo.
+    std::string incrementalFile;    ///< --incremental: registro de cambios; solo se procesa lo que cambió.
+    std::string traceFile;          ///< --trace: tiempos por etapa en formato de Chrome.
+
+    // --- Modo no interactivo ---
+    bool batch = false;              ///< Verdadero si se pidió una operación por línea de comandos.
+    bool showHelp = false;           ///< Mostrar la ayuda y salir.
+    bool invalid = false;            ///< Hubo un error de uso; se sale con código 2.
+    bool encrypting = true;          ///< --encrypt (por defecto) o --decrypt.
+    int cipherChoice = 0;            ///< 1 XOR, 2 Cesar, 3 Vigenere, 4 DES (igual que en el menú), 5 cascada.
+    std::string keyFile;             ///< Archivo con la clave (--key-file).
+    std::vector<std::string> fanOutKeyFiles; ///< --fan-out: una salida por cada archivo de clave.
+    std::vector<CascadeStage> cascade; ///< --cascade: etapas en el orden de cifrado, ya con sus claves.
+    std::string inputPath = "-";     ///< Carpeta, archivo o "-" (entrada estándar).
+    std::string outputPath = "-";    ///< Carpeta, archivo o "-" (salida estándar).
+    std::string manifestFile;        ///< Archivo con un nombre o patrón por línea (--manifest).
+    std::vector<std::string> patterns; ///< Nombres o patrones (* y ?) dentro de la carpeta de entrada.
+    bool watch = false;              ///< --watch: cifrar lo que llegue a la carpeta de entrada.
+    unsigned int watchDelay = 100;   ///< --watch-delay: ms sin eventos de un archivo antes de cifrarlo.
+    size_t watchQueue = 0;           ///< --watch-queue: archivos en cola como máximo (0 = 4 por hilo).
+    bool rangeGiven = false;         ///< --range: descifrar solo una parte de un contenedor.
+    uint64_t rangeOffset = 0;        ///< Primer byte del texto plano a descifrar.
+    uint64_t rangeLength = UINT64_MAX; ///< Bytes a descifrar (hasta el final si no se indica).
+};
+
+/**
+ * @brief Un archivo a procesar en un lote y el nombre base de su salida.
+ */
+struct BatchItem {
+    fs::path inputFile;
+    std::string outputStem;  ///< Nombre de salida sin extensión; se le añade un sufijo si ya existe.
+    std::string outputExt;
+};
+
+/**
+ * @brief Un archivo de un lote ya planificado: su entrada y su salida.
+ *
+ * Si `outputFile` está vacío, el hilo que lo procesa reserva el nombre con OutputNamer a
+ * partir de `outputStem` y `outputExt`. En un lote incremental `outputFile` es un
+ * temporal que se renombra sobre `finalOutputFile` al terminar, y el hilo rellena
+ * `entry.hash` y `recorded`.
+ */
+struct FileTask {
+    fs::path inputFile;
+    fs::path outputFile;
+    std::string outputStem;
+    std::string outputExt;
+    bool missing = false;
+    fs::path finalOutputFile;      ///< Salida a reemplazar; vacía fuera del modo incremental.
+    bool hasPreviousHash = false;  ///< La salida registrada existe y corresponde a `previousHash`.
+    uint64_t previousHash = 0;
+    ChangeManifest::Entry entry;   ///< Tamaño, fecha y salida vistos al planificar.
+    bool recorded = false;         ///< Se procesó (o no hacía falta) y va al registro.
+    bool unchanged = false;        ///< El contenido no cambió: no se volvió a cifrar.
+    bool statFailed = false;       ///< No se leyó su tamaño o su fecha: se procesa, pero no va al registro.
+};
+
+/**
+ * @brief Una clave de --fan-out: su contraseña y la subcarpeta de salida (el nombre de su
+ * archivo sin extensión).
+ */
+struct FanOutKey {
+    std::string name;
+    std::string password;
+};
+
+/**
+ * @brief Lo necesario para preparar cualquiera de los codificadores con beginStream().
+ */
+struct CipherSettings {
+    int algorithm = 0;              ///< 1 XOR, 2 Cesar, 3 Vigenere, 4 DES (igual que en el menú), 5 cascada.
+    std::string password;
+    std::vector<CascadeStage> cascade; ///< Etapas de la cascada (algoritmo 5).
+    bool encrypting = true;
+    DESKey desKey;                  ///< Clave DES ya expandida; se comparte en modo lectura entre hilos.
+    DESMode desMode = DESMode::ECB;
+    unsigned int desThreads = 1;    ///< Hilos para repartir los bloques dentro de cada archivo DES.
+    bool writeContainer = true;     ///< Al encriptar, escribir un contenedor .cif (si no, el formato antiguo).
+    unsigned int chunkThreads = 1;  ///< Fragmentos de un contenedor que se descifran a la vez.
+    bool rangeGiven = false;        ///< Descifrar solo [rangeOffset, rangeOffset + rangeLength).
+    uint64_t rangeOffset = 0;
+    uint64_t rangeLength = UINT64_MAX;
+    bool verifyKey = true;          ///< Rechazar la clave si no coincide con la comprobación del contenedor.
+    PipelineOptions io;             ///< Cómo se leen y escriben los archivos.
+    bool ioStats = false;           ///< Añadir la ocupación de cada etapa al mensaje de cada archivo.
+    bool inPlace = false;           ///< Cifrar cada archivo sobre sí mismo y renombrarlo a la salida.
+    ArmorFormat armor = ArmorFormat::None; ///< Al encriptar, armadura de texto (hexadecimal o Base64).
+};
+
+/**
+ * @brief Buffers de lectura y escritura de un hilo. Se reservan con el primer archivo y
+ * se reutilizan en los siguientes.
+ */
+struct StreamBuffers {
+    std::vector<std::byte> input;
+    std::vector<std::byte> output;
+    FilePipeline pipeline;  ///< Lectura, cifrado y escritura solapados (archivos, no flujos).
+};
 
 // Declaraciones de funciones
-void handleUserChoice(const fs::path& desencriptadosPath, const fs::path& encriptadosPath);
-void processFiles(const fs::path& inputDir, const fs::path& outputDir, const std::string& inputExt, const std::string& outputExt, const std::string& operation, int cipherChoice);
-std::string readFileContents(const fs::path& filePath);
-void writeFileContents(const fs::path& filePath, const std::string& content);
+void handleUserChoice(const fs::path& desencriptadosPath, const fs::path& encriptadosPath, const CommandLineOptions& options);
+void processFiles(const fs::path& inputDir, const fs::path& outputDir, const std::string& inputExt, const std::string& outputExt, bool encrypting, int cipherChoice, const CommandLineOptions& options);
+int runBatch(const std::vector<BatchItem>& items, const fs::path& outputDir, const std::string& password, bool encrypting, int cipherChoice, DESMode desMode, const CommandLineOptions& options);
+int runFanOut(const std::vector<BatchItem>& items, const fs::path& outputDir, const std::vector<FanOutKey>& keys, const CommandLineOptions& options);
+int runCommandLine(const CommandLineOptions& options);
+void printUsage(const char* program);
+void recoverKeys(const fs::path& inputDir, const fs::path& outputDir, int cipherChoice, const CommandLineOptions& options);
+void recoverDESKey(const fs::path& inputDir, const fs::path& outputDir, const CommandLineOptions& options);
+std::string describeKey(const std::string& key);
+CommandLineOptions parseCommandLine(int argc, char* argv[]);
+bool parseDESMode(const std::string& text, DESMode& mode);
+bool matchesPattern(const std::string& pattern, const std::string& name);
+void prepareCipher(XOREncoder& cipher, const CipherSettings& settings);
+void prepareCipher(CesarEncoder& cipher, const CipherSettings& settings);
+void prepareCipher(VigenereEncoder& cipher, const CipherSettings& settings);
+void prepareCipher(DESEncoder& cipher, const CipherSettings& settings);
+void prepareCipher(CascadeEncoder& cipher, const CipherSettings& settings);
+template <ChunkedCipher C>
+void prepareCipher(ContainerEncoder<C>& container, const CipherSettings& settings);
+template <Cipher C>
+void prepareCipher(ArmorEncoder<C>& armor, const CipherSettings& settings);
+template <ChunkedCipher C>
+void prepareContainerCipher(C& cipher, const CipherSettings& settings, const CifHeader& header, bool parallelChunks);
+void prepareContainerCipher(DESEncoder& cipher, const CipherSettings& settings, const CifHeader& header, bool parallelChunks);
+template <ChunkedCipher C>
+void prepareLegacyCipher(C& cipher, const CipherSettings& settings);
+void prepareLegacyCipher(DESEncoder& cipher, const CipherSettings& settings);
+const char* algorithmName(int algorithm);
+int parseAlgorithm(std::string name);
+bool readKeyFile(const std::string& path, std::string& key);
+std::string keyCheckMaterial(const CipherSettings& settings);
+bool parseRange(const std::string& text, uint64_t& offset, uint64_t& length);
+template <typename Body>
+int dispatchCipher(int cipherChoice, Body&& body);
+template <Cipher C, typename Body>
+int dispatchEncoder(const CipherSettings& settings, Body&& body);
+#if CRIPTO_INOTIFY
+int runWatch(const fs::path& inputDir, const fs::path& outputDir, const std::vector<std::string>& patterns, const std::string& password, const CommandLineOptions& options);
+template <Cipher C>
+int watchDirectory(const fs::path& inputDir, const fs::path& outputDir, const std::vector<std::string>& patterns, const CipherSettings& settings, const CommandLineOptions& options);
+#endif
+template <Cipher C>
+int processTasks(std::vector<FileTask>& tasks, const BatchExecutor& executor, const CipherSettings& settings, OutputNamer* namer);
+template <Cipher C>
+int fanOutTasks(const std::vector<BatchItem>& items, size_t groups, const BatchExecutor& executor, const std::vector<FanOutKey>& keys,
+                const std::vector<CipherSettings>& keySettings, std::vector<std::unique_ptr<OutputNamer>>& namers, size_t& writtenOutputs);
+template <Cipher C>
+bool streamFile(const fs::path& inputFile, const fs::path& outputFile, C& cipher, StreamBuffers& buffers, std::string& error);
+#if CRIPTO_POSIX_IO
+template <Cipher C>
+bool streamFilePipelined(const fs::path& inputFile, const fs::path& outputFile, C& cipher, FilePipeline& pipeline, std::string& error);
+template <InPlaceCipher C>
+bool transformFileInPlace(const fs::path& inputFile, const fs::path& outputFile, C& cipher, StreamBuffers& buffers, const CipherSettings& settings, std::string& error);
+bool sameFileSystem(const fs::path& first, const fs::path& second);
+#endif
+template <Cipher C>
+bool streamData(std::istream& input, std::ostream& output, const std::string& inputName, const std::string& outputName, C& cipher, StreamBuffers& buffers, std::string& error, size_t preloaded = 0);
+template <ChunkedCipher C>
+bool decryptFile(const fs::path& inputFile, const fs::path& outputFile, C& cipher, StreamBuffers& buffers, CifWorkspace<C>& workspace, const CipherSettings& settings, std::string& error);
+template <ChunkedCipher C>
+bool decryptStream(std::istream& input, std::ostream& output, bool seekable, const std::string& inputName, const std::string& outputName, C& cipher, StreamBuffers& buffers, CifWorkspace<C>& workspace, const CipherSettings& settings, std::string& error);
+bool isArmoredFile(const fs::path& inputFile);
+template <Cipher C>
+bool decryptArmoredFile(const fs::path& inputFile, const fs::path& outputFile, C& cipher, StreamBuffers& buffers, CifWorkspace<C>& workspace, const CipherSettings& settings, std::string& error);
+template <Cipher C>
+bool decryptArmored(std::istream& source, std::ostream& output, const std::string& inputName, const std::string& outputName, C& cipher, StreamBuffers& buffers, CifWorkspace<C>& workspace, const CipherSettings& settings, std::string& error);
+
+// Tamaño de los fragmentos con los que se leen, transforman y escriben los archivos.
+constexpr size_t STREAM_CHUNK_SIZE = 1 << 20;
+// Bytes del inicio de cada archivo que se analizan para recuperar la clave.
+constexpr size_t ANALYSIS_SAMPLE_SIZE = 4 << 20;
+
+// Búsqueda de clave DES en curso; Ctrl+C la detiene y guarda el progreso. Es atómica
+// porque la lee el manejador de la señal.
+std::atomic<DESKeySearch*> activeKeySearch{nullptr};
+// Ctrl+C (o SIGTERM) durante --watch: se terminan los archivos en cola y se sale.
+std::atomic<bool> watchStopRequested{false};
 
 /**
  * @brief Lee una línea de la consola y la convierte en una opción numérica.
@@ -29,6 +231,10 @@ int getChoiceFromUser() {
 
 /**
  * @brief Punto de entrada principal de la aplicación.
+ * Sin opciones de operación abre el menú interactivo; con `--encrypt`, `--decrypt`,
+ * `--algo`, `--in` o `--out` procesa los archivos sin preguntar nada (ver printUsage()).
+ * En los dos casos `--jobs N` (o `-j N`) fija el número de hilos y `--des-mode
+ * ecb|cbc|ctr` el modo DES al encriptar.
  */
 int main(int argc, char* argv[]) {
     if (argc < 1) {
@@ -36,23 +242,717 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
+    CommandLineOptions options = parseCommandLine(argc, argv);
+    if (options.showHelp) {
+        printUsage(argv[0]);
+        return EXIT_SUCCESS;
+    }
+    if (options.invalid) {
+        std::cerr << "Usa --help para ver las opciones.\n";
+        return 2;
+    }
+    if (options.inPlace && !options.batch) {
+        std::cerr << "--in-place solo se usa con --encrypt o --decrypt.\n";
+        return 2;
+    }
+    if (!options.incrementalFile.empty() && !options.batch) {
+        std::cerr << "--incremental solo se usa con --encrypt o --decrypt.\n";
+        return 2;
+    }
+    if (!options.traceFile.empty()) {
+        if (!CRIPTO_ENABLE_TRACE) {
+            std::cerr << "--trace necesita compilar con -DCRIPTO_ENABLE_TRACE=ON.\n";
+            return 2;
+        }
+        if (!options.batch) {
+            std::cerr << "--trace solo se usa con --encrypt o --decrypt.\n";
+            return 2;
+        }
+        Trace::instance().start();
+    }
     fs::path exePath = fs::absolute(fs::path(argv[0]));
     fs::path projectRoot = exePath.parent_path().parent_path();
     fs::path filesEncriptadosDir = projectRoot / "FilesEncriptados";
     fs::path filesDesencriptadosDir = projectRoot / "FilesDesencriptados";
 
+    if (options.watch) {
+        // Sin --in ni --out se vigilan las mismas carpetas que usa el menú.
+        if (options.inputPath == "-") {
+            options.inputPath = filesDesencriptadosDir.string();
+        }
+        if (options.outputPath == "-") {
+            options.outputPath = filesEncriptadosDir.string();
+        }
+    }
+    if (options.batch) {
+        int status = runCommandLine(options);
+        if (!options.traceFile.empty()) {
+            // El resumen va a la salida de errores para no mezclarse con el modo filtro.
+            std::string error;
+            if (!Trace::instance().write(options.traceFile, error)) {
+                std::cerr << "Error: No se pudo guardar la traza: " << error << ".\n";
+                return 1;
+            }
+            Trace::instance().report(std::cerr);
+            std::cerr << "Traza guardada en '" << options.traceFile << "'.\n";
+        }
+        return status;
+    }
+
     fs::create_directory(filesEncriptadosDir);
     fs::create_directory(filesDesencriptadosDir);
 
-    handleUserChoice(filesDesencriptadosDir, filesEncriptadosDir);
+    handleUserChoice(filesDesencriptadosDir, filesEncriptadosDir, options);
 
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Lee las opciones de la línea de comandos. Los argumentos que no son opciones
+ * son nombres o patrones de archivos. Los errores se avisan por `std::cerr` y marcan
+ * las opciones como inválidas, salvo un `--jobs` incorrecto, que solo se ignora.
+ */
+CommandLineOptions parseCommandLine(int argc, char* argv[]) {
+    CommandLineOptions options;
+    auto needsValue = [&](int& i, const std::string& arg) -> const char* {
+        if (i + 1 >= argc) {
+            std::cerr << "Falta el valor de " << arg << ".\n";
+            options.invalid = true;
+            return nullptr;
+        }
+        return argv[++i];
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            options.showHelp = true;
+        } else if (arg == "--jobs" || arg == "-j") {
+            const char* value = needsValue(i, arg);
+            if (value == nullptr) {
+                continue;
+            }
+            try {
+                int jobs = std::stoi(value);
+                options.jobs = jobs > 0 ? static_cast<unsigned int>(jobs) : 0;
+            } catch (const std::exception& e) {
+                std::cerr << "Valor de --jobs no valido: '" << value << "'. Se usaran todos los nucleos.\n";
+            }
+        } else if (arg == "--des-mode") {
+            const char* value = needsValue(i, arg);
+            if (value == nullptr) {
+                continue;
+            }
+            if (parseDESMode(value, options.desMode)) {
+                options.desModeGiven = true;
+            } else {
+                std::cerr << "Modo DES no valido: '" << value << "'. Usa ecb, cbc o ctr.\n";
+                options.invalid = true;
+            }
+        } else if (arg == "--format") {
+            const char* value = needsValue(i, arg);
+            if (value == nullptr) {
+                continue;
+            }
+            std::string format = value;
+            if (format == "raw" || format == "cif") {
+                options.rawFormat = (format == "raw");
+            } else {
+                std::cerr << "Formato no valido: '" << value << "'. Usa cif o raw.\n";
+                options.invalid = true;
+            }
+        } else if (arg == "--armor") {
+            const char* value = needsValue(i, arg);
+            if (value == nullptr) {
+                continue;
+            }
+            std::string armor = value;
+            if (armor == "hex" || armor == "base64" || armor == "none") {
+                options.armor = armor == "hex" ? ArmorFormat::Hex : armor == "base64" ? ArmorFormat::Base64 : ArmorFormat::None;
+            } else {
+                std::cerr << "Armadura no valida: '" << value << "'. Usa hex, base64 o none.\n";
+                options.invalid = true;
+            }
+        } else if (arg == "--io") {
+            const char* value = needsValue(i, arg);
+            if (value == nullptr) {
+                continue;
+            }
+            options.ioGiven = true;
+            std::string backend = value;
+            if (backend == "auto" || backend == "uring" || backend == "threads" || backend == "stream" || backend == "mmap") {
+                options.io.backend = backend == "uring" ? IOBackend::Uring : backend == "threads" ? IOBackend::Threads
+                                   : backend == "stream" ? IOBackend::Stream : backend == "mmap" ? IOBackend::Mmap : IOBackend::Auto;
+            } else {
+                std::cerr << "Motor de E/S no valido: '" << value << "'. Usa auto, uring, threads, stream o mmap.\n";
+                options.invalid = true;
+            }
+        } else if (arg == "--io-depth" || arg == "--io-buffer") {
+            const char* value = needsValue(i, arg);
+            if (value == nullptr) {
+                continue;
+            }
+            options.ioGiven = true;
+            try {
+                int number = std::stoi(value);
+                if (number < 1 || number > (arg == "--io-depth" ? 64 : 65536)) {
+                    throw std::out_of_range(arg);
+                }
+                if (arg == "--io-depth") {
+                    options.io.depth = static_cast<unsigned int>(number);
+                } else {
+                    options.io.bufferSize = static_cast<size_t>(number) << 10;
+                }
+            } catch (const std::exception&) {
+                std::cerr << "Valor de " << arg << " no valido: '" << value << "'.\n";
+                options.invalid = true;
+            }
+        } else if (arg == "--io-stats") {
+            options.ioStats = true;
+        } else if (arg == "--in-place") {
+            options.inPlace = true;
+        } else if (arg == "--trace") {
+            const char* value = needsValue(i, arg);
+            if (value != nullptr) {
+                options.traceFile = value;
+            }
+        } else if (arg == "--watch") {
+            options.batch = true;
+            options.watch = true;
+        } else if (arg == "--watch-delay" || arg == "--watch-queue") {
+            const char* value = needsValue(i, arg);
+            if (value == nullptr) {
+                continue;
+            }
+            try {
+                int number = std::stoi(value);
+                if (number < (arg == "--watch-delay" ? 0 : 1) || number > 1000000) {
+                    throw std::out_of_range(arg);
+                }
+                if (arg == "--watch-delay") {
+                    options.watchDelay = static_cast<unsigned int>(number);
+                } else {
+                    options.watchQueue = static_cast<size_t>(number);
+                }
+            } catch (const std::exception&) {
+                std::cerr << "Valor de " << arg << " no valido: '" << value << "'.\n";
+                options.invalid = true;
+            }
+        } else if (arg == "--incremental") {
+            const char* value = needsValue(i, arg);
+            if (value != nullptr) {
+                options.incrementalFile = value;
+            }
+        } else if (arg == "--range") {
+            const char* value = needsValue(i, arg);
+            if (value == nullptr) {
+                continue;
+            }
+            if (parseRange(value, options.rangeOffset, options.rangeLength)) {
+                options.batch = true;
+                options.rangeGiven = true;
+            } else {
+                std::cerr << "Rango no valido: '" << value << "'. Usa INICIO:LONGITUD (en bytes).\n";
+                options.invalid = true;
+            }
+        } else if (arg == "--encrypt" || arg == "-e") {
+            options.batch = true;
+            options.encrypting = true;
+        } else if (arg == "--decrypt" || arg == "-d") {
+            options.batch = true;
+            options.encrypting = false;
+        } else if (arg == "--algo" || arg == "-a") {
+            const char* value = needsValue(i, arg);
+            if (value == nullptr) {
+                continue;
+            }
+            options.batch = true;
+            options.cipherChoice = parseAlgorithm(value);
+            if (options.cipherChoice == 0) {
+                std::cerr << "Algoritmo no valido: '" << value << "'. Usa xor, cesar, vigenere o des.\n";
+                options.invalid = true;
+            }
+        } else if (arg == "--cascade") {
+            const char* value = needsValue(i, arg);
+            if (value == nullptr) {
+                continue;
+            }
+            // ALGO:ARCHIVO_DE_CLAVE separados por comas, en el orden de cifrado.
+            options.batch = true;
+            options.cipherChoice = 5;
+            options.cascade.clear();
+            std::stringstream spec(value);
+            std::string item;
+            while (std::getline(spec, item, ',')) {
+                const size_t colon = item.find(':');
+                CascadeStage stage;
+                stage.algorithm = colon == std::string::npos ? 0 : parseAlgorithm(item.substr(0, colon));
+                if (stage.algorithm == 0) {
+                    std::cerr << "Etapa de --cascade no valida: '" << item << "'. Usa ALGO:ARCHIVO_DE_CLAVE.\n";
+                    options.invalid = true;
+                    break;
+                }
+                if (!readKeyFile(item.substr(colon + 1), stage.key)) {
+                    std::cerr << "Error: No se pudo leer el archivo de clave '" << item.substr(colon + 1) << "'.\n";
+                    options.invalid = true;
+                    break;
+                }
+                options.cascade.push_back(stage);
+            }
+            std::string error;
+            if (!options.invalid && !CascadeEncoder::validate(options.cascade, error)) {
+                std::cerr << "--cascade no valida: " << error << ".\n";
+                options.invalid = true;
+            }
+        } else if (arg == "--fan-out") {
+            const char* value = needsValue(i, arg);
+            if (value == nullptr) {
+                continue;
+            }
+            options.batch = true;
+            options.fanOutKeyFiles.clear();
+            std::stringstream list(value);
+            std::string keyFile;
+            while (std::getline(list, keyFile, ',')) {
+                if (!keyFile.empty()) {
+                    options.fanOutKeyFiles.push_back(keyFile);
+                }
+            }
+        } else if (arg == "--key-file" || arg == "-k") {
+            const char* value = needsValue(i, arg);
+            if (value != nullptr) {
+                options.keyFile = value;
+            }
+        } else if (arg == "--in" || arg == "-i") {
+            const char* value = needsValue(i, arg);
+            if (value != nullptr) {
+                options.batch = true;
+                options.inputPath = value;
+            }
+        } else if (arg == "--out" || arg == "-o") {
+            const char* value = needsValue(i, arg);
+            if (value != nullptr) {
+                options.batch = true;
+                options.outputPath = value;
+            }
+        } else if (arg == "--manifest") {
+            const char* value = needsValue(i, arg);
+            if (value != nullptr) {
+                options.manifestFile = value;
+            }
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Opcion desconocida: '" << arg << "'.\n";
+            options.invalid = true;
+        } else {
+            options.patterns.push_back(arg);
+        }
+    }
+    return options;
+}
+
+/**
+ * @brief Muestra la ayuda de la línea de comandos.
+ */
+void printUsage(const char* program) {
+    std::cout << "Uso:\n"
+              << "  " << program << " [--jobs N] [--des-mode ecb|cbc|ctr] [--format cif|raw]\n"
+              << "      Abre el menu interactivo.\n"
+              << "  " << program << " (--encrypt|--decrypt) --algo xor|cesar|vigenere|des --key-file ARCHIVO\n"
+              << "      [--in CARPETA|ARCHIVO|-] [--out CARPETA|ARCHIVO|-] [--manifest ARCHIVO]\n"
+              << "      [--incremental REGISTRO] [PATRON...]\n"
+              << "      Procesa sin preguntar nada. En vez de --algo y --key-file se puede usar\n"
+              << "      --cascade ALGO:CLAVE[,ALGO:CLAVE...] (ver abajo). Al encriptar una carpeta,\n"
+              << "      --fan-out CLAVE[,CLAVE...] sustituye a --key-file.\n"
+              << "  " << program << " --watch --algo xor|cesar|vigenere|des --key-file ARCHIVO\n"
+              << "      [--in CARPETA] [--out CARPETA] [--watch-delay MS] [--watch-queue N] [PATRON...]\n"
+              << "      Se queda vigilando la carpeta de entrada (FilesDesencriptados por defecto) y\n"
+              << "      encripta en la de salida (FilesEncriptados) cada archivo que llega o cambia.\n\n"
+              << "  --in, --out   Por defecto '-': entrada y salida estandar (modo filtro, sin archivos\n"
+              << "                temporales). Con una carpeta de entrada se procesan los archivos que\n"
+              << "                coinciden con los PATRONES (* y ?) o con las lineas de --manifest; sin\n"
+              << "                ninguno, todos los *.txt (al encriptar) o *.cif (al desencriptar).\n"
+              << "  --key-file    Archivo con la clave (se ignora un salto de linea final).\n"
+              << "  --encrypt     Es la operacion por defecto.\n"
+              << "  --cascade     Cifra con varios algoritmos seguidos en una sola pasada, cada uno con\n"
+              << "                su archivo de clave (p. ej. vigenere:k1.txt,xor:k2.txt,des:k3.txt);\n"
+              << "                DES solo puede ir al final. Para descifrar se da la misma cadena y\n"
+              << "                se deshace en orden inverso. Escribe siempre el formato raw.\n"
+              << "  --fan-out     Encripta cada archivo con varias claves leyendolo una sola vez; la\n"
+              << "                salida de cada clave va a OUT/<nombre del archivo de clave>/. No\n"
+              << "                acepta las opciones --io.\n"
+              << "  --format      cif (por defecto): contenedor con el algoritmo, comprobacion de clave,\n"
+              << "                fragmentos e indice; una clave incorrecta se rechaza sin descifrar.\n"
+              << "                raw: el formato antiguo, sin cabecera. Al desencriptar se detecta solo.\n"
+              << "  --armor       hex o base64: al encriptar, guarda el resultado como texto (lineas de\n"
+              << "                64 caracteres entre -----BEGIN CRIPTO ...----- y -----END...-----).\n"
+              << "                Al desencriptar se detecta solo. No admite --range.\n"
+              << "  --range I:L   Al desencriptar un contenedor, solo L bytes desde el byte I del\n"
+              << "                texto original (sin L, hasta el final).\n"
+              << "  --io          auto (por defecto), uring, threads, stream o mmap: como se leen y\n"
+              << "                escriben los archivos. Con uring o threads se lee el fragmento siguiente\n"
+              << "                y se escribe el anterior mientras se cifra el actual. mmap mapea los\n"
+              << "                archivos en memoria (XOR, Cesar y Vigenere con --format raw).\n"
+              << "  --in-place    Cifra cada archivo sobre si mismo y lo renombra (.txt -> .cif); no\n"
+              << "                queda copia del original. Mismos casos que --io mmap.\n"
+              << "  --io-depth N  Fragmentos en vuelo (3 por defecto).\n"
+              << "  --io-buffer K Tamano de cada fragmento en KiB (1024 por defecto).\n"
+              << "  --io-stats    Muestra por archivo el uso de lectura, cifrado y escritura.\n"
+              << "  --incremental Guarda en REGISTRO el tamano, la fecha y un resumen de cada entrada;\n"
+              << "                en las siguientes ejecuciones solo se procesa lo que cambio y cada\n"
+              << "                salida se reemplaza de forma atomica (sin sufijos -1, -2...).\n"
+              << "  --watch-delay Milisegundos sin cambios en un archivo antes de cifrarlo (100 por\n"
+              << "                defecto); los eventos seguidos de un mismo archivo se juntan.\n"
+              << "  --watch-queue Archivos esperando como maximo (4 por hilo por defecto); con la cola\n"
+              << "                llena se deja de leer eventos hasta que los hilos la vacian.\n"
+              << "  --trace F     Guarda en F los tiempos de cada etapa (formato de Chrome, para\n"
+              << "                chrome://tracing o Perfetto) y muestra un resumen con los MB/s por\n"
+              << "                archivo. Requiere compilar con -DCRIPTO_ENABLE_TRACE=ON.\n\n"
+              << "Codigos de salida: 0 correcto, 1 algun archivo fallo, 2 error de uso.\n"
+              << "Ejemplo: tar c datos | " << program << " --algo xor --key-file clave.txt | ssh host 'cat > datos.cif'\n";
+}
+
+/**
+ * @brief Ejecuta la operación pedida por línea de comandos, sin menú.
+ * @return El código de salida del programa.
+ */
+int runCommandLine(const CommandLineOptions& options) {
+    if (options.cipherChoice == 0) {
+        std::cerr << "Falta el algoritmo: usa --algo xor|cesar|vigenere|des.\n";
+        return 2;
+    }
+    const bool cascade = options.cipherChoice == 5;
+    if (cascade != !options.cascade.empty() || (cascade && !options.keyFile.empty())) {
+        std::cerr << "Usa --algo con --key-file o --cascade (que lleva sus propias claves), no los dos.\n";
+        return 2;
+    }
+    const bool fanOut = !options.fanOutKeyFiles.empty();
+    if (fanOut && (cascade || !options.keyFile.empty())) {
+        std::cerr << "--fan-out lleva sus propias claves: usalo con --algo, sin --key-file ni --cascade.\n";
+        return 2;
+    }
+    std::string password;
+    if (!cascade && !fanOut) {
+        if (options.keyFile.empty()) {
+            std::cerr << "Falta la clave: usa --key-file ARCHIVO.\n";
+            return 2;
+        }
+        if (!readKeyFile(options.keyFile, password)) {
+            std::cerr << "Error: No se pudo leer el archivo de clave '" << options.keyFile << "'.\n";
+            return 2;
+        }
+        if (password.empty()) {
+            std::cerr << "La contrasena no puede estar vacia.\n";
+            return 2;
+        }
+    }
+    if (cascade && options.rangeGiven) {
+        std::cerr << "--range necesita un contenedor .cif y --cascade escribe el formato raw.\n";
+        return 2;
+    }
+    std::vector<FanOutKey> fanOutKeys;
+    if (fanOut) {
+        if (!options.encrypting || options.watch || options.inPlace || options.rangeGiven || !options.incrementalFile.empty() ||
+            options.inputPath == "-" || options.outputPath == "-" || options.ioGiven || options.ioStats) {
+            // Cada archivo se lee una vez con iostream para todas sus claves: no usa la
+            // canalización de E/S.
+            std::cerr << "--fan-out solo encripta, necesita --in y --out, y no se combina con --watch, --in-place, --range, --incremental ni las opciones --io.\n";
+            return 2;
+        }
+        std::set<std::string> names;
+        for (const std::string& keyFile : options.fanOutKeyFiles) {
+            FanOutKey key;
+            key.name = fs::path(keyFile).stem().string();
+            if (key.name.empty()) {
+                key.name = fs::path(keyFile).filename().string();
+            }
+            if (!readKeyFile(keyFile, key.password) || key.password.empty()) {
+                std::cerr << "Error: No se pudo leer el archivo de clave '" << keyFile << "' o esta vacio.\n";
+                return 2;
+            }
+            if (!names.insert(key.name).second) {
+                std::cerr << "Dos claves de --fan-out se llaman '" << key.name << "': cada una necesita su propia carpeta de salida.\n";
+                return 2;
+            }
+            fanOutKeys.push_back(key);
+        }
+    }
+    if (options.armor != ArmorFormat::None && (!options.encrypting || options.inPlace)) {
+        // Al desencriptar la armadura se reconoce por su cabecera.
+        std::cerr << "--armor solo se usa al encriptar y no se combina con --in-place.\n";
+        return 2;
+    }
+
+    const std::string inputExt = options.encrypting ? ".txt" : ".cif";
+    const std::string outputExt = options.encrypting ? ".cif" : ".txt";
+
+    // --- Vigilancia: cifrar lo que llegue a una carpeta hasta Ctrl+C ---
+    if (options.watch) {
+        if (!options.encrypting || options.rangeGiven || options.inPlace || !options.incrementalFile.empty() || !options.manifestFile.empty()) {
+            std::cerr << "--watch solo encripta y no se combina con --range, --in-place, --incremental ni --manifest.\n";
+            return 2;
+        }
+#if CRIPTO_INOTIFY
+        if (!fs::is_directory(options.inputPath)) {
+            std::cerr << "Error: La entrada '" << options.inputPath << "' no es una carpeta.\n";
+            return 2;
+        }
+        std::error_code ec;
+        fs::create_directories(options.outputPath, ec);
+        if (!fs::is_directory(options.outputPath)) {
+            std::cerr << "Error: La salida '" << options.outputPath << "' no es una carpeta.\n";
+            return 2;
+        }
+        const std::vector<std::string> patterns = options.patterns.empty() ? std::vector<std::string>{"*" + inputExt} : options.patterns;
+        return runWatch(options.inputPath, options.outputPath, patterns, password, options);
+#else
+        std::cerr << "--watch necesita inotify y solo esta disponible en Linux.\n";
+        return 2;
+#endif
+    }
+
+    // --- Modo filtro: un único flujo desde la entrada estándar o hacia la salida estándar ---
+    const bool inputIsDirectory = options.inputPath != "-" && fs::is_directory(options.inputPath);
+    if (!inputIsDirectory && (options.inputPath == "-" || options.outputPath == "-")) {
+        if (!options.patterns.empty() || !options.manifestFile.empty() || !options.incrementalFile.empty()) {
+            std::cerr << "Los patrones, --manifest e --incremental solo se usan con una carpeta de entrada.\n";
+            return 2;
+        }
+        if (options.rangeGiven && (options.encrypting || options.inputPath == "-")) {
+            std::cerr << "--range solo se usa al desencriptar un archivo (no la entrada estandar).\n";
+            return 2;
+        }
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        std::ios::sync_with_stdio(false);
+        std::ifstream inputFile;
+        std::ofstream outputFile;
+        if (options.inputPath != "-") {
+            inputFile.open(options.inputPath, std::ios::binary);
+            if (!inputFile.is_open()) {
+                std::cerr << "Error: No se pudo leer '" << options.inputPath << "'.\n";
+                return 1;
+            }
+        }
+        if (options.outputPath != "-") {
+            outputFile.open(options.outputPath, std::ios::binary);
+            if (!outputFile.is_open()) {
+                std::cerr << "Error: No se pudo crear '" << options.outputPath << "'.\n";
+                return 1;
+            }
+        }
+        std::istream& input = options.inputPath == "-" ? std::cin : inputFile;
+        std::ostream& output = options.outputPath == "-" ? std::cout : outputFile;
+        const std::string inputName = options.inputPath == "-" ? "<entrada estandar>" : options.inputPath;
+        const std::string outputName = options.outputPath == "-" ? "<salida estandar>" : options.outputPath;
+
+        CipherSettings settings;
+        settings.algorithm = options.cipherChoice;
+        settings.password = password;
+        settings.encrypting = options.encrypting;
+        settings.desKey = DESKey(password);
+        settings.desMode = options.desMode;
+        settings.desThreads = options.jobs == 0 ? BatchExecutor::defaultJobs() : options.jobs;
+        settings.cascade = options.cascade;
+        settings.writeContainer = !options.rawFormat && !cascade;
+        settings.armor = options.armor;
+        settings.chunkThreads = settings.desThreads;
+        settings.rangeGiven = options.rangeGiven;
+        settings.rangeOffset = options.rangeOffset;
+        settings.rangeLength = options.rangeLength;
+
+        std::string error;
+        StreamBuffers buffers;
+        bool ok = dispatchCipher(options.cipherChoice, [&](auto cipherType) {
+            using C = typename decltype(cipherType)::type;
+            if (!settings.encrypting) {
+                C cipher;
+                CifWorkspace<C> workspace;
+                prepareCipher(cipher, settings);
+                // Un archivo armado empieza con '-', que no puede empezar un contenedor.
+                if (input.peek() == '-') {
+                    return decryptArmored(input, output, inputName, outputName, cipher, buffers, workspace, settings, error) ? 1 : 0;
+                }
+                if constexpr (ChunkedCipher<C>) {
+                    return decryptStream(input, output, options.inputPath != "-", inputName, outputName, cipher, buffers, workspace, settings, error) ? 1 : 0;
+                }
+                return streamData(input, output, inputName, outputName, cipher, buffers, error) ? 1 : 0;
+            }
+            return dispatchEncoder<C>(settings, [&](auto encoderType) {
+                typename decltype(encoderType)::type cipher;
+                prepareCipher(cipher, settings);
+                return streamData(input, output, inputName, outputName, cipher, buffers, error) ? 1 : 0;
+            });
+        }) != 0;
+        output.flush();
+        if (!ok) {
+            std::cerr << error;
+            return 1;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    // --- Modo por lotes: archivos de una carpeta (o un único archivo) hacia una carpeta ---
+    if (inputIsDirectory && options.outputPath == "-") {
+        // Varios archivos no caben en la salida estándar.
+        std::cerr << "Una carpeta de entrada necesita --out con la carpeta de salida.\n";
+        return 2;
+    }
+    if (options.rangeGiven && (options.encrypting || inputIsDirectory)) {
+        std::cerr << "--range solo se usa al desencriptar un unico archivo.\n";
+        return 2;
+    }
+    if (options.inPlace && (!CRIPTO_POSIX_IO || options.cipherChoice >= 4 || options.rangeGiven || (options.encrypting && !options.rawFormat))) {
+        // Solo sirve si la salida mide lo mismo que la entrada.
+        std::cerr << "--in-place solo se usa con XOR, Cesar o Vigenere (sin cascada), sin --range y, al encriptar, con --format raw.\n";
+        return 2;
+    }
+    if (options.inPlace && !options.incrementalFile.empty()) {
+        std::cerr << "--in-place e --incremental no se pueden combinar: --in-place no conserva la entrada.\n";
+        return 2;
+    }
+    fs::path inputDir;
+    std::vector<std::string> patterns = options.patterns;
+    if (inputIsDirectory) {
+        inputDir = options.inputPath;
+    } else if (fs::is_regular_file(options.inputPath)) {
+        inputDir = fs::path(options.inputPath).parent_path();
+        patterns = {fs::path(options.inputPath).filename().string()};
+    } else {
+        std::cerr << "Error: La entrada '" << options.inputPath << "' no existe.\n";
+        return 2;
+    }
+    fs::path outputDir = options.outputPath;
+    std::error_code ec;
+    fs::create_directories(outputDir, ec);
+    if (!fs::is_directory(outputDir)) {
+        std::cerr << "Error: La salida '" << options.outputPath << "' no es una carpeta.\n";
+        return 2;
+    }
+#if CRIPTO_POSIX_IO
+    if (options.inPlace && !sameFileSystem(inputDir.empty() ? fs::path(".") : inputDir, outputDir)) {
+        // Un archivo solo se puede renombrar dentro de su sistema de archivos.
+        std::cerr << "--in-place necesita que la entrada y la salida esten en el mismo sistema de archivos.\n";
+        return 2;
+    }
+#endif
+
+    if (!options.manifestFile.empty()) {
+        std::ifstream manifest(options.manifestFile);
+        if (!manifest.is_open()) {
+            std::cerr << "Error: No se pudo leer el manifiesto '" << options.manifestFile << "'.\n";
+            return 2;
+        }
+        std::string line;
+        while (std::getline(manifest, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty() && line[0] != '#') {
+                patterns.push_back(line);
+            }
+        }
+    }
+    if (patterns.empty()) {
+        patterns.push_back("*" + inputExt);
+    }
+
+    // Los patrones se expanden contra la carpeta (ordenada); un nombre sin comodines que
+    // no existe se conserva para que cuente como fallo.
+    std::vector<std::string> entries;
+    for (const auto& entry : fs::directory_iterator(inputDir, ec)) {
+        if (entry.is_regular_file()) {
+            entries.push_back(entry.path().filename().string());
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    std::vector<BatchItem> items;
+    std::set<std::string> seen;
+    for (const std::string& pattern : patterns) {
+        std::vector<std::string> names;
+        if (pattern.find_first_of("*?") == std::string::npos) {
+            names.push_back(pattern);
+        } else {
+            for (const std::string& entry : entries) {
+                if (matchesPattern(pattern, entry)) {
+                    names.push_back(entry);
+                }
+            }
+        }
+        for (const std::string& name : names) {
+            if (!seen.insert(name).second) {
+                continue;
+            }
+            // a.txt <-> a.cif como en el menú; otros archivos conservan su extensión (a.jpg <-> a.jpg.cif).
+            fs::path namePath(name);
+            BatchItem item;
+            item.inputFile = inputDir / name;
+            item.outputExt = (options.encrypting || namePath.stem().extension().empty()) ? outputExt : "";
+            item.outputStem = (namePath.extension() == inputExt) ? namePath.stem().string() : name;
+            items.push_back(item);
+        }
+    }
+    if (items.empty()) {
+        std::cerr << "No hay archivos que coincidan en '" << inputDir.string() << "'.\n";
+        return 1;
+    }
+
+    int failures = fanOut ? runFanOut(items, outputDir, fanOutKeys, options)
+                          : runBatch(items, outputDir, password, options.encrypting, options.cipherChoice, options.desMode, options);
+    return failures == 0 ? EXIT_SUCCESS : 1;
+}
+
+/**
+ * @brief Compara un nombre de archivo con un patrón con comodines `*` y `?`.
+ */
+bool matchesPattern(const std::string& pattern, const std::string& name) {
+    size_t p = 0;
+    size_t n = 0;
+    size_t starPattern = std::string::npos;
+    size_t starName = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            ++p;
+            ++n;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            starPattern = p++;
+            starName = n;
+        } else if (starPattern != std::string::npos) {
+            p = starPattern + 1;
+            n = ++starName;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+/**
+ * @brief Convierte el nombre de un modo DES (ecb, cbc, ctr) en su valor.
+ * @return Falso si el nombre no corresponde a ningún modo.
+ */
+bool parseDESMode(const std::string& text, DESMode& mode) {
+    if (text == "ecb" || text == "ECB") {
+        mode = DESMode::ECB;
+    } else if (text == "cbc" || text == "CBC") {
+        mode = DESMode::CBC;
+    } else if (text == "ctr" || text == "CTR") {
+        mode = DESMode::CTR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 /**
  * @brief Gestiona el bucle principal del menú y las acciones del usuario.
  */
-void handleUserChoice(const fs::path& desencriptadosPath, const fs::path& encriptadosPath) {
+void handleUserChoice(const fs::path& desencriptadosPath, const fs::path& encriptadosPath, const CommandLineOptions& options) {
     int mainChoice = 0;
     while (mainChoice != 3) {
         // --- Bucle del Menú Principal ---
@@ -63,9 +963,13 @@ void handleUserChoice(const fs::path& desencriptadosPath, const fs::path& encrip
         std::cout << "Por favor, elige una operacion:\n"
                   << "  1. Encriptar archivo(s) (.txt -> .cif)\n"
                   << "  2. Desencriptar archivo(s) (.cif -> .txt)\n"
-                  << "  3. Salir\n" << std::endl;
+                  << "  3. Salir\n"
+                  << "  4. Recuperar clave de archivo(s) cifrado(s) (.cif -> .txt)\n" << std::endl;
         std::cout << "Tu eleccion: " << std::flush;
         mainChoice = getChoiceFromUser();
+        if (!std::cin) {
+            break; // Fin de la entrada: no hay nadie que pueda elegir otra opción.
+        }
 
         // --- Lógica de Selección ---
         if (mainChoice == 1 || mainChoice == 2) {
@@ -90,14 +994,38 @@ void handleUserChoice(const fs::path& desencriptadosPath, const fs::path& encrip
                 const auto& outputDir = (mainChoice == 1) ? encriptadosPath : desencriptadosPath;
                 const std::string inputExt = (mainChoice == 1) ? ".txt" : ".cif";
                 const std::string outputExt = (mainChoice == 1) ? ".cif" : ".txt";
-                std::string op = (mainChoice == 1) ? "encriptar" : "desencriptar";
-                processFiles(inputDir, outputDir, inputExt, outputExt, op, cipherChoice);
+                processFiles(inputDir, outputDir, inputExt, outputExt, mainChoice == 1, cipherChoice, options);
             } else if (cipherChoice == 5) {
                 continue; // Vuelve al inicio del bucle while
             } else {
                  std::cout << "\nOpcion de algoritmo no valida." << std::endl;
             }
 
+        } else if (mainChoice == 4) {
+            // --- Menú de Criptoanálisis (después de Salir, para no cambiar su número) ---
+            std::cout << "========================================\n";
+            std::cout << "      Aplicacion de Criptografia\n";
+            std::cout << "========================================\n\n" << std::flush;
+
+            std::cout << "Selecciona el algoritmo con el que se cifro el archivo:\n"
+                      << "  1. XOR\n"
+                      << "  2. Cesar\n"
+                      << "  3. Vigenere\n"
+                      << "  4. DES (diccionario o mascara)\n"
+                      << "  5. Volver al menu principal\n" << std::endl;
+            std::cout << "Tu eleccion: " << std::flush;
+            int cipherChoice = getChoiceFromUser();
+
+            if (cipherChoice >= 1 && cipherChoice <= 3) {
+                recoverKeys(encriptadosPath, desencriptadosPath, cipherChoice, options);
+            } else if (cipherChoice == 4) {
+                recoverDESKey(encriptadosPath, desencriptadosPath, options);
+            } else if (cipherChoice == 5) {
+                continue;
+            } else {
+                std::cout << "\nOpcion de algoritmo no valida." << std::endl;
+            }
+
         } else if (mainChoice != 3) {
             std::cout << "\nOpcion principal no valida." << std::endl;
         }
@@ -114,14 +1042,14 @@ void handleUserChoice(const fs::path& desencriptadosPath, const fs::path& encrip
 
 
 /**
- * @brief Procesa archivos para encriptar o desencriptar según el algoritmo elegido.
+ * @brief Pregunta los archivos y la clave y los encripta o desencripta con runBatch().
  */
-void processFiles(const fs::path& inputDir, const fs::path& outputDir, const std::string& inputExt, const std::string& outputExt, const std::string& operation, int cipherChoice) {
+void processFiles(const fs::path& inputDir, const fs::path& outputDir, const std::string& inputExt, const std::string& outputExt, bool encrypting, int cipherChoice, const CommandLineOptions& options) {
     std::cout << "========================================\n";
     std::cout << "      Aplicacion de Criptografia\n";
     std::cout << "========================================\n\n" << std::flush;
 
-    std::cout << "Operacion: " << operation << " con algoritmo " << (cipherChoice == 1 ? "XOR" : cipherChoice == 2 ? "Cesar" : cipherChoice == 3 ? "Vigenere" : "DES") << "\n";
+    std::cout << "Operacion: " << (encrypting ? "encriptar" : "desencriptar") << " con algoritmo " << (cipherChoice == 1 ? "XOR" : cipherChoice == 2 ? "Cesar" : cipherChoice == 3 ? "Vigenere" : "DES") << "\n";
 
     std::cout << "\nIntroduce el/los nombre(s) de archivo(s) en '" << inputDir.string() << "' (separados por espacios, sin extension):\n> " << std::flush;
     std::string line;
@@ -136,86 +1064,1636 @@ void processFiles(const fs::path& inputDir, const fs::path& outputDir, const std
         return;
     }
 
+    // Al desencriptar, el modo DES se detecta en la cabecera de cada archivo.
+    DESMode desMode = options.desMode;
+    if (cipherChoice == 4 && encrypting && !options.desModeGiven) {
+        std::cout << "Modo DES: 1. ECB  2. CBC  3. CTR (Enter = ECB):\n> " << std::flush;
+        int modeChoice = getChoiceFromUser();
+        desMode = (modeChoice == 2) ? DESMode::CBC : (modeChoice == 3) ? DESMode::CTR : DESMode::ECB;
+    }
+
     std::stringstream ss(line);
     std::string filename;
-    int successCount = 0;
-    int failCount = 0;
+    std::vector<BatchItem> items;
+    while (ss >> filename) {
+        items.push_back(BatchItem{inputDir / (filename + inputExt), filename, outputExt});
+    }
+    runBatch(items, outputDir, password, encrypting, cipherChoice, desMode, options);
+}
 
-    XOREncoder xorEncoder;
-    CesarEncoder cesarEncoder;
-    VigenereEncoder vigenereEncoder;
-    DESEncoder desEncoder;
+/**
+ * @brief Encripta o desencripta un lote de archivos con la misma clave.
+ *
+ * Primero se validan las entradas y se reservan los nombres de salida en el orden del
+ * lote; después los archivos se procesan en paralelo con un codificador por hilo. Los
+ * mensajes se imprimen en el mismo orden que la entrada.
+ *
+ * Con --incremental las salidas tienen siempre el mismo nombre y solo se procesan los
+ * archivos que cambiaron desde la ejecución anterior según el registro de cambios (ver
+ * ChangeManifest); los que no cambiaron ni siquiera se abren.
+ * @return El número de archivos que fallaron.
+ */
+int runBatch(const std::vector<BatchItem>& items, const fs::path& outputDir, const std::string& password, bool encrypting, int cipherChoice, DESMode desMode, const CommandLineOptions& options) {
+    BatchExecutor executor(options.jobs);
+    CipherSettings settings;
+    settings.algorithm = cipherChoice;
+    settings.password = password;
+    settings.encrypting = encrypting;
+    // La clave DES se expande una sola vez y se comparte en modo lectura entre los hilos.
+    settings.desKey = DESKey(password);
+    settings.desMode = desMode;
+    settings.cascade = options.cascade;
+    settings.writeContainer = !options.rawFormat && cipherChoice != 5;
+    settings.armor = options.armor;
+    settings.rangeGiven = options.rangeGiven;
+    settings.rangeOffset = options.rangeOffset;
+    settings.rangeLength = options.rangeLength;
+    settings.io = options.io;
+    settings.ioStats = options.ioStats;
+    settings.inPlace = options.inPlace;
+    if (settings.inPlace) {
+        settings.io.backend = IOBackend::Mmap;
+    }
 
-    while (ss >> filename) {
-        fs::path inputFile = inputDir / (filename + inputExt);
+    const bool incremental = !options.incrementalFile.empty();
+    ChangeManifest manifest;
+    if (incremental) {
+        std::string error;
+        if (!manifest.load(options.incrementalFile, error)) {
+            std::cerr << "Aviso: El registro '" << options.incrementalFile << "' no se pudo usar (" << error << "); se procesa todo.\n";
+        }
+        // La clave se registra solo como comprobación salada, igual que en los contenedores.
+        const uint64_t keyCheck = CifContainer::computeKeyCheck(manifest.salt(), static_cast<uint8_t>(cipherChoice), keyCheckMaterial(settings));
+        std::string configuration = std::string(encrypting ? "encriptar " : "desencriptar ") + algorithmName(cipherChoice);
+        if (encrypting) {
+            configuration += std::string(settings.writeContainer ? " cif" : " raw") + " modo " + std::to_string(static_cast<int>(desMode));
+            if (settings.armor != ArmorFormat::None) {
+                configuration += std::string(" armadura ") + Armor::name(settings.armor);
+            }
+        }
+        configuration += " clave " + std::to_string(keyCheck);
+        if (manifest.setConfiguration(configuration)) {
+            std::cout << "La configuracion o la clave cambiaron desde la ultima ejecucion: se procesa todo.\n";
+        }
+    }
 
-        if (!fs::exists(inputFile)) {
-            std::cerr << "Error: El archivo '" << inputFile.string() << "' no existe. Omitiendo.\n";
-            failCount++;
+    // --- Planificación secuencial: entradas y nombres de salida ---
+    std::vector<FileTask> tasks;
+    std::set<fs::path> reservedOutputs;
+    size_t skippedCount = 0;
+    // Fuera del modo incremental, cada hilo reserva un nombre libre justo antes de escribir.
+    std::optional<OutputNamer> namer;
+    if (!incremental) {
+        namer.emplace(outputDir);
+    }
+
+    for (const BatchItem& item : items) {
+        FileTask task;
+        task.inputFile = item.inputFile;
+        task.outputStem = item.outputStem;
+        task.outputExt = item.outputExt;
+        if (!fs::exists(task.inputFile)) {
+            task.missing = true;
+            tasks.push_back(task);
             continue;
         }
 
-        std::string content = readFileContents(inputFile);
-        if (content.empty() && fs::is_regular_file(inputFile) && fs::file_size(inputFile) > 0) {
-             std::cerr << "Error: No se pudo leer el contenido de '" << inputFile.string() << "'. Omitiendo.\n";
-             failCount++;
-             continue;
+        if (incremental) {
+            // La salida anterior se reemplaza: solo se evitan choques dentro del lote.
+            fs::path outputFile = outputDir / (item.outputStem + item.outputExt);
+            int suffix = 1;
+            while (reservedOutputs.count(outputFile) > 0) {
+                outputFile = outputDir / (item.outputStem + "-" + std::to_string(suffix) + item.outputExt);
+                suffix++;
+            }
+            reservedOutputs.insert(outputFile);
+
+            // Cada consulta con su propio código de error: si una falla, el archivo se trata
+            // como cambiado y no se registra con un tamaño o una fecha inventados.
+            std::error_code sizeError;
+            std::error_code timeError;
+            const std::string name = task.inputFile.filename().string();
+            task.entry.size = fs::file_size(task.inputFile, sizeError);
+            task.entry.modified = ChangeManifest::modificationTime(task.inputFile, timeError);
+            task.entry.output = outputFile.filename().string();
+            task.statFailed = static_cast<bool>(sizeError) || static_cast<bool>(timeError);
+            const ChangeManifest::Entry* previous = manifest.find(name);
+            if (!task.statFailed && previous != nullptr && previous->output == task.entry.output && fs::exists(outputFile)) {
+                if (previous->size == task.entry.size && previous->modified == task.entry.modified) {
+                    skippedCount++;
+                    continue;
+                }
+                // Con el mismo tamaño puede que solo haya cambiado la fecha: lo dirá el resumen.
+                task.hasPreviousHash = previous->size == task.entry.size;
+                task.previousHash = previous->hash;
+            }
+            task.finalOutputFile = outputFile;
+            task.outputFile = outputDir / ("." + task.entry.output + ".tmp");
         }
+        tasks.push_back(task);
+    }
 
-        std::string processedContent;
+    // --- Procesamiento en paralelo ---
+    // Los núcleos que sobran cuando hay menos archivos que hilos se usan dentro de DES.
+    unsigned int desThreads = static_cast<unsigned int>(std::max<size_t>(1, executor.jobs() / std::max<size_t>(1, tasks.size())));
+    settings.desThreads = desThreads;
+    settings.chunkThreads = desThreads;
 
-        switch(cipherChoice) {
-            case 1:
-                processedContent = xorEncoder.encode(content, password);
-                break;
-            case 2:
-                processedContent = (operation == "encriptar") ? cesarEncoder.encode(content, password) : cesarEncoder.decode(content, password);
-                break;
-            case 3:
-                processedContent = (operation == "encriptar") ? vigenereEncoder.encode(content, password) : vigenereEncoder.decode(content, password);
-                break;
-            case 4:
-                processedContent = (operation == "encriptar") ? desEncoder.encode(content, password) : desEncoder.decode(content, password);
-                break;
+    int failCount = dispatchCipher(cipherChoice, [&](auto cipherType) {
+        using C = typename decltype(cipherType)::type;
+        if (encrypting) {
+            return dispatchEncoder<C>(settings, [&](auto encoderType) {
+                return processTasks<typename decltype(encoderType)::type>(tasks, executor, settings, namer ? &*namer : nullptr);
+            });
         }
+        return processTasks<C>(tasks, executor, settings, namer ? &*namer : nullptr);
+    });
+    int successCount = static_cast<int>(tasks.size()) - failCount;
 
-        fs::path baseOutputFile = outputDir / (filename + outputExt);
-        fs::path outputFile = baseOutputFile;
-        int suffix = 1;
-        while (fs::exists(outputFile)) {
-            outputFile = outputDir / (filename + "-" + std::to_string(suffix) + outputExt);
-            suffix++;
+    size_t unchangedCount = skippedCount;
+    size_t prunedCount = 0;
+    if (incremental) {
+        for (const FileTask& task : tasks) {
+            if (task.recorded) {
+                manifest.set(task.inputFile.filename().string(), task.entry);
+                unchangedCount += task.unchanged ? 1 : 0;
+            } else {
+                // Un fallo se vuelve a intentar en la siguiente ejecución.
+                manifest.erase(task.inputFile.filename().string());
+            }
+        }
+        successCount -= static_cast<int>(unchangedCount - skippedCount);
+        if (!items.empty()) {
+            prunedCount = manifest.prune(items.front().inputFile.parent_path());
+        }
+        std::string error;
+        if (!manifest.save(options.incrementalFile, error)) {
+            std::cerr << "Error: No se pudo guardar el registro '" << options.incrementalFile << "': " << error << ".\n";
+            failCount++;
         }
-        writeFileContents(outputFile, processedContent);
-
-        std::cout << "Proceso completado: '" << inputFile.string() << "' -> '" << outputFile.string() << "'\n";
-        successCount++;
     }
 
     std::cout << "\n--- Resumen de la operacion ---\n";
     std::cout << "Archivos procesados con exito: " << successCount << "\n";
+    if (incremental) {
+        std::cout << "Archivos sin cambios: " << unchangedCount << "\n";
+        if (prunedCount > 0) {
+            std::cout << "Archivos que ya no existen (se conservan sus salidas): " << prunedCount << "\n";
+        }
+    }
     std::cout << "Archivos fallidos: " << failCount << "\n";
+    return failCount;
 }
 
 
 /**
- * @brief Lee todo el contenido de un archivo y lo devuelve como un string.
+ * @brief Procesa en paralelo las tareas de runBatch() con el codificador `C`.
+ *
+ * Cada hilo prepara su codificador y sus buffers con su primer archivo y los reutiliza
+ * en los siguientes con restart(), así que no se reserva memoria ni se expande la clave
+ * por archivo. En un lote incremental cada archivo se escribe en un temporal que
+ * reemplaza a la salida anterior solo si todo fue bien.
+ * @return El número de archivos que fallaron.
  */
-std::string readFileContents(const fs::path& filePath) {
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file.is_open()) return "";
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
-}
+template <Cipher C>
+int processTasks(std::vector<FileTask>& tasks, const BatchExecutor& executor, const CipherSettings& settings, OutputNamer* namer) {
+    struct Worker {
+        C cipher;
+        StreamBuffers buffers;
+        CifWorkspace<C> chunks;
+        bool prepared = false;
+    };
+
+    std::vector<Worker> workers(executor.jobs());
+    OrderedReporter reporter(tasks.size());
+    std::atomic<int> failCount{0};
+
+    executor.run(tasks.size(), [&](size_t index, unsigned int workerId) {
+        FileTask& task = tasks[index];
+        if (task.missing) {
+            failCount++;
+            reporter.report(index, "Error: El archivo '" + task.inputFile.string() + "' no existe. Omitiendo.\n", true);
+            return;
+        }
+
+        CRIPTO_TRACE_SCOPE(fileScope, Trace::FILE_STAGE, algorithmName(settings.algorithm));
+        Worker& worker = workers[workerId];
+        std::string error;
+        if (task.outputFile.empty()) {
+            CRIPTO_TRACE_SCOPE(nameScope, "reservar nombre", "lote");
+            task.outputFile = namer->claim(task.outputStem, task.outputExt, error);
+            if (task.outputFile.empty()) {
+                failCount++;
+                reporter.report(index, "Error: No se pudo crear el archivo de salida de '" + task.inputFile.string() + "': " + error + ". Omitiendo.\n", true);
+                return;
+            }
+        }
+        const bool incremental = !task.finalOutputFile.empty();
+        // Solo streamFile() lee la entrada entera y en orden por transform(): ahí el resumen
+        // se calcula en la misma lectura. Se lee aparte solo si el contenido puede no haber
+        // cambiado (mismo tamaño, otra fecha) o si el archivo va por otro camino.
+        bool streamed = false;
+        if (!settings.inPlace) {
+            if constexpr (ChunkedCipher<C>) {
+                streamed = settings.encrypting;
+            } else {
+                streamed = settings.encrypting || !isArmoredFile(task.inputFile);
+            }
+        }
+        const bool hashWhileStreaming = incremental && streamed && !task.hasPreviousHash;
+        if (incremental && !hashWhileStreaming) {
+            CRIPTO_TRACE_SCOPE(hashScope, "resumen XXH64", "lote");
+            CRIPTO_TRACE_BYTES(hashScope, task.entry.size);
+            if (!ChangeManifest::hashFile(task.inputFile, worker.buffers.input, task.entry.hash, error)) {
+                failCount++;
+                reporter.report(index, error, true);
+                return;
+            }
+            if (task.hasPreviousHash && task.entry.hash == task.previousHash) {
+                task.recorded = true;
+                task.unchanged = true;
+                reporter.report(index, "Sin cambios (solo cambio la fecha): '" + task.inputFile.string() + "'\n", false);
+                return;
+            }
+        }
+        if (worker.prepared) {
+            worker.cipher.restart();
+        } else {
+            CRIPTO_TRACE_SCOPE(keyScope, "preparar clave", algorithmName(settings.algorithm));
+            prepareCipher(worker.cipher, settings);
+            worker.buffers.pipeline.configure(settings.io);
+            worker.prepared = true;
+        }
+        worker.buffers.pipeline.resetStats();
 
+        bool ok = false;
+        if (settings.inPlace) {
+#if CRIPTO_POSIX_IO
+            if constexpr (InPlaceCipher<C>) {
+                ok = transformFileInPlace(task.inputFile, task.outputFile, worker.cipher, worker.buffers, settings, error);
+            }
+#endif
+        } else if (hashWhileStreaming) {
+            HashingCipher<C> hashing(worker.cipher);
+            ok = streamFile(task.inputFile, task.outputFile, hashing, worker.buffers, error);
+            task.entry.hash = hashing.digest();
+        } else if (streamed) {
+            ok = streamFile(task.inputFile, task.outputFile, worker.cipher, worker.buffers, error);
+        } else if constexpr (ChunkedCipher<C>) {
+            ok = decryptFile(task.inputFile, task.outputFile, worker.cipher, worker.buffers, worker.chunks, settings, error);
+        } else {
+            ok = decryptArmoredFile(task.inputFile, task.outputFile, worker.cipher, worker.buffers, worker.chunks, settings, error);
+        }
+        if (incremental) {
+            std::error_code ec;
+            if (ok) {
+                fs::rename(task.outputFile, task.finalOutputFile, ec);
+                if (ec) {
+                    ok = false;
+                    error = "Error: No se pudo reemplazar '" + task.finalOutputFile.string() + "': " + ec.message() + ".\n";
+                }
+            }
+            if (!ok) {
+                fs::remove(task.outputFile, ec);
+            }
+            task.recorded = ok && !task.statFailed;
+        }
+        if (!ok) {
+            failCount++;
+            reporter.report(index, error, true);
+            return;
+        }
+#if CRIPTO_ENABLE_TRACE
+        std::error_code sizeError;
+        CRIPTO_TRACE_BYTES(fileScope, fs::file_size(task.inputFile, sizeError));
+#endif
+        const fs::path& outputFile = incremental ? task.finalOutputFile : task.outputFile;
+        std::string message = "Proceso completado: '" + task.inputFile.string() + "' -> '" + outputFile.string() + "'\n";
+        if (settings.ioStats && worker.buffers.pipeline.stats().seconds > 0) {
+            message += "  E/S con " + worker.buffers.pipeline.stats().describe() + "\n";
+        }
+        reporter.report(index, message, false);
+    });
+    return failCount;
+}
 
 /**
- * @brief Escribe un string en un archivo, sobreescribiéndolo si ya existe.
+ * @brief Encripta cada archivo con varias claves a la vez (--fan-out): la salida de cada
+ * clave va a su propia subcarpeta de `outputDir`, con el mismo nombre que tendría en un
+ * lote normal.
+ *
+ * Las claves se expanden una sola vez al empezar (en DES, su planificación de subclaves)
+ * y se comparten en modo lectura entre los hilos. Si hay menos archivos que hilos, las
+ * claves de cada archivo se reparten en grupos que se procesan en paralelo; cada grupo
+ * lee el archivo una vez.
+ * @return El número de archivos con alguna salida fallida.
  */
-void writeFileContents(const fs::path& filePath, const std::string& content) {
-    std::ofstream file(filePath, std::ios::binary);
-    if (file.is_open()) {
-        file << content;
+int runFanOut(const std::vector<BatchItem>& items, const fs::path& outputDir, const std::vector<FanOutKey>& keys, const CommandLineOptions& options) {
+    BatchExecutor executor(options.jobs);
+    const size_t groups = std::clamp<size_t>(executor.jobs() / items.size(), 1, keys.size());
+
+    CipherSettings base;
+    base.algorithm = options.cipherChoice;
+    base.encrypting = true;
+    base.desMode = options.desMode;
+    base.writeContainer = !options.rawFormat && options.cipherChoice != 5;
+    base.armor = options.armor;
+    base.desThreads = static_cast<unsigned int>(std::max<size_t>(1, executor.jobs() / (items.size() * groups)));
+
+    std::vector<CipherSettings> keySettings;
+    std::vector<std::unique_ptr<OutputNamer>> namers;
+    for (const FanOutKey& key : keys) {
+        CipherSettings& settings = keySettings.emplace_back(base);
+        settings.password = key.password;
+        settings.desKey = DESKey(key.password);
+        const fs::path directory = outputDir / key.name;
+        std::error_code ec;
+        fs::create_directories(directory, ec);
+        if (!fs::is_directory(directory)) {
+            std::cerr << "Error: No se pudo crear la carpeta de salida '" << directory.string() << "'.\n";
+            return static_cast<int>(items.size());
+        }
+        namers.push_back(std::make_unique<OutputNamer>(directory));
     }
-}
\ No newline at end of file
+
+    size_t writtenOutputs = 0;
+    const int failCount = dispatchCipher(options.cipherChoice, [&](auto cipherType) {
+        return dispatchEncoder<typename decltype(cipherType)::type>(base, [&](auto encoderType) {
+            return fanOutTasks<typename decltype(encoderType)::type>(items, groups, executor, keys, keySettings, namers, writtenOutputs);
+        });
+    });
+
+    std::cout << "\n--- Resumen de la operacion ---\n";
+    std::cout << "Archivos procesados con exito: " << items.size() - static_cast<size_t>(failCount) << "\n";
+    std::cout << "Archivos fallidos: " << failCount << "\n";
+    std::cout << "Salidas escritas: " << writtenOutputs << " (" << keys.size() << " claves)\n";
+    return failCount;
+}
+
+/**
+ * @brief Procesa en paralelo las tareas de runFanOut() con el codificador `C`. Cada tarea
+ * es un archivo y un grupo de claves.
+ *
+ * Cada fragmento se lee una vez y pasa por los codificadores de todas las claves del
+ * grupo seguidos, mientras sigue en la caché; las salidas se escriben después, para que
+ * la escritura no lo desaloje. Como en processTasks(), cada hilo prepara sus
+ * codificadores con su primer archivo y los reutiliza con restart().
+ * @param writtenOutputs Recibe el número de salidas escritas.
+ * @return El número de archivos con alguna salida fallida.
+ */
+template <Cipher C>
+int fanOutTasks(const std::vector<BatchItem>& items, size_t groups, const BatchExecutor& executor, const std::vector<FanOutKey>& keys,
+                const std::vector<CipherSettings>& keySettings, std::vector<std::unique_ptr<OutputNamer>>& namers, size_t& writtenOutputs) {
+    struct Worker {
+        std::vector<C> ciphers;
+        std::vector<bool> prepared;
+        std::vector<std::byte> input;
+        std::vector<std::vector<std::byte>> outputs;
+    };
+
+    const size_t keyCount = keySettings.size();
+    std::vector<Worker> workers(executor.jobs());
+    OrderedReporter reporter(items.size() * groups);
+    // Un archivo cuenta como fallido una sola vez, aunque fallen varios de sus grupos.
+    std::vector<std::atomic<bool>> itemFailed(items.size());
+    std::atomic<size_t> written{0};
+
+    executor.run(items.size() * groups, [&](size_t index, unsigned int workerId) {
+        const BatchItem& item = items[index / groups];
+        const size_t group = index % groups;
+        const size_t firstKey = group * keyCount / groups;
+        const size_t lastKey = (group + 1) * keyCount / groups;
+        std::ifstream input(item.inputFile, std::ios::binary);
+        if (!input.is_open()) {
+            itemFailed[index / groups] = true;
+            reporter.report(index, group == 0 ? "Error: El archivo '" + item.inputFile.string() + "' no existe. Omitiendo.\n" : "", true);
+            return;
+        }
+
+        CRIPTO_TRACE_SCOPE(fileScope, Trace::FILE_STAGE, algorithmName(keySettings.front().algorithm));
+        Worker& worker = workers[workerId];
+        if (worker.ciphers.empty()) {
+            worker.ciphers.resize(keyCount);
+            worker.prepared.assign(keyCount, false);
+            worker.outputs.resize(keyCount);
+            worker.input.resize(STREAM_CHUNK_SIZE);
+        }
+
+        std::string message;
+        std::vector<fs::path> outputFiles(lastKey);
+        std::vector<std::ofstream> outputs(lastKey);
+        std::vector<bool> failed(lastKey, false);
+        auto fail = [&](size_t key, const std::string& reason) {
+            failed[key] = true;
+            message += "Error: '" + item.inputFile.string() + "' con la clave '" + keys[key].name + "': " + reason + ".\n";
+        };
+        for (size_t key = firstKey; key < lastKey; ++key) {
+            std::string error;
+            {
+                CRIPTO_TRACE_SCOPE(nameScope, "reservar nombre", "lote");
+                outputFiles[key] = namers[key]->claim(item.outputStem, item.outputExt, error);
+            }
+            if (outputFiles[key].empty()) {
+                fail(key, "no se pudo crear la salida (" + error + ")");
+                continue;
+            }
+            outputs[key].open(outputFiles[key], std::ios::binary | std::ios::trunc);
+            if (!outputs[key].is_open()) {
+                fail(key, "no se pudo abrir '" + outputFiles[key].string() + "'");
+                continue;
+            }
+            if (worker.prepared[key]) {
+                worker.ciphers[key].restart();
+            } else {
+                CRIPTO_TRACE_SCOPE(keyScope, "preparar clave", algorithmName(keySettings[key].algorithm));
+                prepareCipher(worker.ciphers[key], keySettings[key]);
+                worker.outputs[key].resize(worker.ciphers[key].outputBound(STREAM_CHUNK_SIZE));
+                worker.prepared[key] = true;
+            }
+        }
+
+        std::vector<size_t> produced(lastKey, 0);
+        auto writeOutputs = [&]() {
+            CRIPTO_TRACE_SCOPE(writeScope, "escribir", "fan-out");
+            for (size_t key = firstKey; key < lastKey; ++key) {
+                if (!failed[key] && !outputs[key].write(reinterpret_cast<const char*>(worker.outputs[key].data()), static_cast<std::streamsize>(produced[key]))) {
+                    fail(key, "no se pudo escribir '" + outputFiles[key].string() + "'");
+                }
+            }
+        };
+        uint64_t totalRead = 0;
+        while (true) {
+            size_t chunkSize;
+            {
+                CRIPTO_TRACE_SCOPE(readScope, "leer", "fan-out");
+                input.read(reinterpret_cast<char*>(worker.input.data()), static_cast<std::streamsize>(worker.input.size()));
+                chunkSize = static_cast<size_t>(input.gcount());
+                CRIPTO_TRACE_BYTES(readScope, chunkSize);
+            }
+            if (chunkSize == 0) {
+                break;
+            }
+            totalRead += chunkSize;
+            const auto chunk = std::span<const std::byte>(worker.input).first(chunkSize);
+            {
+                CRIPTO_TRACE_SCOPE(transformScope, "cifrar", "fan-out");
+                CRIPTO_TRACE_BYTES(transformScope, chunkSize * (lastKey - firstKey));
+                for (size_t key = firstKey; key < lastKey; ++key) {
+                    produced[key] = failed[key] ? 0 : worker.ciphers[key].transform(chunk, worker.outputs[key]);
+                }
+            }
+            writeOutputs();
+        }
+        if (input.bad()) {
+            for (size_t key = firstKey; key < lastKey; ++key) {
+                if (!failed[key]) {
+                    fail(key, "no se pudo leer la entrada");
+                }
+            }
+        }
+        for (size_t key = firstKey; key < lastKey; ++key) {
+            if (!failed[key]) {
+                // finish() de un contenedor escribe el índice, que crece con el archivo.
+                worker.outputs[key].resize(std::max(worker.outputs[key].size(), worker.ciphers[key].outputBound(0)));
+                produced[key] = worker.ciphers[key].finish(worker.outputs[key]);
+            }
+        }
+        writeOutputs();
+        CRIPTO_TRACE_BYTES(fileScope, totalRead);
+
+        size_t succeeded = 0;
+        for (size_t key = firstKey; key < lastKey; ++key) {
+            if (outputs[key].is_open()) {
+                outputs[key].close();
+            }
+            if (failed[key] || outputs[key].fail()) {
+                if (!failed[key]) {
+                    fail(key, "no se pudo escribir '" + outputFiles[key].string() + "'");
+                }
+                std::error_code ec;
+                if (!outputFiles[key].empty()) {
+                    fs::remove(outputFiles[key], ec);
+                }
+                continue;
+            }
+            succeeded++;
+        }
+        written += succeeded;
+        if (succeeded < lastKey - firstKey) {
+            itemFailed[index / groups] = true;
+        }
+        std::string summary = "Proceso completado: '" + item.inputFile.string() + "' -> " + std::to_string(succeeded) + " salidas";
+        if (groups > 1) {
+            summary += " (claves " + std::to_string(firstKey + 1) + "-" + std::to_string(lastKey) + ")";
+        }
+        reporter.report(index, summary + "\n" + message, !message.empty());
+    });
+
+    writtenOutputs = written;
+    int failCount = 0;
+    for (const auto& flag : itemFailed) {
+        failCount += flag ? 1 : 0;
+    }
+    return failCount;
+}
+
+#if CRIPTO_INOTIFY
+/**
+ * @brief Vigila la carpeta de entrada (--watch) y cifra cada archivo que llega o cambia,
+ * hasta que se pulsa Ctrl+C.
+ * @return El código de salida del programa.
+ */
+int runWatch(const fs::path& inputDir, const fs::path& outputDir, const std::vector<std::string>& patterns, const std::string& password, const CommandLineOptions& options) {
+    CipherSettings settings;
+    settings.algorithm = options.cipherChoice;
+    settings.password = password;
+    settings.encrypting = true;
+    // La clave se expande una vez para todo lo que dure la vigilancia.
+    settings.desKey = DESKey(password);
+    settings.desMode = options.desMode;
+    settings.cascade = options.cascade;
+    settings.writeContainer = !options.rawFormat && options.cipherChoice != 5;
+    settings.armor = options.armor;
+    settings.io = options.io;
+    settings.ioStats = options.ioStats;
+
+    return dispatchCipher(options.cipherChoice, [&](auto cipherType) {
+        return dispatchEncoder<typename decltype(cipherType)::type>(settings, [&](auto encoderType) {
+            return watchDirectory<typename decltype(encoderType)::type>(inputDir, outputDir, patterns, settings, options);
+        });
+    });
+}
+
+/**
+ * @brief Bucle de --watch con el codificador `C`.
+ *
+ * El hilo principal lee los eventos de inotify y junta los de cada archivo hasta que
+ * pasan `--watch-delay` ms sin novedades; entonces lo pasa a una cola de capacidad fija
+ * que vacían los hilos de trabajo. Cada hilo prepara su codificador (con la clave ya
+ * expandida) al arrancar y lo reutiliza con restart() para todos los archivos, igual
+ * que processTasks(). Si la cola se llena, el hilo principal espera y deja de leer
+ * eventos, que se acumulan en el núcleo; si el núcleo los pierde, se recorre la carpeta
+ * de nuevo. Un archivo no se vuelve a encolar mientras otro hilo lo está cifrando.
+ *
+ * Cada salida se escribe en un temporal que la reemplaza al terminar, como en
+ * --incremental. La latencia de cada archivo va desde su cierre (su fecha de
+ * modificación) hasta que su salida está escrita; la de los que ya estaban al empezar,
+ * o que llegan con una fecha anterior, se cuenta desde que se detectan.
+ * @return 0 si todos los archivos se cifraron, 1 si alguno falló.
+ */
+template <Cipher C>
+int watchDirectory(const fs::path& inputDir, const fs::path& outputDir, const std::vector<std::string>& patterns, const CipherSettings& settings, const CommandLineOptions& options) {
+    using SteadyClock = std::chrono::steady_clock;
+    using FileClock = fs::file_time_type::clock;
+
+    struct Job {
+        std::string name;
+        fs::file_time_type closedAt;  ///< Cierre del archivo (o cuándo se detectó).
+    };
+    struct Pending {
+        SteadyClock::time_point lastEvent;
+        fs::file_time_type detectedAt;
+    };
+
+    DirectoryWatcher watcher;
+    std::string error;
+    if (!watcher.open(inputDir, error)) {
+        std::cerr << "Error: No se pudo vigilar '" << inputDir.string() << "': " << error << ".\n";
+        return 1;
+    }
+
+    const unsigned int jobs = options.jobs == 0 ? BatchExecutor::defaultJobs() : options.jobs;
+    const auto delay = std::chrono::milliseconds(options.watchDelay);
+    const fs::file_time_type startedAt = FileClock::now();
+    BoundedQueue<Job> queue(options.watchQueue == 0 ? 4 * jobs : options.watchQueue);
+
+    std::mutex stateMutex;
+    std::set<std::string> busy;      // En la cola o cifrándose.
+    std::vector<double> latencies;   // Milisegundos, de los archivos cifrados.
+    int failCount = 0;
+    std::mutex outputMutex;
+
+    // a.txt -> a.cif como en el resto del programa; otros archivos conservan su extensión.
+    auto outputNameFor = [&](const std::string& name) {
+        const fs::path namePath(name);
+        return (namePath.extension() == ".txt" ? namePath.stem().string() : name) + ".cif";
+    };
+    auto matches = [&](const std::string& name) {
+        return std::any_of(patterns.begin(), patterns.end(), [&](const std::string& pattern) { return matchesPattern(pattern, name); });
+    };
+
+    auto worker = [&] {
+        C cipher;
+        StreamBuffers buffers;
+        prepareCipher(cipher, settings);
+        buffers.pipeline.configure(settings.io);
+        bool fresh = true;
+        Job job;
+        while (queue.pop(job)) {
+            CRIPTO_TRACE_SCOPE(fileScope, Trace::FILE_STAGE, algorithmName(settings.algorithm));
+            if (!fresh) {
+                cipher.restart();
+            }
+            fresh = false;
+            buffers.pipeline.resetStats();
+
+            const fs::path inputFile = inputDir / job.name;
+            const std::string outputName = outputNameFor(job.name);
+            const fs::path outputFile = outputDir / outputName;
+            const fs::path temporary = outputDir / ("." + outputName + ".tmp");
+            std::string jobError;
+            std::error_code ec;
+            bool ok = streamFile(inputFile, temporary, cipher, buffers, jobError);
+            if (ok) {
+                fs::rename(temporary, outputFile, ec);
+                if (ec) {
+                    ok = false;
+                    jobError = "Error: No se pudo reemplazar '" + outputFile.string() + "': " + ec.message() + ".\n";
+                }
+            }
+            if (!ok) {
+                fs::remove(temporary, ec);
+            }
+            const double latency = std::chrono::duration<double, std::milli>(FileClock::now() - job.closedAt).count();
+#if CRIPTO_ENABLE_TRACE
+            std::error_code sizeError;
+            CRIPTO_TRACE_BYTES(fileScope, fs::file_size(inputFile, sizeError));
+#endif
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                busy.erase(job.name);
+                if (ok) {
+                    latencies.push_back(latency);
+                } else {
+                    failCount++;
+                }
+            }
+            std::lock_guard<std::mutex> lock(outputMutex);
+            if (ok) {
+                char latencyText[32];
+                std::snprintf(latencyText, sizeof(latencyText), "%.1f ms", latency);
+                std::cout << "Cifrado: '" << inputFile.string() << "' -> '" << outputFile.string() << "' (latencia " << latencyText << ")\n";
+                if (settings.ioStats && buffers.pipeline.stats().seconds > 0) {
+                    std::cout << "  E/S con " << buffers.pipeline.stats().describe() << "\n";
+                }
+                std::cout << std::flush;
+            } else {
+                std::cerr << jobError << std::flush;
+            }
+        }
+    };
+
+    std::map<std::string, Pending> pending;
+    // Encola lo que no tiene salida o la tiene más antigua que la entrada: al empezar y
+    // cuando el núcleo perdió eventos.
+    auto scanDirectory = [&] {
+        std::error_code ec;
+        const fs::file_time_type now = FileClock::now();
+        for (const auto& entry : fs::directory_iterator(inputDir, ec)) {
+            const std::string name = entry.path().filename().string();
+            if (!entry.is_regular_file() || !matches(name)) {
+                continue;
+            }
+            std::error_code statError;
+            const fs::file_time_type outputTime = fs::last_write_time(outputDir / outputNameFor(name), statError);
+            if (statError || outputTime < entry.last_write_time(statError)) {
+                pending.emplace(name, Pending{SteadyClock::now() - delay, now});
+            }
+        }
+    };
+
+    std::cout << "Vigilando '" << inputDir.string() << "' -> '" << outputDir.string() << "' con " << jobs << " hilo(s) ("
+              << algorithmName(settings.algorithm) << "). Ctrl+C termina los archivos en cola y sale.\n" << std::flush;
+
+    watchStopRequested = false;
+    auto previousInterrupt = std::signal(SIGINT, [](int) { watchStopRequested = true; });
+    auto previousTerminate = std::signal(SIGTERM, [](int) { watchStopRequested = true; });
+    std::vector<std::thread> pool;
+    for (unsigned int i = 0; i < jobs; ++i) {
+        pool.emplace_back(worker);
+    }
+
+    scanDirectory();
+    bool queueFull = false;
+    int status = EXIT_SUCCESS;
+    while (!watchStopRequested) {
+        std::vector<DirectoryWatcher::Event> events;
+        // Con archivos pendientes se vuelve a mirar en cuanto alguno puede estar listo.
+        const int timeout = pending.empty() ? 250 : static_cast<int>(std::max<long long>(1, delay.count()));
+        if (!watcher.wait(timeout, events, error)) {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cerr << "Error: Se dejo de vigilar '" << inputDir.string() << "': " << error << ".\n";
+            status = 1;
+            break;
+        }
+        const SteadyClock::time_point now = SteadyClock::now();
+        for (const DirectoryWatcher::Event& event : events) {
+            if (event.overflow) {
+                {
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    std::cerr << "Aviso: Se perdieron eventos de la carpeta; se vuelve a recorrer.\n";
+                }
+                scanDirectory();
+            } else if (matches(event.name)) {
+                auto [it, inserted] = pending.try_emplace(event.name, Pending{now, FileClock::now()});
+                it->second.lastEvent = now;
+            }
+        }
+
+        // Pasan a la cola, juntos, los archivos que llevan `delay` sin cambiar.
+        for (auto it = pending.begin(); it != pending.end() && !watchStopRequested;) {
+            if (now - it->second.lastEvent < delay) {
+                ++it;
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                if (!busy.insert(it->first).second) {
+                    ++it;  // Otro hilo lo está cifrando: se vuelve a intentar cuando acabe.
+                    continue;
+                }
+            }
+            std::error_code ec;
+            const fs::file_time_type modified = fs::last_write_time(inputDir / it->first, ec);
+            if (ec) {
+                // Se borró antes de cifrarlo.
+                std::lock_guard<std::mutex> lock(stateMutex);
+                busy.erase(it->first);
+                it = pending.erase(it);
+                continue;
+            }
+            Job job{it->first, modified >= startedAt ? modified : it->second.detectedAt};
+            if (queue.tryPush(job)) {
+                queueFull = false;
+            } else {
+                if (!queueFull) {
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    std::cerr << "Aviso: La cola esta llena (" << queue.capacity() << " archivos); se espera a los hilos.\n";
+                }
+                queueFull = true;
+                queue.push(job);
+            }
+            it = pending.erase(it);
+        }
+    }
+
+    queue.close();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    std::signal(SIGINT, previousInterrupt);
+    std::signal(SIGTERM, previousTerminate);
+
+    std::cout << "\n--- Resumen de la vigilancia ---\n";
+    std::cout << "Archivos cifrados con exito: " << latencies.size() << "\n";
+    std::cout << "Archivos fallidos: " << failCount << "\n";
+    if (!pending.empty()) {
+        std::cout << "Archivos sin cifrar al salir: " << pending.size() << "\n";
+    }
+    std::cout << "Cola: maximo " << queue.peak() << " de " << queue.capacity() << " archivos\n";
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p) { return latencies[static_cast<size_t>(p * static_cast<double>(latencies.size() - 1))]; };
+        double total = 0;
+        for (double latency : latencies) {
+            total += latency;
+        }
+        char line[160];
+        std::snprintf(line, sizeof(line), "Latencia (cierre -> cifrado escrito): media %.1f ms, p50 %.1f ms, p95 %.1f ms, maxima %.1f ms\n",
+                      total / static_cast<double>(latencies.size()), percentile(0.5), percentile(0.95), latencies.back());
+        std::cout << line;
+    }
+    return status != EXIT_SUCCESS ? status : failCount == 0 ? EXIT_SUCCESS : 1;
+}
+#endif
+
+/**
+ * @brief Llama a `body` con el tipo del codificador elegido (1 XOR, 2 Cesar, 3 Vigenere,
+ * 4 DES, 5 cascada). Es el único punto donde se decide el algoritmo en ejecución: a partir de aquí
+ * el bucle de cada archivo se especializa en compilación.
+ */
+template <typename Body>
+int dispatchCipher(int cipherChoice, Body&& body) {
+    switch (cipherChoice) {
+        case 1:
+            return body(std::type_identity<XOREncoder>{});
+        case 2:
+            return body(std::type_identity<CesarEncoder>{});
+        case 3:
+            return body(std::type_identity<VigenereEncoder>{});
+        case 5:
+            return body(std::type_identity<CascadeEncoder>{});
+        default:
+            return body(std::type_identity<DESEncoder>{});
+    }
+}
+
+/**
+ * @brief Llama a `body` con el tipo del codificador que escribe lo que piden `settings`
+ * al encriptar con `C`: el contenedor .cif o el formato antiguo, con o sin armadura.
+ */
+template <Cipher C, typename Body>
+int dispatchEncoder(const CipherSettings& settings, Body&& body) {
+    auto withArmor = [&](auto encoderType) {
+        if (settings.armor != ArmorFormat::None) {
+            return body(std::type_identity<ArmorEncoder<typename decltype(encoderType)::type>>{});
+        }
+        return body(encoderType);
+    };
+    if constexpr (ChunkedCipher<C>) {
+        if (settings.writeContainer) {
+            return withArmor(std::type_identity<ContainerEncoder<C>>{});
+        }
+    }
+    return withArmor(std::type_identity<C>{});
+}
+
+void prepareCipher(XOREncoder& cipher, const CipherSettings& settings) {
+    cipher.beginStream(settings.password, settings.encrypting);
+}
+
+void prepareCipher(CesarEncoder& cipher, const CipherSettings& settings) {
+    cipher.beginStream(settings.password, settings.encrypting);
+}
+
+void prepareCipher(VigenereEncoder& cipher, const CipherSettings& settings) {
+    cipher.beginStream(settings.password, settings.encrypting);
+}
+
+void prepareCipher(DESEncoder& cipher, const CipherSettings& settings) {
+    cipher.setThreads(settings.desThreads);
+    if (settings.encrypting && settings.writeContainer) {
+        // El modo y el IV van en la cabecera del contenedor, no en una cabecera "DESM".
+        cipher.beginRawStream(settings.desKey, true, settings.desMode);
+    } else {
+        cipher.beginStream(settings.desKey, settings.encrypting, settings.desMode);
+    }
+}
+
+void prepareCipher(CascadeEncoder& cipher, const CipherSettings& settings) {
+    cipher.setThreads(settings.desThreads);
+    cipher.beginStream(settings.cascade, settings.encrypting, settings.desMode);
+}
+
+template <ChunkedCipher C>
+void prepareCipher(ContainerEncoder<C>& container, const CipherSettings& settings) {
+    prepareCipher(container.cipher(), settings);
+    container.beginContainer(static_cast<uint8_t>(settings.algorithm), keyCheckMaterial(settings));
+}
+
+template <Cipher C>
+void prepareCipher(ArmorEncoder<C>& armor, const CipherSettings& settings) {
+    prepareCipher(armor.cipher(), settings);
+    armor.beginArmor(settings.armor);
+}
+
+/**
+ * @brief Ajusta un codificador ya preparado a los parámetros de la cabecera de un
+ * contenedor. XOR, César y Vigenère no tienen parámetros en la cabecera.
+ */
+template <ChunkedCipher C>
+void prepareContainerCipher(C& cipher, const CipherSettings& settings, const CifHeader& header, bool parallelChunks) {
+    (void)cipher;
+    (void)settings;
+    (void)header;
+    (void)parallelChunks;
+}
+
+/**
+ * @brief DES toma el modo y el IV de la cabecera. Si los fragmentos se descifran en
+ * paralelo, cada uno usa un solo hilo.
+ */
+void prepareContainerCipher(DESEncoder& cipher, const CipherSettings& settings, const CifHeader& header, bool parallelChunks) {
+    cipher.setThreads(parallelChunks ? 1 : settings.desThreads);
+    cipher.beginRawStream(settings.desKey, settings.encrypting, header.desMode, header.iv);
+}
+
+/**
+ * @brief Devuelve a un codificador el formato antiguo si un contenedor anterior lo
+ * cambió. Solo DES lo necesita.
+ */
+template <ChunkedCipher C>
+void prepareLegacyCipher(C& cipher, const CipherSettings& settings) {
+    (void)cipher;
+    (void)settings;
+}
+
+/**
+ * @brief Un DES reutilizado tras un contenedor vuelve a detectar la cabecera "DESM".
+ */
+void prepareLegacyCipher(DESEncoder& cipher, const CipherSettings& settings) {
+    cipher.setThreads(settings.desThreads);
+    cipher.beginStream(settings.desKey, settings.encrypting, settings.desMode);
+}
+
+/**
+ * @brief Nombre de un algoritmo por su número (el del menú y de la cabecera .cif).
+ */
+const char* algorithmName(int algorithm) {
+    switch (algorithm) {
+        case 1: return "XOR";
+        case 2: return "Cesar";
+        case 3: return "Vigenere";
+        case 4: return "DES";
+        case 5: return "Cascada";
+        default: return "un algoritmo desconocido";
+    }
+}
+
+/**
+ * @brief Número de un algoritmo por su nombre (xor, cesar, vigenere o des, sin
+ * distinguir mayúsculas).
+ * @return 0 si el nombre no corresponde a ninguno.
+ */
+int parseAlgorithm(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return (name == "xor") ? 1 : (name == "cesar" || name == "caesar") ? 2 : (name == "vigenere") ? 3 : (name == "des") ? 4 : 0;
+}
+
+/**
+ * @brief Lee una clave de un archivo, sin el salto de línea final.
+ * @return Falso si el archivo no se pudo abrir.
+ */
+bool readKeyFile(const std::string& path, std::string& key) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open()) {
+        return false;
+    }
+    key.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    if (!key.empty() && key.back() == '\n') {
+        key.pop_back();
+        if (!key.empty() && key.back() == '\r') {
+            key.pop_back();
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief La clave de `settings` como la usa su algoritmo, para el valor de comprobación
+ * de los contenedores.
+ */
+std::string keyCheckMaterial(const CipherSettings& settings) {
+    switch (settings.algorithm) {
+        case 1: return XOREncoder::keyCheckMaterial(settings.password);
+        case 2: return CesarEncoder::keyCheckMaterial(settings.password);
+        case 3: return VigenereEncoder::keyCheckMaterial(settings.password);
+        case 5: {
+            // Cada etapa con su algoritmo y su longitud delante, para que cuente el orden.
+            std::string material;
+            for (const CascadeStage& stage : settings.cascade) {
+                CipherSettings single;
+                single.algorithm = stage.algorithm;
+                single.password = stage.key;
+                single.desKey = DESKey(stage.key);
+                const std::string part = keyCheckMaterial(single);
+                material += std::to_string(stage.algorithm) + ":" + std::to_string(part.size()) + ":" + part;
+            }
+            return material;
+        }
+        default: return DESEncoder::keyCheckMaterial(settings.desKey);
+    }
+}
+
+/**
+ * @brief Lee un rango `INICIO:LONGITUD` en bytes; sin longitud ("INICIO:") llega al final.
+ */
+bool parseRange(const std::string& text, uint64_t& offset, uint64_t& length) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos || colon == 0) {
+        return false;
+    }
+    auto parseNumber = [](const std::string& digits, uint64_t& value) {
+        if (digits.empty() || digits.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        try {
+            value = std::stoull(digits);
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    };
+    std::string lengthText = text.substr(colon + 1);
+    length = UINT64_MAX;
+    return parseNumber(text.substr(0, colon), offset) && (lengthText.empty() || parseNumber(lengthText, length));
+}
+
+/**
+ * @brief Recupera la clave de archivos cifrados sin conocerla y los desencripta.
+ *
+ * Se analiza el inicio de cada archivo (ANALYSIS_SAMPLE_SIZE bytes) con Cryptanalysis y,
+ * con la clave encontrada, el archivo completo se desencripta por fragmentos. Los
+ * archivos se atienden de uno en uno: el paralelismo está dentro de cada ataque.
+ */
+void recoverKeys(const fs::path& inputDir, const fs::path& outputDir, int cipherChoice, const CommandLineOptions& options) {
+    std::cout << "========================================\n";
+    std::cout << "      Aplicacion de Criptografia\n";
+    std::cout << "========================================\n\n" << std::flush;
+
+    std::cout << "Operacion: recuperar clave " << (cipherChoice == 1 ? "XOR" : cipherChoice == 2 ? "Cesar" : "Vigenere") << "\n";
+
+    std::cout << "\nIntroduce el/los nombre(s) de archivo(s) en '" << inputDir.string() << "' (separados por espacios, sin extension):\n> " << std::flush;
+    std::string line;
+    std::getline(std::cin, line);
+
+    Cryptanalysis analysis(options.jobs);
+    std::stringstream ss(line);
+    std::string filename;
+    int successCount = 0;
+    int failCount = 0;
+    OutputNamer namer(outputDir);
+
+    while (ss >> filename) {
+        fs::path inputFile = inputDir / (filename + ".cif");
+        if (!fs::exists(inputFile)) {
+            std::cerr << "Error: El archivo '" << inputFile.string() << "' no existe. Omitiendo.\n";
+            failCount++;
+            continue;
+        }
+
+        std::ifstream input(inputFile, std::ios::binary);
+        std::string sample(ANALYSIS_SAMPLE_SIZE, '\0');
+        input.read(sample.data(), static_cast<std::streamsize>(sample.size()));
+        sample.resize(static_cast<size_t>(input.gcount()));
+        if (CifContainer::isContainer(sample)) {
+            // En un contenedor se analiza el texto cifrado, sin cabecera ni registros.
+            CifHeader header;
+            std::string reason;
+            if (!CifContainer::parseHeader(sample, header, reason) || header.algorithm != cipherChoice ||
+                !CifContainer::readCiphertext(input, header, ANALYSIS_SAMPLE_SIZE, sample)) {
+                std::cerr << "Error: '" << inputFile.string() << "' no es un contenedor " << algorithmName(cipherChoice) << " valido. Omitiendo.\n";
+                failCount++;
+                continue;
+            }
+        }
+        input.close();
+        if (sample.empty()) {
+            std::cerr << "Error: El archivo '" << inputFile.string() << "' esta vacio. Omitiendo.\n";
+            failCount++;
+            continue;
+        }
+
+        std::string error;
+        fs::path outputFile = namer.claim(filename, ".txt", error);
+        if (outputFile.empty()) {
+            std::cerr << "Error: No se pudo crear el archivo de salida de '" << inputFile.string() << "': " << error << ". Omitiendo.\n";
+            failCount++;
+            continue;
+        }
+        bool ok = false;
+        Cryptanalysis::Result result;
+        CipherSettings settings;
+        settings.algorithm = cipherChoice;
+        settings.encrypting = false;
+        // La clave recuperada puede ser equivalente o tener algún carácter distinto.
+        settings.verifyKey = false;
+        settings.chunkThreads = options.jobs == 0 ? BatchExecutor::defaultJobs() : options.jobs;
+        StreamBuffers buffers;
+        switch (cipherChoice) {
+            case 1: {
+                result = analysis.crackXOR(sample);
+                settings.password = result.key;
+                XOREncoder xorEncoder;
+                CifWorkspace<XOREncoder> workspace;
+                prepareCipher(xorEncoder, settings);
+                ok = decryptFile(inputFile, outputFile, xorEncoder, buffers, workspace, settings, error);
+                break;
+            }
+            case 2: {
+                result = analysis.crackCesar(sample);
+                // Se cifra con la clave inversa para que también los dígitos se recuperen bien.
+                settings.password = Cryptanalysis::cesarInverseKey(result.key);
+                settings.encrypting = true;
+                CesarEncoder cesarEncoder;
+                CifWorkspace<CesarEncoder> workspace;
+                prepareCipher(cesarEncoder, settings);
+                ok = decryptFile(inputFile, outputFile, cesarEncoder, buffers, workspace, settings, error);
+                break;
+            }
+            case 3: {
+                result = analysis.crackVigenere(sample);
+                settings.password = result.key;
+                VigenereEncoder vigenereEncoder;
+                CifWorkspace<VigenereEncoder> workspace;
+                prepareCipher(vigenereEncoder, settings);
+                ok = decryptFile(inputFile, outputFile, vigenereEncoder, buffers, workspace, settings, error);
+                break;
+            }
+        }
+
+        if (!ok) {
+            std::cerr << error;
+            failCount++;
+            continue;
+        }
+
+        successCount++;
+        std::cout << "Clave recuperada para '" << inputFile.string() << "': " << describeKey(result.key) << "\n";
+        std::cout << "Proceso completado: '" << inputFile.string() << "' -> '" << outputFile.string() << "'\n";
+    }
+
+    std::cout << "\n--- Resumen de la operacion ---\n";
+    std::cout << "Archivos procesados con exito: " << successCount << "\n";
+    std::cout << "Archivos fallidos: " << failCount << "\n";
+}
+
+/**
+ * @brief Busca por diccionario o máscara la contraseña de un archivo cifrado con DES y,
+ * si la encuentra, lo desencripta.
+ *
+ * El progreso se guarda cada segundo en '<archivo>.desprogress' junto al .cif; si la
+ * búsqueda se interrumpe (Ctrl+C) y se repite con las mismas candidatas, continúa
+ * desde donde se quedó.
+ */
+void recoverDESKey(const fs::path& inputDir, const fs::path& outputDir, const CommandLineOptions& options) {
+    std::cout << "========================================\n";
+    std::cout << "      Aplicacion de Criptografia\n";
+    std::cout << "========================================\n\n" << std::flush;
+
+    std::cout << "Operacion: recuperar clave DES\n";
+    std::cout << "\nIntroduce el nombre del archivo en '" << inputDir.string() << "' (sin extension):\n> " << std::flush;
+    std::string filename;
+    std::getline(std::cin, filename);
+
+    fs::path inputFile = inputDir / (filename + ".cif");
+    DESKeySearch search(options.jobs);
+    std::string error;
+    if (filename.empty() || !fs::exists(inputFile)) {
+        std::cout << "Error: El archivo '" << inputFile.string() << "' no existe.\n";
+        return;
+    }
+    if (!search.loadTarget(inputFile, error)) {
+        std::cout << "Error: " << error << "\n";
+        return;
+    }
+
+    std::cout << "Tipo de ataque: 1. Diccionario  2. Mascara (?l ?u ?d ?s ?a):\n> " << std::flush;
+    int attackChoice = getChoiceFromUser();
+    DESKeySearch::Candidates candidates;
+    std::string description = inputFile.filename().string() + "|" + std::to_string(fs::file_size(inputFile)) + "|";
+    if (attackChoice == 1) {
+        std::cout << "Ruta del diccionario (una contrasena por linea):\n> " << std::flush;
+        std::string dictionaryPath;
+        std::getline(std::cin, dictionaryPath);
+        std::ifstream dictionary(dictionaryPath, std::ios::binary);
+        if (!dictionary.is_open()) {
+            std::cout << "Error: No se pudo abrir el diccionario '" << dictionaryPath << "'.\n";
+            return;
+        }
+        std::string word;
+        while (std::getline(dictionary, word)) {
+            if (!word.empty() && word.back() == '\r') {
+                word.pop_back();
+            }
+            if (!word.empty()) {
+                candidates.words.push_back(word);
+            }
+        }
+        description += "dict:" + dictionaryPath + ":" + std::to_string(candidates.words.size());
+    } else if (attackChoice == 2) {
+        std::cout << "Mascara (por ejemplo ?u?l?l?l?d?d):\n> " << std::flush;
+        std::string mask;
+        std::getline(std::cin, mask);
+        if (!DESKeySearch::parseMask(mask, candidates.maskSets, error)) {
+            std::cout << "Error: " << error << "\n";
+            return;
+        }
+        description += "mask:" + mask;
+    } else {
+        std::cout << "\nOpcion de ataque no valida." << std::endl;
+        return;
+    }
+
+    fs::path checkpointFile = inputDir / (filename + ".desprogress");
+    uint64_t startIndex = DESKeySearch::loadCheckpoint(checkpointFile, description);
+    if (startIndex > 0) {
+        std::cout << "Reanudando desde la candidata " << startIndex << " de " << candidates.size() << ".\n";
+    }
+    std::cout << "Probando " << candidates.size() << " candidatas con " << (options.jobs == 0 ? BatchExecutor::defaultJobs() : options.jobs)
+              << " hilo(s). Ctrl+C detiene y guarda el progreso.\n" << std::flush;
+
+    activeKeySearch.store(&search);
+    auto previousHandler = std::signal(SIGINT, [](int) {
+        if (DESKeySearch* running = activeKeySearch.load()) {
+            running->stop();
+        }
+    });
+    DESKeySearch::Result result = search.run(candidates, startIndex, [&](const DESKeySearch::Progress& progress) {
+        std::cout << "\r  Probadas " << progress.nextIndex << "/" << progress.total << " ("
+                  << static_cast<uint64_t>(progress.rate()) << " candidatas/s)   " << std::flush;
+        DESKeySearch::saveCheckpoint(checkpointFile, description, progress.nextIndex);
+    });
+    std::signal(SIGINT, previousHandler);
+    activeKeySearch.store(nullptr);
+
+    std::cout << "\n" << result.progress.tried << " candidatas en " << result.progress.seconds << " s ("
+              << static_cast<uint64_t>(result.progress.rate()) << " candidatas/s).\n";
+
+    if (result.stopped) {
+        DESKeySearch::saveCheckpoint(checkpointFile, description, result.progress.nextIndex);
+        std::cout << "Busqueda detenida. El progreso se guardo en '" << checkpointFile.string() << "'.\n";
+        return;
+    }
+    std::error_code ec;
+    fs::remove(checkpointFile, ec);
+    if (!result.found) {
+        std::cout << "No se encontro la clave entre las candidatas.\n";
+        return;
+    }
+
+    std::cout << "Clave encontrada: " << describeKey(result.password) << " (solo cuentan los primeros 8 caracteres).\n";
+
+    fs::path outputFile = OutputNamer(outputDir).claim(filename, ".txt", error);
+    if (outputFile.empty()) {
+        std::cerr << "Error: No se pudo crear el archivo de salida: " << error << ".\n";
+        return;
+    }
+    CipherSettings settings;
+    settings.algorithm = 4;
+    settings.encrypting = false;
+    settings.desKey = DESKey(result.password);
+    settings.desThreads = options.jobs == 0 ? BatchExecutor::defaultJobs() : options.jobs;
+    settings.chunkThreads = settings.desThreads;
+    DESEncoder desEncoder;
+    prepareCipher(desEncoder, settings);
+    StreamBuffers buffers;
+    CifWorkspace<DESEncoder> workspace;
+    if (!decryptFile(inputFile, outputFile, desEncoder, buffers, workspace, settings, error)) {
+        std::cerr << error;
+        return;
+    }
+    std::cout << "Proceso completado: '" << inputFile.string() << "' -> '" << outputFile.string() << "'\n";
+}
+
+/**
+ * @brief Muestra una clave entre comillas si es imprimible, o en hexadecimal si no.
+ */
+std::string describeKey(const std::string& key) {
+    bool printable = std::all_of(key.begin(), key.end(), [](char c) {
+        return c >= 32 && c < 127;
+    });
+    if (printable) {
+        return "'" + key + "'";
+    }
+    static const char* digits = "0123456789abcdef";
+    std::string hex = "0x";
+    for (char c : key) {
+        hex += digits[static_cast<unsigned char>(c) >> 4];
+        hex += digits[static_cast<unsigned char>(c) & 0x0F];
+    }
+    return hex + " (hex)";
+}
+
+/**
+ * @brief Transforma un archivo por fragmentos de tamaño fijo con un codificador ya
+ * preparado con beginStream(). La memoria usada no depende del tamaño del archivo.
+ * @param buffers Buffers del hilo; se reutilizan entre archivos.
+ * @param error Recibe el mensaje a mostrar si la operación falla.
+ * @return Verdadero si el archivo se leyó y escribió completo.
+ */
+template <Cipher C>
+bool streamFile(const fs::path& inputFile, const fs::path& outputFile, C& cipher, StreamBuffers& buffers, std::string& error) {
+#if CRIPTO_POSIX_IO
+    if (buffers.pipeline.enabled()) {
+        return streamFilePipelined(inputFile, outputFile, cipher, buffers.pipeline, error);
+    }
+#endif
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        error = "Error: No se pudo leer el contenido de '" + inputFile.string() + "'. Omitiendo.\n";
+        return false;
+    }
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        error = "Error: No se pudo crear el archivo '" + outputFile.string() + "'. Omitiendo.\n";
+        return false;
+    }
+    return streamData(input, output, inputFile.string(), outputFile.string(), cipher, buffers, error);
+}
+
+#if CRIPTO_POSIX_IO
+/**
+ * @brief Como streamFile(), pero leyendo, cifrando y escribiendo a la vez con la
+ * canalización de E/S del hilo (io_uring o pread/pwrite).
+ */
+template <Cipher C>
+bool streamFilePipelined(const fs::path& inputFile, const fs::path& outputFile, C& cipher, FilePipeline& pipeline, std::string& error) {
+    const int inputFd = ::open(inputFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (inputFd < 0) {
+        error = "Error: No se pudo leer el contenido de '" + inputFile.string() + "'. Omitiendo.\n";
+        return false;
+    }
+    // Lectura y escritura: el mapeo de --io mmap lo necesita.
+    const int outputFd = ::open(outputFile.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (outputFd < 0) {
+        ::close(inputFd);
+        error = "Error: No se pudo crear el archivo '" + outputFile.string() + "'. Omitiendo.\n";
+        return false;
+    }
+    std::string reason;
+    bool ok = false;
+    if constexpr (InPlaceCipher<C>) {
+        ok = pipeline.mappedIO() ? pipeline.runMapped(inputFd, outputFd, cipher, reason) : pipeline.run(inputFd, outputFd, cipher, reason);
+    } else {
+        ok = pipeline.run(inputFd, outputFd, cipher, reason);
+    }
+    ::close(inputFd);
+    if (::close(outputFd) != 0 && ok) {
+        ok = false;
+        reason = std::strerror(errno);
+    }
+    if (!ok) {
+        error = "Error: Fallo la E/S de '" + inputFile.string() + "' -> '" + outputFile.string() + "': " + reason + ".\n";
+    }
+    return ok;
+}
+
+/**
+ * @brief Indica si dos rutas existentes están en el mismo sistema de archivos, es decir,
+ * si un archivo de una se puede renombrar a la otra.
+ */
+bool sameFileSystem(const fs::path& first, const fs::path& second) {
+    struct stat firstInfo{};
+    struct stat secondInfo{};
+    return ::stat(first.c_str(), &firstInfo) == 0 && ::stat(second.c_str(), &secondInfo) == 0 && firstInfo.st_dev == secondInfo.st_dev;
+}
+
+/**
+ * @brief Cifra un archivo sobre sí mismo (mapeado en memoria) y lo renombra a
+ * `outputFile`, el nombre ya reservado. Los contenedores no se pueden descifrar así: su
+ * texto plano es más corto. Antes de tocar el archivo se comprueba que el renombrado es
+ * posible; si algo falla, se borra el nombre reservado.
+ */
+template <InPlaceCipher C>
+bool transformFileInPlace(const fs::path& inputFile, const fs::path& outputFile, C& cipher, StreamBuffers& buffers, const CipherSettings& settings, std::string& error) {
+    auto fail = [&outputFile]() {
+        std::error_code ec;
+        fs::remove(outputFile, ec);
+        return false;
+    };
+    if (!sameFileSystem(inputFile, outputFile)) {
+        error = "Error: '" + inputFile.string() + "' y '" + outputFile.string() + "' estan en sistemas de archivos distintos; --in-place no puede renombrarlo. Omitiendo.\n";
+        return fail();
+    }
+    const int fd = ::open(inputFile.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        error = "Error: No se pudo abrir '" + inputFile.string() + "' para escribir en el. Omitiendo.\n";
+        return fail();
+    }
+    char magic[sizeof(CifContainer::MAGIC)] = {};
+    const ssize_t magicBytes = ::pread(fd, magic, sizeof(magic), 0);
+    if (!settings.encrypting && magicBytes > 0 && CifContainer::isContainer(std::string_view(magic, static_cast<size_t>(magicBytes)))) {
+        ::close(fd);
+        error = "Error: '" + inputFile.string() + "' es un contenedor .cif; --in-place solo sirve para el formato raw. Omitiendo.\n";
+        return fail();
+    }
+    std::string reason;
+    bool ok = buffers.pipeline.runInPlace(fd, cipher, reason);
+    if (::close(fd) != 0 && ok) {
+        ok = false;
+        reason = std::strerror(errno);
+    }
+    if (!ok) {
+        error = "Error: Fallo la E/S de '" + inputFile.string() + "' (el archivo puede haber quedado a medias): " + reason + ".\n";
+        return fail();
+    }
+    std::error_code ec;
+    fs::rename(inputFile, outputFile, ec);
+    if (ec) {
+        error = "Error: '" + inputFile.string() + "' se cifro pero no se pudo renombrar a '" + outputFile.string() + "': " + ec.message() + ".\n";
+        return fail();
+    }
+    return true;
+}
+#endif
+
+/**
+ * @brief Transforma un flujo (archivo, entrada o salida estándar) por fragmentos.
+ * @param inputName Nombre de la entrada para los mensajes de error.
+ * @param outputName Nombre de la salida para los mensajes de error.
+ * @param preloaded Bytes del inicio del flujo que ya están al principio de `buffers.input`.
+ */
+template <Cipher C>
+bool streamData(std::istream& input, std::ostream& output, const std::string& inputName, const std::string& outputName, C& cipher, StreamBuffers& buffers, std::string& error, size_t preloaded) {
+    // Solo reservan memoria la primera vez que el hilo los usa.
+    buffers.input.resize(std::max(buffers.input.size(), STREAM_CHUNK_SIZE));
+    if constexpr (!InPlaceCipher<C>) {
+        buffers.output.resize(cipher.outputBound(STREAM_CHUNK_SIZE));
+    }
+
+    auto writeBytes = [&output](std::span<const std::byte> bytes) {
+        output.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    };
+
+    char* readBuffer = reinterpret_cast<char*>(buffers.input.data());
+    while (input.read(readBuffer + preloaded, static_cast<std::streamsize>(STREAM_CHUNK_SIZE - preloaded)) || input.gcount() > 0 || preloaded > 0) {
+        std::span<std::byte> chunk(buffers.input.data(), preloaded + static_cast<size_t>(input.gcount()));
+        preloaded = 0;
+        if constexpr (InPlaceCipher<C>) {
+            // Los codificadores que no cambian la longitud transforman el buffer sin copiarlo.
+            {
+                CRIPTO_TRACE_SCOPE(transformScope, "cifrar", "iostream");
+                CRIPTO_TRACE_BYTES(transformScope, chunk.size());
+                cipher.transformInPlace(chunk);
+            }
+            CRIPTO_TRACE_SCOPE(writeScope, "escribir", "iostream");
+            CRIPTO_TRACE_BYTES(writeScope, chunk.size());
+            writeBytes(chunk);
+        } else {
+            size_t written;
+            {
+                CRIPTO_TRACE_SCOPE(transformScope, "cifrar", "iostream");
+                CRIPTO_TRACE_BYTES(transformScope, chunk.size());
+                written = cipher.transform(chunk, buffers.output);
+            }
+            CRIPTO_TRACE_SCOPE(writeScope, "escribir", "iostream");
+            CRIPTO_TRACE_BYTES(writeScope, written);
+            writeBytes(std::span(buffers.output).first(written));
+        }
+    }
+    if (input.bad()) {
+        error = "Error: No se pudo leer el contenido de '" + inputName + "'. Omitiendo.\n";
+        return false;
+    }
+
+    // El buffer de lectura ya está libre. finish() de un contenedor escribe el índice, que
+    // crece con el archivo, así que se amplía si hace falta.
+    buffers.input.resize(std::max(buffers.input.size(), cipher.outputBound(0)));
+    std::span<std::byte> tail(buffers.input);
+    {
+        CRIPTO_TRACE_SCOPE(tailScope, "finalizar", "iostream");
+        const size_t produced = cipher.finish(tail);
+        CRIPTO_TRACE_BYTES(tailScope, produced);
+        writeBytes(tail.first(produced));
+    }
+    if (!output) {
+        error = "Error: No se pudo escribir el archivo '" + outputName + "'.\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Desencripta un archivo; ver decryptStream().
+ */
+template <ChunkedCipher C>
+bool decryptFile(const fs::path& inputFile, const fs::path& outputFile, C& cipher, StreamBuffers& buffers, CifWorkspace<C>& workspace, const CipherSettings& settings, std::string& error) {
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        error = "Error: No se pudo leer el contenido de '" + inputFile.string() + "'. Omitiendo.\n";
+        return false;
+    }
+    char magic[Armor::PREFIX.size()] = {};
+    input.read(magic, sizeof(magic));
+    const std::string_view magicView(magic, static_cast<size_t>(input.gcount()));
+    if (Armor::isArmored(magicView)) {
+        input.close();
+        return decryptArmoredFile(inputFile, outputFile, cipher, buffers, workspace, settings, error);
+    }
+    if (!CifContainer::isContainer(magicView) && !settings.rangeGiven && buffers.pipeline.enabled()) {
+        // Formato antiguo: un solo flujo, que se descifra con la canalización de E/S.
+        input.close();
+        prepareLegacyCipher(cipher, settings);
+        return streamFile(inputFile, outputFile, cipher, buffers, error);
+    }
+    input.clear();
+    input.seekg(0);
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        error = "Error: No se pudo crear el archivo '" + outputFile.string() + "'. Omitiendo.\n";
+        return false;
+    }
+    if (!decryptStream(input, output, true, inputFile.string(), outputFile.string(), cipher, buffers, workspace, settings, error)) {
+        // No se deja un archivo a medias (o vacío, si la clave no era la correcta).
+        output.close();
+        std::error_code ec;
+        fs::remove(outputFile, ec);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Desencripta un flujo. Si empieza con la cabecera de un contenedor .cif, se
+ * comprueba el algoritmo y se usa el índice para descifrar solo el rango pedido, con
+ * varios fragmentos en paralelo; si la entrada no permite saltos (entrada estándar) se
+ * descifra registro a registro. Sin cabecera es un archivo del formato antiguo.
+ * @param seekable Verdadero si la entrada es un archivo (se puede leer el índice).
+ */
+template <ChunkedCipher C>
+bool decryptStream(std::istream& input, std::ostream& output, bool seekable, const std::string& inputName, const std::string& outputName, C& cipher, StreamBuffers& buffers, CifWorkspace<C>& workspace, const CipherSettings& settings, std::string& error) {
+    // La cabecera se lee directamente en el buffer de lectura: si no es un contenedor,
+    // esos bytes son el principio de los datos.
+    buffers.input.resize(std::max(buffers.input.size(), STREAM_CHUNK_SIZE));
+    char* head = reinterpret_cast<char*>(buffers.input.data());
+    input.read(head, static_cast<std::streamsize>(CifContainer::HEADER_SIZE));
+    const size_t headBytes = static_cast<size_t>(input.gcount());
+    const std::string_view headView(head, headBytes);
+
+    if (!CifContainer::isContainer(headView)) {
+        if (settings.rangeGiven) {
+            error = "Error: --range solo funciona con contenedores .cif y '" + inputName + "' no lo es.\n";
+            return false;
+        }
+        prepareLegacyCipher(cipher, settings);
+        return streamData(input, output, inputName, outputName, cipher, buffers, error, headBytes);
+    }
+
+    std::string reason;
+    CifHeader header;
+    bool ok = CifContainer::parseHeader(headView, header, reason);
+    if (ok && header.algorithm != settings.algorithm) {
+        reason = std::string("se cifro con ") + algorithmName(header.algorithm) + ", no con " + algorithmName(settings.algorithm);
+        ok = false;
+    }
+    // Con una clave incorrecta se para aquí, antes de descifrar nada.
+    ok = ok && CifContainer::readKeyCheck(input, header, reason);
+    if (ok && settings.verifyKey && header.hasKeyCheck &&
+        CifContainer::computeKeyCheck(header.salt, header.algorithm, keyCheckMaterial(settings)) != header.keyCheck) {
+        reason = "la clave no es correcta";
+        ok = false;
+    }
+    if (ok && seekable) {
+        prepareContainerCipher(cipher, settings, header, settings.chunkThreads > 1);
+        CifIndex index;
+        ok = CifContainer::readIndex(input, header, index, reason) &&
+             CifContainer::decodeRange(input, output, header, index, settings.rangeOffset, settings.rangeLength, cipher, workspace, settings.chunkThreads, reason);
+    } else if (ok) {
+        prepareContainerCipher(cipher, settings, header, false);
+        ok = CifContainer::decodeStream(input, output, header, cipher, buffers.input, buffers.output, reason);
+    }
+    if (!ok) {
+        error = "Error: '" + inputName + "': " + reason + ".\n";
+        return false;
+    }
+    if (!output) {
+        error = "Error: No se pudo escribir el archivo '" + outputName + "'.\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Comprueba si un archivo empieza con la cabecera de una armadura de texto.
+ */
+bool isArmoredFile(const fs::path& inputFile) {
+    std::ifstream input(inputFile, std::ios::binary);
+    char head[Armor::PREFIX.size()] = {};
+    input.read(head, sizeof(head));
+    return Armor::isArmored(std::string_view(head, static_cast<size_t>(input.gcount())));
+}
+
+/**
+ * @brief Desencripta un archivo armado; ver decryptArmored().
+ */
+template <Cipher C>
+bool decryptArmoredFile(const fs::path& inputFile, const fs::path& outputFile, C& cipher, StreamBuffers& buffers, CifWorkspace<C>& workspace, const CipherSettings& settings, std::string& error) {
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        error = "Error: No se pudo leer el contenido de '" + inputFile.string() + "'. Omitiendo.\n";
+        return false;
+    }
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        error = "Error: No se pudo crear el archivo '" + outputFile.string() + "'. Omitiendo.\n";
+        return false;
+    }
+    if (!decryptArmored(input, output, inputFile.string(), outputFile.string(), cipher, buffers, workspace, settings, error)) {
+        output.close();
+        std::error_code ec;
+        fs::remove(outputFile, ec);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Desencripta un flujo armado (ver Armor): ArmorReader quita la armadura a medida
+ * que se lee y lo de dentro se descifra como un flujo binario sin saltos, registro a
+ * registro si es un contenedor. Si el flujo no empieza con una cabecera de armadura se
+ * descifra tal cual.
+ */
+template <Cipher C>
+bool decryptArmored(std::istream& source, std::ostream& output, const std::string& inputName, const std::string& outputName, C& cipher, StreamBuffers& buffers, CifWorkspace<C>& workspace, const CipherSettings& settings, std::string& error) {
+    ArmorReader reader(source);
+    if (reader.begin() != ArmorFormat::None && settings.rangeGiven) {
+        error = "Error: --range no funciona con archivos armados y '" + inputName + "' lo es.\n";
+        return false;
+    }
+    std::istream input(&reader);
+    bool ok;
+    if constexpr (ChunkedCipher<C>) {
+        ok = decryptStream(input, output, false, inputName, outputName, cipher, buffers, workspace, settings, error);
+    } else {
+        (void)workspace;
+        ok = streamData(input, output, inputName, outputName, cipher, buffers, error);
+    }
+    std::string reason;
+    if (!reader.finished(reason)) {
+        // El motivo de la armadura explica mejor el fallo que el del descifrado.
+        error = "Error: '" + inputName + "': " + reason + ".\n";
+        return false;
+    }
+    return ok;
+}